@@ -4,6 +4,7 @@
 #include "EfficiencyCheckerBuilding.h"
 #include "EfficiencyCheckerRCO.h"
 #include "Logic/EfficiencyCheckerLogic.h"
+#include "Logic/EfficiencyCheckerUpdateJob.h"
 
 #include "EfficiencyCheckerModModule.h"
 #include "FGBuildableConveyorBelt.h"
@@ -139,6 +140,12 @@ void AEfficiencyCheckerBuilding::BeginPlay()
 
 		pipelineToSplit = nullptr;
 
+		if (AEfficiencyCheckerLogic::singleton)
+		{
+			// Connections restored from the save are dependencies before the first refresh
+			AEfficiencyCheckerLogic::singleton->addCheckerDependencies(this, connectedBuildables);
+		}
+
 		if (FEfficiencyCheckerModModule::autoUpdate && autoUpdateMode == EAutoUpdateType::AUT_USE_DEFAULT ||
 			autoUpdateMode == EAutoUpdateType::AUT_ENABLED)
 		{
@@ -238,6 +245,11 @@ void AEfficiencyCheckerBuilding::EndPlay(const EEndPlayReason::Type endPlayReaso
 		removeOnRecipeChangedBindings(connectedBuildables);
 		removeOnSortRulesChangedDelegateBindings(connectedBuildables);
 
+		if (AEfficiencyCheckerLogic::singleton)
+		{
+			AEfficiencyCheckerLogic::singleton->removeCheckerDependencies(this, connectedBuildables);
+		}
+
 		pendingBuildables.Empty();
 		connectedBuildables.Empty();
 	}
@@ -257,6 +269,7 @@ void AEfficiencyCheckerBuilding::Tick(float dt)
 		if (doUpdateItem)
 		{
 			UpdateItem(injectedInput, limitedThroughput, requiredOutput, injectedItems, overflow);
+			UpdateBottlenecks(bottlenecks);
 			SetActorTickEnabled(false);
 		}
 		else if (lastUpdated < updateRequested && updateRequested <= GetWorld()->GetTimeSeconds())
@@ -332,10 +345,15 @@ void AEfficiencyCheckerBuilding::Tick(float dt)
 
 						pendingBuildables.Empty();
 
-						if (mustUpdate_)
+						if (mustUpdate_ && !AEfficiencyCheckerLogic::singleton->haveComponentsChanged(connectedBuildables, componentsVersion))
+						{
+							// Like a foundation built in range, or a belt somewhere else
+							SML::Logging::info(*getTagName(), TEXT("Nothing connected changed. Skipping the update"));
+						}
+						else if (mustUpdate_)
 						{
-							// Recalculate connections
-							Server_UpdateConnectedProduction(true, false, 0, true, false, 0);
+							// Recalculate connections, as soon as the logic scheduler has budget for it
+							AEfficiencyCheckerLogic::singleton->requestUpdate(this);
 						}
 
 						SetActorTickEnabled(false);
@@ -497,6 +515,15 @@ void AEfficiencyCheckerBuilding::Server_UpdateBuilding(AFGBuildable* newBuildabl
 
 		if (newBuildable)
 		{
+			{
+				FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
+
+				// Recipe and sort rule changes come through here too
+				AEfficiencyCheckerLogic::singleton->flowField.invalidateRates(newBuildable);
+				AEfficiencyCheckerLogic::singleton->invalidateSubWalks(newBuildable);
+				AEfficiencyCheckerLogic::singleton->touchComponents(newBuildable);
+			}
+
 			Server_AddPendingBuilding(newBuildable);
 			// Trigger event to start listening for possible dismantle before checking the usage
 			AddOnDestroyBinding(newBuildable);
@@ -552,11 +579,16 @@ void AEfficiencyCheckerBuilding::UpdateBuildings(AFGBuildable* newBuildable)
 		//}
 	}
 
-	// Update all EfficiencyCheckerBuildings
+	// Update the EfficiencyCheckerBuildings that can be affected by the new buildable
 	FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
 
-	// Trigger all buildings
-	for (auto efficiencyBuilding : AEfficiencyCheckerLogic::singleton->allEfficiencyBuildings)
+	// Indexing it restarts the suspended walk when it is connected to what the walk went through
+	AEfficiencyCheckerLogic::singleton->indexBuildable(newBuildable);
+
+	AEfficiencyCheckerLogic::singleton->flowField.invalidateStructure(newBuildable);
+	AEfficiencyCheckerLogic::singleton->invalidateSubWalks(newBuildable, true);
+
+	for (auto efficiencyBuilding : AEfficiencyCheckerLogic::singleton->getCheckersAffectedByNewBuildable(newBuildable))
 	{
 		efficiencyBuilding->UpdateBuilding(newBuildable);
 	}
@@ -574,23 +606,36 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 	TSet<AFGBuildable*>& connected,
 	bool& in_overflow
 )
+{
+	const auto job = beginConnectedProduction(out_injectedInput, out_requiredOutput);
+
+	job->injectedItems.Append(AEfficiencyCheckerLogic::singleton->toItemSet(out_injectedItems));
+
+	job->resume();
+
+	finishConnectedProduction(*job, out_injectedInput, out_limitedThroughput, out_requiredOutput, out_injectedItems);
+
+	connected.Append(job->connected);
+	in_overflow = job->overflow;
+}
+
+TUniquePtr<FEfficiencyCheckerUpdateJob> AEfficiencyCheckerBuilding::beginConnectedProduction(float in_injectedInput, float in_requiredOutput)
 {
 	if (FEfficiencyCheckerModModule::dumpConnections)
 	{
 		SML::Logging::info(*getTagName(), TEXT("GetConnectedProduction"));
 	}
 
-	const FString indent(TEXT("    "));
-
 	const auto buildableSubsystem = AFGBuildableSubsystem::Get(GetWorld());
 
 	UFGConnectionComponent* inputConnector = nullptr;
 	UFGConnectionComponent* outputConnector = nullptr;
 
-	TSet<TSubclassOf<UFGItemDescriptor>> restrictedItems;
+	// The traversals work on interned item indexes
+	FEfficiencyCheckerItemSet restrictedItemSet;
+	FEfficiencyCheckerItemSet injectedItemSet;
 
 	float initialThroughtputLimit = 0;
-	in_overflow = false;
 
 	if (innerPipelineAttachment)
 	{
@@ -640,8 +685,10 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 
 		if (fluidItem)
 		{
-			restrictedItems.Add(fluidItem);
-			out_injectedItems.Add(fluidItem);
+			const auto fluidItemIndex = AEfficiencyCheckerLogic::singleton->getItemIndex(fluidItem);
+
+			restrictedItemSet.Add(fluidItemIndex);
+			injectedItemSet.Add(fluidItemIndex);
 		}
 	}
 	else if (resourceForm == EResourceForm::RF_SOLID)
@@ -664,7 +711,11 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 
 		FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
 
-		for (auto conveyorActor : AEfficiencyCheckerLogic::singleton->allBelts)
+		// Only the belts whose bounds are near the anchor point can intersect it
+		TArray<AFGBuildableConveyorBelt*> nearBelts;
+		AEfficiencyCheckerLogic::singleton->beltGrid.Query(FBox(anchorPoint, anchorPoint), nearBelts);
+
+		for (auto conveyorActor : nearBelts)
 		{
 			auto conveyor = Cast<AFGBuildableConveyorBelt>(conveyorActor);
 
@@ -766,25 +817,7 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 
 		if (inputConnector || outputConnector)
 		{
-			TArray<TSubclassOf<UFGItemDescriptor>> allItems;
-			UFGBlueprintFunctionLibrary::Cheat_GetAllDescriptors(allItems);
-
-			for (auto item : allItems)
-			{
-				if (!item ||
-					!UFGBlueprintFunctionLibrary::CanBeOnConveyor(item) ||
-					UFGItemDescriptor::GetForm(item) != EResourceForm::RF_SOLID ||
-					AEfficiencyCheckerLogic::singleton->wildCardItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->overflowItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->noneItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->anyUndefinedItemDescriptors.Contains(item)
-					)
-				{
-					continue;;
-				}
-
-				restrictedItems.Add(item);
-			}
+			restrictedItemSet = AEfficiencyCheckerLogic::singleton->getSolidConveyorItems();
 		}
 	}
 	else if ((resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS) && placementType == EPlacementType::PT_WALL)
@@ -806,7 +839,11 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 
 		FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
 
-		for (auto pipeActor : AEfficiencyCheckerLogic::singleton->allPipes)
+		// Only the pipes with a connector at the anchor point can match
+		TArray<AFGBuildablePipeline*> nearPipes;
+		AEfficiencyCheckerLogic::singleton->pipeGrid.Query(FBox(anchorPoint - FVector(1), anchorPoint + FVector(1)), nearPipes);
+
+		for (auto pipeActor : nearPipes)
 		{
 			auto pipe = Cast<AFGBuildablePipeline>(pipeActor);
 
@@ -866,8 +903,10 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 
 				if (fluidItem)
 				{
-					restrictedItems.Add(fluidItem);
-					out_injectedItems.Add(fluidItem);
+					const auto fluidItemIndex = AEfficiencyCheckerLogic::singleton->getItemIndex(fluidItem);
+
+					restrictedItemSet.Add(fluidItemIndex);
+					injectedItemSet.Add(fluidItemIndex);
 				}
 
 				initialThroughtputLimit = AEfficiencyCheckerLogic::getPipeSpeed(pipe);
@@ -877,55 +916,58 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 		}
 	}
 
-	float limitedThroughputIn = customInjectedInput ? injectedInput : initialThroughtputLimit;
+	auto job = MakeUnique<FEfficiencyCheckerUpdateJob>(this, resourceForm, buildableSubsystem);
 
-	if (inputConnector)
-	{
-		TSet<AActor*> seenActors;
-
-		AEfficiencyCheckerLogic::collectInput(
-			resourceForm,
-			injectedInput,
-			inputConnector,
-			out_injectedInput,
-			limitedThroughputIn,
-			seenActors,
-			connected,
-			out_injectedItems,
-			restrictedItems,
-			buildableSubsystem,
-			0,
-			in_overflow,
-			indent
-			);
-	}
+	job->graphVersion = AEfficiencyCheckerLogic::singleton->graphVersion;
+	job->componentsVersion = AEfficiencyCheckerLogic::singleton->components.getLastVersion();
 
-	float limitedThroughputOut = initialThroughtputLimit;
+	job->inputConnector = inputConnector;
+	job->outputConnector = outputConnector;
 
-	if (outputConnector && !customRequiredOutput)
-	{
-		std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>> seenActors;
-
-		AEfficiencyCheckerLogic::collectOutput(
-			resourceForm,
-			outputConnector,
-			out_requiredOutput,
-			limitedThroughputOut,
-			seenActors,
-			connected,
-			out_injectedItems,
-			buildableSubsystem,
-			0,
-			in_overflow,
-			indent
-			);
-	}
-	else
+	job->customInjectedInput = in_injectedInput != 0;
+	job->customRequiredOutput = customRequiredOutput;
+
+	job->injectedItems = injectedItemSet;
+	job->restrictedItems = restrictedItemSet;
+
+	job->injectedInput = in_injectedInput;
+	job->requiredOutput = in_requiredOutput;
+
+	job->limitedThroughputIn = customInjectedInput ? in_injectedInput : initialThroughtputLimit;
+	job->limitedThroughputOut = initialThroughtputLimit;
+
+	if (FEfficiencyCheckerModModule::useFlowField && (inputConnector || outputConnector))
 	{
-		limitedThroughputOut = requiredOutput;
+		FEfficiencyCheckerFlowValues flowValues;
+		TSet<AFGBuildable*> flowConnected;
+
+		// Falls back to walking the graph when the flow field could not resolve it
+		if (AEfficiencyCheckerLogic::singleton->getFlowValues((inputConnector ? inputConnector : outputConnector)->GetOwner(), flowValues, flowConnected))
+		{
+			if (FEfficiencyCheckerModModule::dumpConnections)
+			{
+				SML::Logging::info(*getTagName(), TEXT("GetConnectedProduction: read from the flow field"));
+			}
+
+			job->complete(flowValues, flowConnected);
+		}
 	}
 
-	if (!inputConnector && !outputConnector && FEfficiencyCheckerModModule::dumpConnections)
+	return job;
+}
+
+void AEfficiencyCheckerBuilding::finishConnectedProduction
+(
+	const FEfficiencyCheckerUpdateJob& job,
+	float& out_injectedInput,
+	float& out_limitedThroughput,
+	float& out_requiredOutput,
+	TSet<TSubclassOf<UFGItemDescriptor>>& out_injectedItems
+)
+{
+	AEfficiencyCheckerLogic::singleton->addItemsToSet(job.injectedItems, out_injectedItems);
+
+	if (!job.inputConnector && !job.outputConnector && FEfficiencyCheckerModModule::dumpConnections)
 	{
 		if (resourceForm == EResourceForm::RF_SOLID)
 		{
@@ -937,7 +979,9 @@ void AEfficiencyCheckerBuilding::GetConnectedProduction
 		}
 	}
 
-	out_limitedThroughput = FMath::Min(limitedThroughputIn, limitedThroughputOut);
+	out_injectedInput = job.injectedInput;
+	out_requiredOutput = job.requiredOutput;
+	out_limitedThroughput = FMath::Min(job.limitedThroughputIn, job.limitedThroughputOut);
 
 	if (FEfficiencyCheckerModModule::dumpConnections)
 	{
@@ -1011,12 +1055,6 @@ void AEfficiencyCheckerBuilding::Server_UpdateConnectedProduction
 			SML::Logging::info(*getTagName(), TEXT("Server_UpdateConnectedProduction"));
 		}
 
-		limitedThroughput = 0;
-
-		const TSet<AFGBuildable*> connectionsToUnbind(connectedBuildables);
-
-		connectedBuildables.Empty();
-
 		if (!keepCustomInput)
 		{
 			customInjectedInput = hasCustomInjectedInput;
@@ -1047,50 +1085,93 @@ void AEfficiencyCheckerBuilding::Server_UpdateConnectedProduction
 			requiredOutput = 0;
 		}
 
-		TSet<TSubclassOf<UFGItemDescriptor>> injectedItemsSet;
-
-		overflow = false;
+		// A scheduled refresh started before this one would publish stale custom amounts
+		AEfficiencyCheckerLogic::singleton->cancelUpdate(this);
 
-		GetConnectedProduction(injectedInput, limitedThroughput, requiredOutput, injectedItemsSet, connectedBuildables, overflow);
-
-		injectedItems = injectedItemsSet.Array();
+		{
+			FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
 
-		lastUpdated = GetWorld()->GetTimeSeconds();
-		updateRequested = 0;
+			// Changes that are not hooked (or any change, without autoUpdate) are read again on a manual refresh
+			for (auto buildable : connectedBuildables)
+			{
+				AEfficiencyCheckerLogic::singleton->flowField.invalidateRates(buildable);
+				AEfficiencyCheckerLogic::singleton->invalidateSubWalks(buildable);
+			}
+		}
 
-		SetActorTickEnabled(false);
-		//mFactoryTickFunction.SetTickFunctionEnable(false);
+		const auto job = beginConnectedProduction(injectedInput, requiredOutput);
 
-		if (FEfficiencyCheckerModModule::autoUpdate && autoUpdateMode == EAutoUpdateType::AUT_USE_DEFAULT ||
-			autoUpdateMode == EAutoUpdateType::AUT_ENABLED)
-		{
-			// Remove bindings for all that are on connectionsToUnbind but not on connectedBuildables
-			const auto bindingsToRemove = connectionsToUnbind.Difference(connectedBuildables);
-			removeOnDestroyBindings(bindingsToRemove);
-			removeOnRecipeChangedBindings(bindingsToRemove);
-			removeOnSortRulesChangedDelegateBindings(bindingsToRemove);
-
-			// Add bindings for all that are on connectedBuildables but not on connectionsToUnbind
-			const auto bindingsToAdd = connectedBuildables.Difference(connectionsToUnbind);
-			addOnDestroyBindings(bindingsToAdd);
-			addOnRecipeChangedBindings(bindingsToAdd);
-			addOnSortRulesChangedDelegateBindings(bindingsToAdd);
-		}
+		job->resume();
 
-		UpdateItem(injectedInput, limitedThroughput, requiredOutput, injectedItems, overflow);
+		applyConnectedProduction(*job);
 	}
 	else
 	{
 		if (FEfficiencyCheckerModModule::dumpConnections)
 		{
 			SML::Logging::info(*getTagName(), TEXT("Server_UpdateConnectedProduction - no authority"));
+			SML::Logging::info(TEXT("===="));
 		}
 	}
+}
+
+TUniquePtr<FEfficiencyCheckerUpdateJob> AEfficiencyCheckerBuilding::beginScheduledUpdate()
+{
+	if (!HasAuthority() || !FEfficiencyCheckerModModule::compatibleVersion)
+	{
+		return nullptr;
+	}
 
 	if (FEfficiencyCheckerModModule::dumpConnections)
 	{
-		SML::Logging::info(TEXT("===="));
+		SML::Logging::info(*getTagName(), TEXT("beginScheduledUpdate"));
 	}
+
+	// Same as Server_UpdateConnectedProduction keeping the custom input and output
+	return beginConnectedProduction(customInjectedInput ? injectedInput : 0, customRequiredOutput ? requiredOutput : 0);
+}
+
+void AEfficiencyCheckerBuilding::applyConnectedProduction(FEfficiencyCheckerUpdateJob& job)
+{
+	const TSet<AFGBuildable*> connectionsToUnbind(connectedBuildables);
+
+	TSet<TSubclassOf<UFGItemDescriptor>> injectedItemsSet;
+
+	finishConnectedProduction(job, injectedInput, limitedThroughput, requiredOutput, injectedItemsSet);
+
+	injectedItems = injectedItemsSet.Array();
+	connectedBuildables = MoveTemp(job.connected);
+	overflow = job.overflow;
+	bottlenecks = job.getBottlenecks();
+	componentsVersion = job.componentsVersion;
+
+	AEfficiencyCheckerLogic::singleton->removeCheckerDependencies(this, connectionsToUnbind.Difference(connectedBuildables));
+	AEfficiencyCheckerLogic::singleton->addCheckerDependencies(this, connectedBuildables.Difference(connectionsToUnbind));
+
+	lastUpdated = GetWorld()->GetTimeSeconds();
+	updateRequested = 0;
+
+	SetActorTickEnabled(false);
+	//mFactoryTickFunction.SetTickFunctionEnable(false);
+
+	if (FEfficiencyCheckerModModule::autoUpdate && autoUpdateMode == EAutoUpdateType::AUT_USE_DEFAULT ||
+		autoUpdateMode == EAutoUpdateType::AUT_ENABLED)
+	{
+		// Remove bindings for all that are on connectionsToUnbind but not on connectedBuildables
+		const auto bindingsToRemove = connectionsToUnbind.Difference(connectedBuildables);
+		removeOnDestroyBindings(bindingsToRemove);
+		removeOnRecipeChangedBindings(bindingsToRemove);
+		removeOnSortRulesChangedDelegateBindings(bindingsToRemove);
+
+		// Add bindings for all that are on connectedBuildables but not on connectionsToUnbind
+		const auto bindingsToAdd = connectedBuildables.Difference(connectionsToUnbind);
+		addOnDestroyBindings(bindingsToAdd);
+		addOnRecipeChangedBindings(bindingsToAdd);
+		addOnSortRulesChangedDelegateBindings(bindingsToAdd);
+	}
+
+	UpdateItem(injectedInput, limitedThroughput, requiredOutput, injectedItems, overflow);
+	UpdateBottlenecks(bottlenecks);
 }
 
 void AEfficiencyCheckerBuilding::addOnDestroyBindings(const TSet<AFGBuildable*>& buildings)
@@ -1183,7 +1264,14 @@ void AEfficiencyCheckerBuilding::Server_RemoveBuilding(AFGBuildable* buildable)
 	if (HasAuthority())
 	{
 		pendingBuildables.Remove(buildable);
-		connectedBuildables.Remove(buildable);
+
+		if (connectedBuildables.Remove(buildable))
+		{
+			TSet<AFGBuildable*> removedBuildables;
+			removedBuildables.Add(buildable);
+
+			AEfficiencyCheckerLogic::singleton->removeCheckerDependencies(this, removedBuildables);
+		}
 	}
 }
 
@@ -1207,14 +1295,49 @@ void AEfficiencyCheckerBuilding::setPendingPotentialCallback(class AFGBuildableF
 		potential
 		);
 
+	updateDependentCheckers(buildable);
+}
+
+void AEfficiencyCheckerBuilding::setRecipeCallback(AFGBuildableManufacturer* manufacturer, TSubclassOf<UFGRecipe> recipe)
+{
+	SML::Logging::info(
+		*getTimeStamp(),
+		TEXT(" EfficiencyCheckerBuilding: SetRecipe of building "),
+		*GetPathNameSafe(manufacturer),
+		TEXT(" to "),
+		*GetPathNameSafe(recipe)
+		);
+
+	updateDependentCheckers(manufacturer);
+}
+
+void AEfficiencyCheckerBuilding::sortRulesChangedCallback(AFGBuildableSplitterSmart* smartSplitter)
+{
+	SML::Logging::info(
+		*getTimeStamp(),
+		TEXT(" EfficiencyCheckerBuilding: sort rules changed of building "),
+		*GetPathNameSafe(smartSplitter)
+		);
+
+	AEfficiencyCheckerLogic::singleton->invalidateSortRules(smartSplitter);
+
+	updateDependentCheckers(smartSplitter);
+}
+
+void AEfficiencyCheckerBuilding::updateDependentCheckers(AFGBuildable* buildable)
+{
 	// Update all EfficiencyCheckerBuildings that connects to this building
 	FScopeLock ScopeLock(&AEfficiencyCheckerLogic::singleton->eclCritical);
 
-	for (auto efficiencyBuilding : AEfficiencyCheckerLogic::singleton->allEfficiencyBuildings)
+	AEfficiencyCheckerLogic::singleton->flowField.invalidateRates(buildable);
+	AEfficiencyCheckerLogic::singleton->invalidateSubWalks(buildable);
+	AEfficiencyCheckerLogic::singleton->touchComponents(buildable);
+
+	for (auto efficiencyBuilding : AEfficiencyCheckerLogic::singleton->getDependentCheckers(buildable))
 	{
-		if (efficiencyBuilding->HasAuthority() && efficiencyBuilding->connectedBuildables.Contains(buildable))
+		if (efficiencyBuilding->HasAuthority())
 		{
-			efficiencyBuilding->Server_UpdateConnectedProduction(true, false, 0, true, false, 0);
+			AEfficiencyCheckerLogic::singleton->requestUpdate(efficiencyBuilding);
 		}
 	}
 }
@@ -1235,6 +1358,8 @@ void AEfficiencyCheckerBuilding::GetLifetimeReplicatedProps(TArray<FLifetimeProp
 
 	DOREPLIFETIME(AEfficiencyCheckerBuilding, overflow);
 
+	DOREPLIFETIME(AEfficiencyCheckerBuilding, bottlenecks);
+
 	// DOREPLIFETIME(AEfficiencyCheckerBuilding, connectedBuildables);
 
 	// DOREPLIFETIME(AEfficiencyCheckerBuilding, pendingBuildables);
@@ -1315,3 +1440,13 @@ void AEfficiencyCheckerBuilding::UpdateItem_Implementation
 {
 	OnUpdateItem.Broadcast(in_injectedInput, in_limitedThroughput, in_requiredOutput, in_injectedItems, in_overflow);
 }
+
+void AEfficiencyCheckerBuilding::UpdateBottlenecks_Implementation(const TArray<FEfficiencyCheckerBottleneck>& in_bottlenecks)
+{
+	OnUpdateBottlenecks.Broadcast(in_bottlenecks);
+}
+
+void AEfficiencyCheckerBuilding::GetBottlenecks(TArray<FEfficiencyCheckerBottleneck>& out_bottlenecks) const
+{
+	out_bottlenecks = bottlenecks;
+}
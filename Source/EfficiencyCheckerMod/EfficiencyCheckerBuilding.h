@@ -11,6 +11,8 @@
 #include "FGBuildableSplitterSmart.h"
 #include "EfficiencyCheckerBuilding.generated.h"
 
+class FEfficiencyCheckerUpdateJob;
+
 UENUM( BlueprintType )
 enum class EPlacementType: uint8
 {
@@ -28,6 +30,24 @@ enum class EAutoUpdateType: uint8
     AUT_DISABLED UMETA(DisplayName = "Disabled"),
 };
 
+// Belt, pipe or pump whose capacity sets the limited throughput of a checker
+USTRUCT(BlueprintType)
+struct EFFICIENCYCHECKERMOD_API FEfficiencyCheckerBottleneck
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "EfficiencyChecker")
+    AFGBuildable* buildable = nullptr;
+
+    // Capacity of the segment, in items/minute or m3/minute
+    UPROPERTY(BlueprintReadOnly, Category = "EfficiencyChecker")
+    float limit = 0;
+
+    // Buildables walked from the checker to the segment, both ends included
+    UPROPERTY(BlueprintReadOnly, Category = "EfficiencyChecker")
+    TArray<AFGBuildable*> path;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(
     FUpdateItemEvent,
     float,
@@ -42,6 +62,12 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(
     overflow
     );
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
+    FUpdateBottlenecksEvent,
+    const TArray<FEfficiencyCheckerBottleneck>&,
+    bottlenecks
+    );
+
 UCLASS(Blueprintable)
 // ReSharper disable once CppClassCanBeFinal
 class EFFICIENCYCHECKERMOD_API AEfficiencyCheckerBuilding : public AFGBuildable
@@ -74,6 +100,10 @@ public:
     //bool checkFactoryTick_ = true;
     bool mustUpdate_ = true;
 
+    // Version of the belt and pipe components when the last result was computed. Scheduled refreshes are skipped while
+    // none of the components of connectedBuildables changed after it
+    int32 componentsVersion = INDEX_NONE;
+
     UPROPERTY()
     AFGBuildablePipeline* pipelineToSplit = nullptr;
     float pipelineSplitOffset = 0;
@@ -132,6 +162,12 @@ public:
         UPARAM(DisplayName = "Custom Required Output") float in_customRequiredOutput
     );
 
+    // Refresh keeping the custom input and output, to be run in slices by the update scheduler. Null when it can't run here
+    TUniquePtr<FEfficiencyCheckerUpdateJob> beginScheduledUpdate();
+
+    // Publishes the result of a complete refresh
+    void applyConnectedProduction(FEfficiencyCheckerUpdateJob& job);
+
     UPROPERTY(BlueprintAssignable, Category = "EfficiencyChecker")
     FUpdateItemEvent OnUpdateItem;
 
@@ -145,6 +181,17 @@ public:
         UPARAM(DisplayName = "Overflow") bool in_overflow
     );
 
+    // Fired after OnUpdateItem, with the segments that limit the throughput
+    UPROPERTY(BlueprintAssignable, Category = "EfficiencyChecker")
+    FUpdateBottlenecksEvent OnUpdateBottlenecks;
+
+    UFUNCTION(Category = "EfficiencyChecker", NetMulticast, Reliable)
+    virtual void UpdateBottlenecks(UPARAM(DisplayName = "Bottlenecks") const TArray<FEfficiencyCheckerBottleneck>& in_bottlenecks);
+
+    // Segments that limit the throughput, from the last update
+    UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "EfficiencyChecker")
+    virtual void GetBottlenecks(UPARAM(DisplayName = "Bottlenecks") TArray<FEfficiencyCheckerBottleneck>& out_bottlenecks) const;
+
     UFUNCTION(BlueprintImplementableEvent, Category = "EfficiencyChecker")
     void AddOnDestroyBinding(AFGBuildable* buildable);
 
@@ -231,6 +278,9 @@ public:
     UPROPERTY(BlueprintReadOnly, SaveGame, Replicated)
     bool overflow = false;
 
+    UPROPERTY(BlueprintReadOnly, Replicated)
+    TArray<FEfficiencyCheckerBottleneck> bottlenecks;
+
     UPROPERTY(BlueprintReadOnly, SaveGame, Replicated)
     EAutoUpdateType autoUpdateMode = EAutoUpdateType::AUT_USE_DEFAULT;
 
@@ -269,7 +319,24 @@ public:
 
 protected:
 
+    // Finds the connectors under the checker and sets up the walks from them, starting with the given amounts
+    TUniquePtr<FEfficiencyCheckerUpdateJob> beginConnectedProduction(float in_injectedInput, float in_requiredOutput);
+
+    void finishConnectedProduction
+    (
+        const FEfficiencyCheckerUpdateJob& job,
+        float& out_injectedInput,
+        float& out_limitedThroughput,
+        float& out_requiredOutput,
+        TSet<TSubclassOf<UFGItemDescriptor>>& out_injectedItems
+    );
+
     static void setPendingPotentialCallback(class AFGBuildableFactory* buildable, float potential);
+    static void setRecipeCallback(class AFGBuildableManufacturer* manufacturer, TSubclassOf<class UFGRecipe> recipe);
+    static void sortRulesChangedCallback(class AFGBuildableSplitterSmart* smartSplitter);
+
+    // Marks the rates of the buildable as changed and queues a refresh of the checkers that depend on it
+    static void updateDependentCheckers(AFGBuildable* buildable);
 
     void addOnDestroyBindings(const TSet<AFGBuildable*>& buildings);
     void removeOnDestroyBindings(const TSet<AFGBuildable*>& buildings);
@@ -86,14 +86,13 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 	UFGConnectionComponent* inputConnector = nullptr;
 	UFGConnectionComponent* outputConnector = nullptr;
 
-	TSet<TSubclassOf<UFGItemDescriptor>> restrictedItems;
+	FEfficiencyCheckerItemSet restrictedItems;
 
 	auto resourceForm = EResourceForm::RF_INVALID;
 
 	TSet<AFGBuildable*> connected;
 	const auto buildableSubsystem = AFGBuildableSubsystem::Get(GetWorld());
-	const FString indent(TEXT("    "));
-	TSet<TSubclassOf<UFGItemDescriptor>> injectedItemsSet;
+	FEfficiencyCheckerItemSet injectedItemsSet;
 
 	float initialThroughtputLimit = 0;
 	bool overflow = false;
@@ -110,25 +109,7 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 
 			resourceForm = EResourceForm::RF_SOLID;
 
-			TArray<TSubclassOf<UFGItemDescriptor>> allItems;
-			UFGBlueprintFunctionLibrary::Cheat_GetAllDescriptors(allItems);
-
-			for (auto item : allItems)
-			{
-				if (!item ||
-					!UFGBlueprintFunctionLibrary::CanBeOnConveyor(item) ||
-					UFGItemDescriptor::GetForm(item) != EResourceForm::RF_SOLID ||
-					AEfficiencyCheckerLogic::singleton->wildCardItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->overflowItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->noneItemDescriptors.Contains(item) ||
-					AEfficiencyCheckerLogic::singleton->anyUndefinedItemDescriptors.Contains(item)
-					)
-				{
-					continue;;
-				}
-
-				restrictedItems.Add(item);
-			}
+			restrictedItems = AEfficiencyCheckerLogic::singleton->getSolidConveyorItems();
 		}
 		else
 		{
@@ -156,8 +137,10 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 
 				if (fluidItem)
 				{
-					restrictedItems.Add(fluidItem);
-					injectedItemsSet.Add(fluidItem);
+					const auto fluidItemIndex = AEfficiencyCheckerLogic::singleton->getItemIndex(fluidItem);
+
+					restrictedItems.Add(fluidItemIndex);
+					injectedItemsSet.Add(fluidItemIndex);
 
 					resourceForm = UFGItemDescriptor::GetForm(fluidItem);
 				}
@@ -170,8 +153,25 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 	}
 
 	float limitedThroughputIn = initialThroughtputLimit;
+	float limitedThroughputOut = initialThroughtputLimit;
+
+	FEfficiencyCheckerFlowValues flowValues;
 
-	if (inputConnector)
+	const auto fromFlowField = FEfficiencyCheckerModModule::useFlowField &&
+		(inputConnector || outputConnector) &&
+		AEfficiencyCheckerLogic::singleton->getFlowValues(targetBuildable, flowValues, connected);
+
+	if (fromFlowField)
+	{
+		injectedInput = flowValues.injectedInput;
+		requiredOutput = flowValues.requiredOutput;
+
+		limitedThroughputIn = limitedThroughputOut = FMath::Min(initialThroughtputLimit, flowValues.limitedThroughput);
+
+		injectedItemsSet.Append(flowValues.injectedItems.Intersect(restrictedItems));
+	}
+
+	if (inputConnector && !fromFlowField)
 	{
 		TSet<AActor*> seenActors;
 
@@ -186,17 +186,13 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 			injectedItemsSet,
 			restrictedItems,
 			buildableSubsystem,
-			0,
-			overflow,
-			indent
+			overflow
 			);
 	}
 
-	float limitedThroughputOut = initialThroughtputLimit;
-
-	if (outputConnector)
+	if (outputConnector && !fromFlowField)
 	{
-		std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>> seenActors;
+		FEfficiencyCheckerSeenActors seenActors;
 
 		AEfficiencyCheckerLogic::collectOutput(
 			resourceForm,
@@ -207,15 +203,16 @@ void AEfficiencyCheckerEquipment::PrimaryFirePressed_Server(AFGBuildable* target
 			connected,
 			injectedItemsSet,
 			buildableSubsystem,
-			0,
-			overflow,
-			indent
+			overflow
 			);
 	}
 
 	if (inputConnector || outputConnector)
 	{
-		ShowStatsWidget(injectedInput, min(limitedThroughputIn, limitedThroughputOut), requiredOutput, injectedItemsSet.Array(), overflow);
+		TSet<TSubclassOf<UFGItemDescriptor>> injectedItems;
+		AEfficiencyCheckerLogic::singleton->addItemsToSet(injectedItemsSet, injectedItems);
+
+		ShowStatsWidget(injectedInput, min(limitedThroughputIn, limitedThroughputOut), requiredOutput, injectedItems.Array(), overflow);
 	}
 }
 
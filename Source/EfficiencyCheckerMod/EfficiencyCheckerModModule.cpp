@@ -3,6 +3,8 @@
 #include "EfficiencyCheckerBuilding.h"
 
 #include "FGBuildableFactory.h"
+#include "FGBuildableManufacturer.h"
+#include "FGBuildableSplitterSmart.h"
 #include "FGGameMode.h"
 #include "FGVersionFunctionLibrary.h"
 
@@ -20,6 +22,15 @@ bool FEfficiencyCheckerModModule::dumpConnections = false;
 float FEfficiencyCheckerModModule::autoUpdateTimeout = 10;
 float FEfficiencyCheckerModModule::autoUpdateDistance = 5 * 800;
 bool FEfficiencyCheckerModModule::ignoreStorageTeleporter = false;
+int32 FEfficiencyCheckerModModule::traversalNodeBudget = 100000;
+float FEfficiencyCheckerModModule::updateBudgetMs = 5;
+int32 FEfficiencyCheckerModModule::updateSliceNodes = 0;
+bool FEfficiencyCheckerModModule::useFlowField = false;
+bool FEfficiencyCheckerModModule::condenseLoops = false;
+bool FEfficiencyCheckerModModule::solveMaxFlow = false;
+bool FEfficiencyCheckerModModule::cacheSubWalks = false;
+bool FEfficiencyCheckerModModule::aggregatePipeNetworks = false;
+bool FEfficiencyCheckerModModule::compressChains = false;
 bool FEfficiencyCheckerModModule::compatibleVersion = true;
 int32 FEfficiencyCheckerModModule::currentGameVersion = 0;
 int32 FEfficiencyCheckerModModule::compatibleGameVersion = 138229;
@@ -50,6 +61,15 @@ void FEfficiencyCheckerModModule::StartupModule()
     defaultValues->SetNumberField(TEXT("autoUpdateDistance"), autoUpdateDistance);
     defaultValues->SetBoolField(TEXT("dumpConnections"), dumpConnections);
     defaultValues->SetBoolField(TEXT("ignoreStorageTeleporter"), ignoreStorageTeleporter);
+    defaultValues->SetNumberField(TEXT("traversalNodeBudget"), traversalNodeBudget);
+    defaultValues->SetNumberField(TEXT("updateBudgetMs"), updateBudgetMs);
+    defaultValues->SetNumberField(TEXT("updateSliceNodes"), updateSliceNodes);
+    defaultValues->SetBoolField(TEXT("useFlowField"), useFlowField);
+    defaultValues->SetBoolField(TEXT("condenseLoops"), condenseLoops);
+    defaultValues->SetBoolField(TEXT("solveMaxFlow"), solveMaxFlow);
+    defaultValues->SetBoolField(TEXT("cacheSubWalks"), cacheSubWalks);
+    defaultValues->SetBoolField(TEXT("aggregatePipeNetworks"), aggregatePipeNetworks);
+    defaultValues->SetBoolField(TEXT("compressChains"), compressChains);
 
     defaultValues = SML::ReadModConfig(TEXT("EfficiencyChecker"), defaultValues);
 
@@ -58,12 +78,30 @@ void FEfficiencyCheckerModModule::StartupModule()
     autoUpdateDistance = defaultValues->GetNumberField(TEXT("autoUpdateDistance"));
     dumpConnections = defaultValues->GetBoolField(TEXT("dumpConnections"));
     ignoreStorageTeleporter = defaultValues->GetBoolField(TEXT("ignoreStorageTeleporter"));
+    traversalNodeBudget = defaultValues->GetIntegerField(TEXT("traversalNodeBudget"));
+    updateBudgetMs = defaultValues->GetNumberField(TEXT("updateBudgetMs"));
+    updateSliceNodes = defaultValues->GetIntegerField(TEXT("updateSliceNodes"));
+    useFlowField = defaultValues->GetBoolField(TEXT("useFlowField"));
+    condenseLoops = defaultValues->GetBoolField(TEXT("condenseLoops"));
+    solveMaxFlow = defaultValues->GetBoolField(TEXT("solveMaxFlow"));
+    cacheSubWalks = defaultValues->GetBoolField(TEXT("cacheSubWalks"));
+    aggregatePipeNetworks = defaultValues->GetBoolField(TEXT("aggregatePipeNetworks"));
+    compressChains = defaultValues->GetBoolField(TEXT("compressChains"));
 
     SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: autoUpdate = "), autoUpdate ? TEXT("true") : TEXT("false"));
     SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: autoUpdateTimeout = "), autoUpdateTimeout);
     SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: autoUpdateDistance = "), autoUpdateDistance);
     SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: dumpConnections = "), dumpConnections ? TEXT("true") : TEXT("false"));
     SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: ignoreStorageTeleporter = "), ignoreStorageTeleporter ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: traversalNodeBudget = "), traversalNodeBudget);
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: updateBudgetMs = "), updateBudgetMs);
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: updateSliceNodes = "), updateSliceNodes);
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: useFlowField = "), useFlowField ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: condenseLoops = "), condenseLoops ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: solveMaxFlow = "), solveMaxFlow ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: cacheSubWalks = "), cacheSubWalks ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: aggregatePipeNetworks = "), aggregatePipeNetworks ? TEXT("true") : TEXT("false"));
+    SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: compressChains = "), compressChains ? TEXT("true") : TEXT("false"));
 
     // FString PatternString(TEXT("CL#(\\d+)$"));
     // FRegexPattern Pattern(PatternString);
@@ -100,6 +138,42 @@ void FEfficiencyCheckerModModule::StartupModule()
             }
             );
 
+        SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: Hooking AFGBuildableManufacturer::SetRecipe"));
+
+        SUBSCRIBE_METHOD_AFTER(
+            AFGBuildableManufacturer::SetRecipe,
+            [](AFGBuildableManufacturer * manufacturer, TSubclassOf<UFGRecipe> recipe)
+            {
+            AEfficiencyCheckerBuilding::setRecipeCallback(manufacturer, recipe);
+            }
+            );
+
+        SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyChecker: Hooking AFGBuildableSplitterSmart sort rules"));
+
+        SUBSCRIBE_METHOD_AFTER(
+            AFGBuildableSplitterSmart::SetSortRuleAt,
+            [](AFGBuildableSplitterSmart * smartSplitter, int32 index, FSplitterSortRule rule)
+            {
+            AEfficiencyCheckerBuilding::sortRulesChangedCallback(smartSplitter);
+            }
+            );
+
+        SUBSCRIBE_METHOD_AFTER(
+            AFGBuildableSplitterSmart::AddSortRule,
+            [](AFGBuildableSplitterSmart * smartSplitter, FSplitterSortRule rule)
+            {
+            AEfficiencyCheckerBuilding::sortRulesChangedCallback(smartSplitter);
+            }
+            );
+
+        SUBSCRIBE_METHOD_AFTER(
+            AFGBuildableSplitterSmart::RemoveSortRuleAt,
+            [](AFGBuildableSplitterSmart * smartSplitter, int32 index)
+            {
+            AEfficiencyCheckerBuilding::sortRulesChangedCallback(smartSplitter);
+            }
+            );
+
         // SUBSCRIBE_VIRTUAL_FUNCTION_AFTER(
         //     AFGBuildableFactory,
         //     AFGBuildableFactory::SetPendingPotential,
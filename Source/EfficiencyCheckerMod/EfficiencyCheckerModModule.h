@@ -24,6 +24,15 @@ public:
 	static float autoUpdateTimeout;
 	static float autoUpdateDistance;
 	static bool ignoreStorageTeleporter;
+	static int32 traversalNodeBudget;
+	static float updateBudgetMs;
+	static int32 updateSliceNodes;
+	static bool useFlowField;
+	static bool condenseLoops;
+	static bool solveMaxFlow;
+	static bool cacheSubWalks;
+	static bool aggregatePipeNetworks;
+	static bool compressChains;
 	static bool compatibleVersion;
 	static int32 currentGameVersion;
 	static int32 compatibleGameVersion;
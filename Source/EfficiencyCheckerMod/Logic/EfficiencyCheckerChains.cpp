@@ -0,0 +1,222 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerChains.h"
+
+#include "FGBuildableConveyorBase.h"
+#include "FGFactoryConnectionComponent.h"
+
+#include "Algo/Reverse.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+TSharedPtr<const FEfficiencyCheckerChain> FEfficiencyCheckerChains::findChain
+(
+	const FEfficiencyCheckerGraph& graph,
+	const AActor* actor,
+	int32& out_position
+)
+{
+	const auto existingChain = chainByActor.Find(actor);
+	if (existingChain)
+	{
+		out_position = existingChain->Value;
+
+		return existingChain->Key;
+	}
+
+	const auto nodeIndex = graph.findNode(actor);
+	const auto node = graph.getNode(nodeIndex);
+
+	UFGFactoryConnectionComponent* input = nullptr;
+	UFGFactoryConnectionComponent* output = nullptr;
+
+	if (!node || !isLink(*node, input, output))
+	{
+		return nullptr;
+	}
+
+	auto chain = MakeShared<FEfficiencyCheckerChain>();
+
+	const auto addMember = [&chain](const FEfficiencyCheckerNode& member, UFGFactoryConnectionComponent* memberInput, UFGFactoryConnectionComponent* memberOutput)
+	{
+		chain->members.Add(member.buildable);
+		chain->inputs.Add(memberInput);
+		chain->outputs.Add(memberOutput);
+		chain->classFlags.Add(member.classFlags);
+		chain->capacities.Add(
+			EnumHasAnyFlags(member.classFlags, EEfficiencyCheckerClassFlags::ConveyorBase)
+				? static_cast<AFGBuildableConveyorBase*>(member.buildable)->GetSpeed() / 2
+				: FLT_MAX
+			);
+	};
+
+	TSet<int32> seenNodes;
+	seenNodes.Add(nodeIndex);
+
+	// Upstream first, collected backwards
+	addMember(*node, input, output);
+	chain->input = input;
+
+	for (;;)
+	{
+		const auto previousIndex = graph.findConnectedNode(chain->input);
+		const auto previous = graph.getNode(previousIndex);
+
+		UFGFactoryConnectionComponent* previousInput = nullptr;
+		UFGFactoryConnectionComponent* previousOutput = nullptr;
+
+		if (!previous || seenNodes.Contains(previousIndex) || !isLink(*previous, previousInput, previousOutput) ||
+			previousOutput != chain->input->GetConnection())
+		{
+			break;
+		}
+
+		seenNodes.Add(previousIndex);
+		addMember(*previous, previousInput, previousOutput);
+		chain->input = previousInput;
+	}
+
+	Algo::Reverse(chain->members);
+	Algo::Reverse(chain->classFlags);
+	Algo::Reverse(chain->capacities);
+	Algo::Reverse(chain->inputs);
+	Algo::Reverse(chain->outputs);
+
+	chain->output = output;
+
+	for (;;)
+	{
+		const auto nextIndex = graph.findConnectedNode(chain->output);
+		const auto next = graph.getNode(nextIndex);
+
+		UFGFactoryConnectionComponent* nextInput = nullptr;
+		UFGFactoryConnectionComponent* nextOutput = nullptr;
+
+		if (!next || seenNodes.Contains(nextIndex) || !isLink(*next, nextInput, nextOutput) ||
+			nextInput != chain->output->GetConnection())
+		{
+			break;
+		}
+
+		seenNodes.Add(nextIndex);
+		addMember(*next, nextInput, nextOutput);
+		chain->output = nextOutput;
+	}
+
+	if (chain->members.Num() < 2)
+	{
+		return nullptr;
+	}
+
+	for (auto position = 0; position < chain->members.Num(); position++)
+	{
+		const auto member = chain->members[position];
+
+		chainByActor.Add(member, TPair<TSharedPtr<const FEfficiencyCheckerChain>, int32>(chain, position));
+
+		if (member == actor)
+		{
+			out_position = position;
+		}
+	}
+
+	return chain;
+}
+
+void FEfficiencyCheckerChains::invalidate(const FEfficiencyCheckerGraph& graph, const AActor* actor)
+{
+	removeChain(actor);
+
+	const auto node = graph.getNode(graph.findNode(actor));
+	if (!node)
+	{
+		return;
+	}
+
+	for (auto connection : node->factoryConnections)
+	{
+		const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+		if (otherNode)
+		{
+			removeChain(otherNode->buildable);
+		}
+	}
+}
+
+void FEfficiencyCheckerChains::Empty()
+{
+	chainByActor.Empty();
+}
+
+bool FEfficiencyCheckerChains::isLink
+(
+	const FEfficiencyCheckerNode& node,
+	UFGFactoryConnectionComponent*& out_input,
+	UFGFactoryConnectionComponent*& out_output
+)
+{
+	const auto belt = EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::ConveyorBase);
+
+	if (!belt && (!EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::ConveyorAttachment) ||
+		EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::SplitterSmart)))
+	{
+		return false;
+	}
+
+	out_input = nullptr;
+	out_output = nullptr;
+
+	for (auto connection : node.factoryConnections)
+	{
+		if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR || !connection->IsConnected())
+		{
+			continue;
+		}
+
+		UFGFactoryConnectionComponent** slot;
+
+		switch (connection->GetDirection())
+		{
+		case EFactoryConnectionDirection::FCD_INPUT:
+			slot = &out_input;
+			break;
+		case EFactoryConnectionDirection::FCD_OUTPUT:
+			slot = &out_output;
+			break;
+		default:
+			continue;
+		}
+
+		if (*slot)
+		{
+			// A split or a join
+			return false;
+		}
+
+		*slot = connection;
+	}
+
+	return out_input && out_output;
+}
+
+void FEfficiencyCheckerChains::removeChain(const AActor* actor)
+{
+	const auto existingChain = chainByActor.Find(actor);
+	if (!existingChain)
+	{
+		return;
+	}
+
+	const auto chain = existingChain->Key;
+
+	for (auto member : chain->members)
+	{
+		chainByActor.Remove(member);
+	}
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+
+class AActor;
+class AFGBuildable;
+class UFGFactoryConnectionComponent;
+
+// Belts, lifts and attachments with a single input and a single output, one after the other
+struct FEfficiencyCheckerChain
+{
+    // From the input end to the output end
+    TArray<AFGBuildable*> members;
+    TArray<EEfficiencyCheckerClassFlags> classFlags;
+
+    // Speed of each member in items/minute. Unlimited for attachments
+    TArray<float> capacities;
+
+    // Input and output connection of each member, for a walk suspended inside the chain to resume from there
+    TArray<UFGFactoryConnectionComponent*> inputs;
+    TArray<UFGFactoryConnectionComponent*> outputs;
+
+    // Input connection of the first member, and output connection of the last one
+    UFGFactoryConnectionComponent* input = nullptr;
+    UFGFactoryConnectionComponent* output = nullptr;
+};
+
+/**
+ * Linear runs of the indexed graph, so that the traversals can go from one end of a run to the other without visiting
+ * each segment.
+ *
+ * A chain is collected on the first read of any of its members, and dropped when any of them or what is connected to
+ * them changes, so that splits and joins only undo the chains around them. Smart splitters filter items, and are
+ * never part of a chain.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerChains
+{
+public:
+    // Chain of the actor, and its position there. Null when the actor is not linked to anything
+    TSharedPtr<const FEfficiencyCheckerChain> findChain(const FEfficiencyCheckerGraph& graph, const AActor* actor, int32& out_position);
+
+    // Drops the chains of the actor and of what it is connected to
+    void invalidate(const FEfficiencyCheckerGraph& graph, const AActor* actor);
+
+    inline int32
+    Num() const
+    {
+        return chainByActor.Num();
+    }
+
+    void Empty();
+
+protected:
+    // Belts and lifts, and plain attachments with exactly one connected input and one connected output
+    static bool isLink(const FEfficiencyCheckerNode& node, UFGFactoryConnectionComponent*& out_input, UFGFactoryConnectionComponent*& out_output);
+
+    void removeChain(const AActor* actor);
+
+    TMap<const AActor*, TPair<TSharedPtr<const FEfficiencyCheckerChain>, int32>> chainByActor;
+};
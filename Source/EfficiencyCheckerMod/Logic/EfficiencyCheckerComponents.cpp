@@ -0,0 +1,269 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerComponents.h"
+
+#include "FGBuildable.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGPipeConnectionComponent.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+void FEfficiencyCheckerComponents::addNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex)
+{
+	const auto node = graph.getNode(nodeIndex);
+	if (!node || elementByActor.Contains(node->buildable))
+	{
+		return;
+	}
+
+	const auto element = addElement(node->buildable);
+	const auto carrier = isCarrier(node->classFlags);
+
+	const auto visitNeighbour = [this, &graph, element, carrier](int32 otherIndex)
+	{
+		const auto otherNode = graph.getNode(otherIndex);
+		if (!otherNode)
+		{
+			return;
+		}
+
+		const auto otherElement = elementByActor.Find(otherNode->buildable);
+		if (!otherElement)
+		{
+			// Joined when it is indexed
+			return;
+		}
+
+		if (carrier && isCarrier(otherNode->classFlags))
+		{
+			join(element, *otherElement);
+		}
+		else
+		{
+			// Walks from there can now go on into the new node
+			bump(*otherElement);
+		}
+	};
+
+	for (auto connection : node->factoryConnections)
+	{
+		visitNeighbour(graph.findConnectedNode(connection));
+	}
+
+	for (auto connection : node->pipeConnections)
+	{
+		visitNeighbour(graph.findConnectedNode(connection));
+	}
+
+	bump(element);
+}
+
+void FEfficiencyCheckerComponents::removeNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex)
+{
+	const auto node = graph.getNode(nodeIndex);
+	if (!node)
+	{
+		return;
+	}
+
+	touch(node->buildable);
+
+	for (auto connection : node->factoryConnections)
+	{
+		const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+		if (otherNode)
+		{
+			touch(otherNode->buildable);
+		}
+	}
+
+	for (auto connection : node->pipeConnections)
+	{
+		const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+		if (otherNode)
+		{
+			touch(otherNode->buildable);
+		}
+	}
+
+	needsRebuild = true;
+}
+
+void FEfficiencyCheckerComponents::touch(const AActor* actor)
+{
+	const auto element = elementByActor.Find(actor);
+	if (element)
+	{
+		bump(*element);
+	}
+}
+
+void FEfficiencyCheckerComponents::touchAll()
+{
+	allVersion = ++lastVersion;
+}
+
+int32 FEfficiencyCheckerComponents::getVersion(const FEfficiencyCheckerGraph& graph, const TSet<AFGBuildable*>& actors)
+{
+	if (needsRebuild)
+	{
+		rebuild(graph);
+	}
+
+	auto version = allVersion;
+
+	for (auto actor : actors)
+	{
+		const auto element = elementByActor.Find(actor);
+		if (!element)
+		{
+			return MAX_int32;
+		}
+
+		version = FMath::Max(version, versions[findRoot(*element)]);
+	}
+
+	return version;
+}
+
+void FEfficiencyCheckerComponents::Empty()
+{
+	elementByActor.Empty();
+	parents.Empty();
+	sizes.Empty();
+	versions.Empty();
+	needsRebuild = false;
+
+	// Versions handed out before are still compared against
+	touchAll();
+}
+
+bool FEfficiencyCheckerComponents::isCarrier(EEfficiencyCheckerClassFlags classFlags)
+{
+	return !EnumHasAnyFlags(
+		classFlags,
+		EEfficiencyCheckerClassFlags::Manufacturer |
+		EEfficiencyCheckerClassFlags::ResourceExtractor |
+		EEfficiencyCheckerClassFlags::GeneratorFuel |
+		EEfficiencyCheckerClassFlags::GeneratorNuclear |
+		EEfficiencyCheckerClassFlags::SimpleProducer
+		);
+}
+
+int32 FEfficiencyCheckerComponents::addElement(const AActor* actor)
+{
+	const auto element = parents.Add(parents.Num());
+
+	sizes.Add(1);
+	versions.Add(0);
+
+	elementByActor.Add(actor, element);
+
+	return element;
+}
+
+int32 FEfficiencyCheckerComponents::findRoot(int32 element)
+{
+	// Path halving
+	while (parents[element] != element)
+	{
+		parents[element] = parents[parents[element]];
+		element = parents[element];
+	}
+
+	return element;
+}
+
+void FEfficiencyCheckerComponents::join(int32 element, int32 otherElement)
+{
+	auto root = findRoot(element);
+	auto otherRoot = findRoot(otherElement);
+
+	if (root == otherRoot)
+	{
+		return;
+	}
+
+	// Union by size
+	if (sizes[root] < sizes[otherRoot])
+	{
+		Swap(root, otherRoot);
+	}
+
+	parents[otherRoot] = root;
+	sizes[root] += sizes[otherRoot];
+	versions[root] = FMath::Max(versions[root], versions[otherRoot]);
+}
+
+void FEfficiencyCheckerComponents::bump(int32 element)
+{
+	versions[findRoot(element)] = ++lastVersion;
+}
+
+void FEfficiencyCheckerComponents::rebuild(const FEfficiencyCheckerGraph& graph)
+{
+	needsRebuild = false;
+
+	// Version of the component each remaining node was on
+	TMap<const AActor*, int32> previousVersions;
+	previousVersions.Reserve(elementByActor.Num());
+
+	for (const auto& entry : elementByActor)
+	{
+		previousVersions.Add(entry.Key, versions[findRoot(entry.Value)]);
+	}
+
+	elementByActor.Reset();
+	parents.Reset();
+	sizes.Reset();
+	versions.Reset();
+
+	const auto& nodes = graph.getNodes();
+
+	for (auto it = nodes.CreateConstIterator(); it; ++it)
+	{
+		addElement(it->buildable);
+	}
+
+	for (auto it = nodes.CreateConstIterator(); it; ++it)
+	{
+		if (!isCarrier(it->classFlags))
+		{
+			continue;
+		}
+
+		const auto element = elementByActor[it->buildable];
+
+		for (auto connection : it->factoryConnections)
+		{
+			const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+			if (otherNode && isCarrier(otherNode->classFlags))
+			{
+				join(element, elementByActor[otherNode->buildable]);
+			}
+		}
+
+		for (auto connection : it->pipeConnections)
+		{
+			const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+			if (otherNode && isCarrier(otherNode->classFlags))
+			{
+				join(element, elementByActor[otherNode->buildable]);
+			}
+		}
+	}
+
+	for (const auto& entry : elementByActor)
+	{
+		const auto previousVersion = previousVersions.Find(entry.Key);
+
+		auto& version = versions[findRoot(entry.Value)];
+		version = FMath::Max(version, previousVersion ? *previousVersion : ++lastVersion);
+	}
+}
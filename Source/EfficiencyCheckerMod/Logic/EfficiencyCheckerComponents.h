@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+
+class AActor;
+
+/**
+ * Belt and pipe connectivity components of the indexed graph, kept in a union-find as buildables are added, with a
+ * version per component. Versions come from a single counter, so a checker can keep the counter value of its last
+ * refresh and tell whether anything it went through changed since.
+ *
+ * Producers and consumers are not joined to what they connect to, as the walks stop there. Removals can split a
+ * component, so the union-find is built again from the graph on the next read after one.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerComponents
+{
+public:
+    // Joins the node to the components of the carriers it connects to, and bumps them
+    void addNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex);
+
+    // Bumps the components of the node and of everything it connects to. Call before removing it from the graph
+    void removeNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex);
+
+    // Bumps the component of the actor, for changes like recipes and sort rules
+    void touch(const AActor* actor);
+
+    // Bumps every component, for changes that can't be placed
+    void touchAll();
+
+    // Latest version of the components of the actors. MAX_int32 when any of them is not known
+    int32 getVersion(const FEfficiencyCheckerGraph& graph, const TSet<class AFGBuildable*>& actors);
+
+    inline int32
+    getLastVersion() const
+    {
+        return lastVersion;
+    }
+
+    void Empty();
+
+protected:
+    // Anything the walks go through. Producers and consumers end them
+    static bool isCarrier(EEfficiencyCheckerClassFlags classFlags);
+
+    int32 addElement(const AActor* actor);
+    int32 findRoot(int32 element);
+    void join(int32 element, int32 otherElement);
+    void bump(int32 element);
+
+    // Same components from the current graph, each one keeping the latest version of its members
+    void rebuild(const FEfficiencyCheckerGraph& graph);
+
+    TMap<const AActor*, int32> elementByActor;
+    TArray<int32> parents;
+
+    // Size and version of the component, on its root
+    TArray<int32> sizes;
+    TArray<int32> versions;
+
+    int32 lastVersion = 0;
+
+    // Version every component is at least at, after touchAll
+    int32 allVersion = 0;
+
+    bool needsRebuild = false;
+};
@@ -0,0 +1,1153 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerFlowField.h"
+#include "EfficiencyCheckerLogic.h"
+#include "EfficiencyCheckerModModule.h"
+#include "EfficiencyCheckerTarjan.h"
+
+#include "FGBuildableConveyorBase.h"
+#include "FGBuildableFactory.h"
+#include "FGBuildableGeneratorFuel.h"
+#include "FGBuildableManufacturer.h"
+#include "FGBuildablePipeline.h"
+#include "FGBuildablePipelinePump.h"
+#include "FGBuildableResourceExtractor.h"
+#include "FGBuildableSplitterSmart.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGItemDescriptor.h"
+#include "FGPipeConnectionComponent.h"
+#include "FGRecipe.h"
+
+#include "SML/util/ReflectionHelper.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+inline bool isFluidForm(EResourceForm form)
+{
+	return form == EResourceForm::RF_LIQUID || form == EResourceForm::RF_GAS;
+}
+
+// Sum that stays unlimited once any term is
+inline float addLimits(float a, float b)
+{
+	return a == FLT_MAX || b == FLT_MAX ? FLT_MAX : a + b;
+}
+
+// Fluid goes out through anything but a consumer, into anything but a producer
+inline bool canFlow(UFGPipeConnectionComponent* from, UFGPipeConnectionComponent* to)
+{
+	return from->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER &&
+		(!to || to->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER);
+}
+
+inline bool hasChanged(float previous, float current)
+{
+	return !FMath::IsNearlyEqual(previous, current, KINDA_SMALL_NUMBER);
+}
+
+void FEfficiencyCheckerFlowField::build(AEfficiencyCheckerLogic* logic, const FEfficiencyCheckerGraph& graph)
+{
+	Empty();
+
+	needsBuild = false;
+
+	const auto& nodes = graph.getNodes();
+
+	for (auto it = nodes.CreateConstIterator(); it; ++it)
+	{
+		if (it->buildable && getVertexKind(it->classFlags) == EVertexKind::Carrier && !vertexByActor.Contains(it->buildable))
+		{
+			addRegion(graph, it.GetIndex());
+		}
+	}
+
+	for (auto it = regions.CreateConstIterator(); it; ++it)
+	{
+		enqueueRegion(it.GetIndex());
+	}
+
+	propagate(logic);
+}
+
+void FEfficiencyCheckerFlowField::update(AEfficiencyCheckerLogic* logic, const FEfficiencyCheckerGraph& graph)
+{
+	if (needsBuild)
+	{
+		build(logic, graph);
+
+		return;
+	}
+
+	TSet<int32> dirtyRegions;
+	TSet<const AActor*> seeds;
+
+	for (auto actor : changedActors)
+	{
+		// What it was connected to when it was last seen
+		const auto vertexIndex = vertexByActor.Find(actor);
+		if (vertexIndex)
+		{
+			const auto& vertex = vertices[*vertexIndex];
+
+			if (vertex.region != INDEX_NONE)
+			{
+				dirtyRegions.Add(vertex.region);
+			}
+
+			for (auto edgeIndex : vertex.inEdges)
+			{
+				dirtyRegions.Add(vertices[edges[edgeIndex].from].region);
+			}
+
+			for (auto edgeIndex : vertex.outEdges)
+			{
+				dirtyRegions.Add(vertices[edges[edgeIndex].to].region);
+			}
+		}
+
+		// What it is connected to now, if it is still there
+		const auto nodeIndex = graph.findNode(actor);
+		if (nodeIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		seeds.Add(actor);
+
+		const auto node = graph.getNode(nodeIndex);
+
+		const auto addNeighbour = [&](UFGConnectionComponent* connection)
+		{
+			const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+			if (!otherNode)
+			{
+				return;
+			}
+
+			seeds.Add(otherNode->buildable);
+
+			const auto otherVertex = vertexByActor.Find(otherNode->buildable);
+			if (otherVertex)
+			{
+				dirtyRegions.Add(vertices[*otherVertex].region);
+			}
+		};
+
+		for (auto connection : node->factoryConnections)
+		{
+			addNeighbour(connection);
+		}
+
+		for (auto connection : node->pipeConnections)
+		{
+			addNeighbour(connection);
+		}
+	}
+
+	changedActors.Empty();
+
+	dirtyRegions.Remove(INDEX_NONE);
+
+	for (auto regionIndex : dirtyRegions)
+	{
+		for (auto vertexIndex : regions[regionIndex].carriers)
+		{
+			seeds.Add(vertices[vertexIndex].buildable);
+		}
+
+		removeRegion(regionIndex);
+	}
+
+	for (auto seed : seeds)
+	{
+		const auto nodeIndex = graph.findNode(seed);
+		const auto node = graph.getNode(nodeIndex);
+
+		if (node && getVertexKind(node->classFlags) == EVertexKind::Carrier && !vertexByActor.Contains(seed))
+		{
+			enqueueRegion(addRegion(graph, nodeIndex));
+		}
+	}
+
+	for (auto actor : staleActors)
+	{
+		const auto vertexIndex = vertexByActor.Find(actor);
+		if (!vertexIndex)
+		{
+			continue;
+		}
+
+		const auto& vertex = vertices[*vertexIndex];
+
+		enqueueRegion(vertex.region);
+
+		for (auto edgeIndex : vertex.inEdges)
+		{
+			enqueueRegion(vertices[edges[edgeIndex].from].region);
+		}
+
+		for (auto edgeIndex : vertex.outEdges)
+		{
+			enqueueRegion(vertices[edges[edgeIndex].to].region);
+		}
+	}
+
+	staleActors.Empty();
+
+	propagate(logic);
+}
+
+void FEfficiencyCheckerFlowField::invalidateStructure(const AActor* buildable)
+{
+	// Nothing to keep up to date until the first build
+	if (buildable && !needsBuild)
+	{
+		changedActors.Add(buildable);
+	}
+}
+
+void FEfficiencyCheckerFlowField::invalidateRates(const AActor* buildable)
+{
+	if (buildable && !needsBuild)
+	{
+		staleActors.Add(buildable);
+	}
+}
+
+bool FEfficiencyCheckerFlowField::getValues(const AActor* buildable, FEfficiencyCheckerFlowValues& out_values, TSet<AFGBuildable*>& out_connected) const
+{
+	const auto vertexIndex = vertexByActor.Find(buildable);
+	if (!vertexIndex)
+	{
+		return false;
+	}
+
+	const auto& vertex = vertices[*vertexIndex];
+	if (vertex.kind != EVertexKind::Carrier)
+	{
+		return false;
+	}
+
+	const auto& component = components[vertex.component];
+	if (component.unresolvedSupply || component.unresolvedDemand)
+	{
+		return false;
+	}
+
+	out_values.injectedInput = component.supply;
+	out_values.requiredOutput = component.demand;
+	out_values.limitedThroughput = FMath::Min(component.inLimit, component.outLimit);
+	out_values.injectedItems = component.items;
+
+	out_connected.Append(regions[vertex.region].buildables);
+
+	return true;
+}
+
+void FEfficiencyCheckerFlowField::Empty()
+{
+	vertices.Empty();
+	edges.Empty();
+	components.Empty();
+	regions.Empty();
+	vertexByActor.Empty();
+
+	changedActors.Empty();
+	staleActors.Empty();
+
+	regionQueue.Empty();
+	queuedRegions.Empty();
+
+	needsBuild = true;
+}
+
+FEfficiencyCheckerFlowField::EVertexKind FEfficiencyCheckerFlowField::getVertexKind(EEfficiencyCheckerClassFlags classFlags)
+{
+	if (EnumHasAnyFlags(classFlags, EEfficiencyCheckerClassFlags::TrainPlatformCargo | EEfficiencyCheckerClassFlags::DockingStation) ||
+		!FEfficiencyCheckerModModule::ignoreStorageTeleporter && EnumHasAnyFlags(classFlags, EEfficiencyCheckerClassFlags::StorageTeleporter))
+	{
+		return EVertexKind::Unresolved;
+	}
+
+	if (EnumHasAnyFlags(
+		classFlags,
+		EEfficiencyCheckerClassFlags::Manufacturer |
+		EEfficiencyCheckerClassFlags::ResourceExtractor |
+		EEfficiencyCheckerClassFlags::GeneratorFuel |
+		EEfficiencyCheckerClassFlags::GeneratorNuclear |
+		EEfficiencyCheckerClassFlags::SimpleProducer
+		))
+	{
+		return EVertexKind::Terminal;
+	}
+
+	if (EnumHasAnyFlags(
+		classFlags,
+		EEfficiencyCheckerClassFlags::ConveyorBase |
+		EEfficiencyCheckerClassFlags::ConveyorAttachment |
+		EEfficiencyCheckerClassFlags::Storage |
+		EEfficiencyCheckerClassFlags::FluidIntegrant
+		))
+	{
+		return EVertexKind::Carrier;
+	}
+
+	return EVertexKind::Terminal;
+}
+
+int32 FEfficiencyCheckerFlowField::addVertex(const FEfficiencyCheckerNode& node)
+{
+	const auto existingIndex = vertexByActor.Find(node.buildable);
+	if (existingIndex)
+	{
+		return *existingIndex;
+	}
+
+	FVertex vertex;
+	vertex.buildable = node.buildable;
+	vertex.classFlags = node.classFlags;
+	vertex.kind = getVertexKind(node.classFlags);
+
+	if (vertex.kind == EVertexKind::Carrier)
+	{
+		const auto conveyor = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorBase>(node.buildable, node.classFlags, EEfficiencyCheckerClassFlags::ConveyorBase);
+		const auto pipeline = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipeline>(node.buildable, node.classFlags, EEfficiencyCheckerClassFlags::Pipeline);
+		const auto pipePump = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipelinePump>(node.buildable, node.classFlags, EEfficiencyCheckerClassFlags::PipelinePump);
+
+		if (conveyor)
+		{
+			vertex.capacity = conveyor->GetSpeed() / 2;
+		}
+		else if (pipeline)
+		{
+			vertex.capacity = AEfficiencyCheckerLogic::getPipeSpeed(pipeline);
+		}
+		else if (pipePump)
+		{
+			vertex.capacity = AEfficiencyCheckerLogic::getPumpFlowLimit(pipePump);
+		}
+	}
+
+	const auto vertexIndex = vertices.Add(vertex);
+
+	vertexByActor.Add(node.buildable, vertexIndex);
+
+	return vertexIndex;
+}
+
+void FEfficiencyCheckerFlowField::addEdge(int32 from, int32 to, UFGConnectionComponent* fromConnection, bool fluid)
+{
+	if (from == to)
+	{
+		return;
+	}
+
+	FEdge edge;
+	edge.from = from;
+	edge.to = to;
+	edge.fromConnection = fromConnection;
+	edge.fluid = fluid;
+
+	const auto edgeIndex = edges.Add(edge);
+
+	vertices[from].outEdges.Add(edgeIndex);
+	vertices[to].inEdges.Add(edgeIndex);
+}
+
+void FEfficiencyCheckerFlowField::removeEdge(int32 edgeIndex)
+{
+	const auto& edge = edges[edgeIndex];
+
+	vertices[edge.from].outEdges.RemoveSingleSwap(edgeIndex, false);
+	vertices[edge.to].inEdges.RemoveSingleSwap(edgeIndex, false);
+
+	edges.RemoveAt(edgeIndex);
+}
+
+int32 FEfficiencyCheckerFlowField::addRegion(const FEfficiencyCheckerGraph& graph, int32 seedNode)
+{
+	const auto regionIndex = regions.Add(FRegion());
+
+	TArray<int32> pending;
+
+	// Vertex of the node on the other side, taking carriers into the region. INDEX_NONE when it is not indexed
+	const auto linkNode = [&](int32 nodeIndex) -> int32
+	{
+		const auto node = graph.getNode(nodeIndex);
+		if (!node || !node->buildable)
+		{
+			return INDEX_NONE;
+		}
+
+		const auto existingIndex = vertexByActor.Find(node->buildable);
+		if (existingIndex && vertices[*existingIndex].kind == EVertexKind::Carrier)
+		{
+			const auto otherRegion = vertices[*existingIndex].region;
+
+			if (otherRegion == regionIndex)
+			{
+				return *existingIndex;
+			}
+
+			// Built separately, but they are connected now
+			removeRegion(otherRegion);
+		}
+
+		const auto vertexIndex = addVertex(*node);
+
+		if (vertices[vertexIndex].kind == EVertexKind::Carrier)
+		{
+			vertices[vertexIndex].region = regionIndex;
+			regions[regionIndex].carriers.Add(vertexIndex);
+
+			pending.Push(nodeIndex);
+		}
+		else
+		{
+			regions[regionIndex].terminals.AddUnique(vertexIndex);
+		}
+
+		return vertexIndex;
+	};
+
+	linkNode(seedNode);
+
+	while (pending.Num())
+	{
+		const auto& node = *graph.getNode(pending.Pop(false));
+		const auto vertexIndex = vertexByActor[node.buildable];
+
+		for (auto connection : node.factoryConnections)
+		{
+			if (!connection || !connection->IsConnected() || connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+			{
+				continue;
+			}
+
+			const auto otherIndex = linkNode(graph.findConnectedNode(connection));
+
+			if (otherIndex == INDEX_NONE)
+			{
+				vertices[vertexIndex].unknownInput |= connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT;
+				vertices[vertexIndex].unknownOutput |= connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT;
+
+				continue;
+			}
+
+			// Between carriers, the edge is added from the output side
+			if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
+			{
+				addEdge(vertexIndex, otherIndex, connection, false);
+			}
+			else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT && vertices[otherIndex].kind != EVertexKind::Carrier)
+			{
+				addEdge(otherIndex, vertexIndex, connection->GetConnection(), false);
+			}
+		}
+
+		for (auto connection : node.pipeConnections)
+		{
+			if (!connection || !connection->IsConnected())
+			{
+				continue;
+			}
+
+			const auto otherIndex = linkNode(graph.findConnectedNode(connection));
+
+			if (otherIndex == INDEX_NONE)
+			{
+				vertices[vertexIndex].unknownInput |= connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER;
+				vertices[vertexIndex].unknownOutput |= connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER;
+
+				continue;
+			}
+
+			// Between carriers, each side adds the edge going out of it. Plain pipes get an edge each way
+			const auto otherConnection = connection->GetPipeConnection();
+
+			if (canFlow(connection, otherConnection))
+			{
+				addEdge(vertexIndex, otherIndex, connection, true);
+			}
+
+			if (otherConnection && vertices[otherIndex].kind != EVertexKind::Carrier && canFlow(otherConnection, connection))
+			{
+				addEdge(otherIndex, vertexIndex, otherConnection, true);
+			}
+		}
+	}
+
+	findComponents(regionIndex);
+
+	auto& region = regions[regionIndex];
+
+	for (auto vertexIndex : region.carriers)
+	{
+		region.buildables.Add(vertices[vertexIndex].buildable);
+	}
+
+	for (auto vertexIndex : region.terminals)
+	{
+		region.buildables.Add(vertices[vertexIndex].buildable);
+	}
+
+	return regionIndex;
+}
+
+void FEfficiencyCheckerFlowField::removeRegion(int32 regionIndex)
+{
+	const auto region = MoveTemp(regions[regionIndex]);
+
+	regions.RemoveAt(regionIndex);
+
+	queuedRegions.Remove(regionIndex);
+
+	for (auto vertexIndex : region.carriers)
+	{
+		// Removing an edge changes the lists
+		const auto inEdges = vertices[vertexIndex].inEdges;
+		const auto outEdges = vertices[vertexIndex].outEdges;
+
+		for (auto edgeIndex : inEdges)
+		{
+			removeEdge(edgeIndex);
+		}
+
+		for (auto edgeIndex : outEdges)
+		{
+			removeEdge(edgeIndex);
+		}
+	}
+
+	for (auto vertexIndex : region.carriers)
+	{
+		vertexByActor.Remove(vertices[vertexIndex].buildable);
+		vertices.RemoveAt(vertexIndex);
+	}
+
+	for (auto componentIndex : region.components)
+	{
+		components.RemoveAt(componentIndex);
+	}
+
+	for (auto vertexIndex : region.terminals)
+	{
+		const auto& vertex = vertices[vertexIndex];
+
+		if (vertex.inEdges.Num() || vertex.outEdges.Num())
+		{
+			// Still between other regions, whose shares of it have changed
+			staleActors.Add(vertex.buildable);
+		}
+		else
+		{
+			vertexByActor.Remove(vertex.buildable);
+			vertices.RemoveAt(vertexIndex);
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::findComponents(int32 regionIndex)
+{
+	auto& region = regions[regionIndex];
+
+	findStronglyConnectedComponents(
+		region.carriers,
+		[this](int32 vertexIndex, TArray<int32>& out_successors)
+		{
+			for (auto edgeIndex : vertices[vertexIndex].outEdges)
+			{
+				const auto target = edges[edgeIndex].to;
+
+				if (vertices[target].kind == EVertexKind::Carrier)
+				{
+					out_successors.Add(target);
+				}
+			}
+		},
+		[this, &region](const TArray<int32>& members)
+		{
+			const auto componentIndex = components.Add(FComponent());
+			auto& component = components[componentIndex];
+
+			for (auto member : members)
+			{
+				component.vertices.Add(member);
+				component.capacity = FMath::Min(component.capacity, vertices[member].capacity);
+
+				vertices[member].component = componentIndex;
+			}
+
+			region.components.Add(componentIndex);
+		}
+		);
+
+	for (auto vertexIndex : region.carriers)
+	{
+		const auto& vertex = vertices[vertexIndex];
+
+		for (auto edgeIndex : vertex.outEdges)
+		{
+			const auto& target = vertices[edges[edgeIndex].to];
+
+			if (target.kind != EVertexKind::Carrier)
+			{
+				components[vertex.component].leaving.Add(edgeIndex);
+			}
+			else if (target.component != vertex.component)
+			{
+				components[vertex.component].leaving.Add(edgeIndex);
+				components[target.component].entering.Add(edgeIndex);
+			}
+		}
+
+		for (auto edgeIndex : vertex.inEdges)
+		{
+			if (vertices[edges[edgeIndex].from].kind != EVertexKind::Carrier)
+			{
+				components[vertex.component].entering.Add(edgeIndex);
+			}
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::enqueueRegion(int32 regionIndex)
+{
+	if (regions.IsValidIndex(regionIndex) && !queuedRegions.Contains(regionIndex))
+	{
+		queuedRegions.Add(regionIndex);
+		regionQueue.Add(regionIndex);
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagate(AEfficiencyCheckerLogic* logic)
+{
+	TMap<int32, int32> passes;
+
+	// The queue grows while it is walked, as changes reach other regions
+	for (int32 next = 0; next < regionQueue.Num(); ++next)
+	{
+		const auto regionIndex = regionQueue[next];
+
+		if (!queuedRegions.Remove(regionIndex))
+		{
+			continue;
+		}
+
+		auto& regionPasses = passes.FindOrAdd(regionIndex);
+		if (regionPasses++ >= maxRegionPasses)
+		{
+			continue;
+		}
+
+		propagateRegion(logic, regionIndex);
+	}
+
+	regionQueue.Empty();
+	queuedRegions.Empty();
+}
+
+void FEfficiencyCheckerFlowField::propagateRegion(AEfficiencyCheckerLogic* logic, int32 regionIndex)
+{
+	const auto& region = regions[regionIndex];
+
+	for (auto vertexIndex : region.terminals)
+	{
+		refreshProduction(logic, vertexIndex, regionIndex);
+	}
+
+	for (auto componentIndex : region.components)
+	{
+		auto& component = components[componentIndex];
+
+		component.items.Empty();
+		component.supply = 0;
+		component.grossDemand = 0;
+		component.demand = 0;
+		component.inLimit = FLT_MAX;
+		component.outLimit = FLT_MAX;
+		component.unresolvedSupply = false;
+		component.unresolvedDemand = false;
+	}
+
+	propagateItems(logic, region);
+
+	// The items reaching the terminals are known now
+	for (auto vertexIndex : region.terminals)
+	{
+		refreshConsumption(logic, vertexIndex, regionIndex);
+	}
+
+	propagateGrossDemand(region);
+	propagateSupply(region);
+	propagateDemand(region);
+	propagateLimits(region);
+}
+
+void FEfficiencyCheckerFlowField::refreshProduction(AEfficiencyCheckerLogic* logic, int32 vertexIndex, int32 regionIndex)
+{
+	if (vertices[vertexIndex].kind != EVertexKind::Terminal)
+	{
+		return;
+	}
+
+	for (auto edgeIndex : vertices[vertexIndex].outEdges)
+	{
+		auto& edge = edges[edgeIndex];
+
+		FEfficiencyCheckerItemSet items;
+		const auto supply = getProduction(logic, edge, items);
+
+		if (!hasChanged(edge.supply, supply) && edge.items == items)
+		{
+			continue;
+		}
+
+		edge.supply = supply;
+		edge.items = items;
+
+		if (vertices[edge.to].region != regionIndex)
+		{
+			enqueueRegion(vertices[edge.to].region);
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::refreshConsumption(AEfficiencyCheckerLogic* logic, int32 vertexIndex, int32 regionIndex)
+{
+	const auto& vertex = vertices[vertexIndex];
+
+	if (vertex.kind != EVertexKind::Terminal || !vertex.inEdges.Num())
+	{
+		return;
+	}
+
+	TMap<int32, float> consumption;
+
+	// Rate of the item taken by the terminal, shared evenly among the inputs that bring it
+	const auto consume = [this, &vertex, &consumption](int32 itemIndex, float itemAmountPerMinute)
+	{
+		TArray<int32, TInlineAllocator<4>> carrying;
+
+		for (auto edgeIndex : vertex.inEdges)
+		{
+			if (edges[edgeIndex].items.Contains(itemIndex))
+			{
+				carrying.Add(edgeIndex);
+			}
+		}
+
+		for (auto edgeIndex : carrying)
+		{
+			consumption.FindOrAdd(edgeIndex) += itemAmountPerMinute / carrying.Num();
+		}
+	};
+
+	FEfficiencyCheckerItemSet incomingItems;
+
+	for (auto edgeIndex : vertex.inEdges)
+	{
+		incomingItems.Append(edges[edgeIndex].items);
+	}
+
+	const auto manufacturer = AEfficiencyCheckerLogic::castOwner<AFGBuildableManufacturer>(vertex.buildable, vertex.classFlags, EEfficiencyCheckerClassFlags::Manufacturer);
+	const auto generator = AEfficiencyCheckerLogic::castOwner<AFGBuildableGeneratorFuel>(vertex.buildable, vertex.classFlags, EEfficiencyCheckerClassFlags::GeneratorFuel);
+
+	if (manufacturer)
+	{
+		const auto recipe = logic->getRecipe(manufacturer->GetCurrentRecipe());
+
+		if (recipe)
+		{
+			for (const auto& item : recipe->ingredients)
+			{
+				const auto itemIndex = item.itemIndex;
+
+				if (!incomingItems.Contains(itemIndex))
+				{
+					continue;
+				}
+
+				float itemAmountPerMinute = item.amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
+
+				if (item.isFluid())
+				{
+					itemAmountPerMinute /= 1000;
+				}
+
+				consume(itemIndex, itemAmountPerMinute);
+			}
+		}
+	}
+	else if (generator)
+	{
+		const auto supplementalItemIndex = logic->getItemIndex(generator->GetSupplementalResourceClass());
+
+		if (incomingItems.Contains(supplementalItemIndex))
+		{
+			consume(
+				supplementalItemIndex,
+				generator->GetSupplementalConsumptionRateMaximum() * (isFluidForm(UFGItemDescriptor::GetForm(generator->GetSupplementalResourceClass())) ? 60 : 1)
+				);
+
+			incomingItems.Remove(supplementalItemIndex);
+		}
+
+		for (auto itemIndex : incomingItems)
+		{
+			const auto item = logic->getItemDescriptor(itemIndex);
+
+			if (!generator->IsValidFuel(item))
+			{
+				continue;
+			}
+
+			const float energy = logic->getItemEnergyValue(itemIndex);
+			if (energy <= 0)
+			{
+				continue;
+			}
+
+			float itemAmountPerMinute = 60 / (energy / generator->GetPowerProductionCapacity());
+
+			if (isFluidForm(UFGItemDescriptor::GetForm(item)))
+			{
+				itemAmountPerMinute /= 1000;
+			}
+
+			consume(itemIndex, itemAmountPerMinute);
+
+			break;
+		}
+	}
+
+	for (auto edgeIndex : vertex.inEdges)
+	{
+		auto& edge = edges[edgeIndex];
+
+		const auto grossDemand = consumption.FindRef(edgeIndex);
+
+		if (!hasChanged(edge.grossDemand, grossDemand))
+		{
+			continue;
+		}
+
+		edge.grossDemand = grossDemand;
+
+		if (vertices[edge.from].region != regionIndex)
+		{
+			enqueueRegion(vertices[edge.from].region);
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagateItems(AEfficiencyCheckerLogic* logic, const FRegion& region)
+{
+	// Components were found sinks first. Backwards, every component comes after all that feed it
+	for (auto index = region.components.Num() - 1; index >= 0; --index)
+	{
+		auto& component = components[region.components[index]];
+
+		for (auto edgeIndex : component.entering)
+		{
+			component.items.Append(edges[edgeIndex].items);
+		}
+
+		for (auto edgeIndex : component.leaving)
+		{
+			auto& edge = edges[edgeIndex];
+			edge.items = filterItems(logic, edge, component.items);
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagateGrossDemand(const FRegion& region)
+{
+	// Everything that is taken past the component, without discounting what other inputs bring
+	for (auto componentIndex : region.components)
+	{
+		auto& component = components[componentIndex];
+
+		for (auto edgeIndex : component.leaving)
+		{
+			const auto& edge = edges[edgeIndex];
+			const auto& target = vertices[edge.to];
+
+			component.grossDemand += edge.grossDemand;
+
+			component.unresolvedDemand |= target.kind == EVertexKind::Unresolved ||
+				target.kind == EVertexKind::Carrier && components[target.component].unresolvedDemand;
+		}
+
+		for (auto vertexIndex : component.vertices)
+		{
+			component.unresolvedDemand |= vertices[vertexIndex].unknownOutput;
+		}
+
+		for (auto edgeIndex : component.entering)
+		{
+			if (vertices[edges[edgeIndex].from].kind == EVertexKind::Carrier)
+			{
+				edges[edgeIndex].grossDemand = component.grossDemand;
+			}
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagateSupply(const FRegion& region)
+{
+	for (auto index = region.components.Num() - 1; index >= 0; --index)
+	{
+		auto& component = components[region.components[index]];
+
+		for (auto edgeIndex : component.entering)
+		{
+			const auto& edge = edges[edgeIndex];
+			const auto& source = vertices[edge.from];
+
+			component.supply += edge.supply;
+
+			component.unresolvedSupply |= source.kind == EVertexKind::Unresolved ||
+				source.kind == EVertexKind::Carrier && components[source.component].unresolvedSupply;
+		}
+
+		for (auto vertexIndex : component.vertices)
+		{
+			component.unresolvedSupply |= vertices[vertexIndex].unknownInput;
+		}
+
+		// Branches get what they require, or an even share when none requires anything
+		float leavingDemand = 0;
+
+		for (auto edgeIndex : component.leaving)
+		{
+			leavingDemand += edges[edgeIndex].grossDemand;
+		}
+
+		for (auto edgeIndex : component.leaving)
+		{
+			auto& edge = edges[edgeIndex];
+
+			edge.supply = leavingDemand > 0
+				              ? component.supply * edge.grossDemand / leavingDemand
+				              : component.supply / component.leaving.Num();
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagateDemand(const FRegion& region)
+{
+	for (auto componentIndex : region.components)
+	{
+		auto& component = components[componentIndex];
+
+		for (auto edgeIndex : component.leaving)
+		{
+			auto& edge = edges[edgeIndex];
+
+			if (vertices[edge.to].kind != EVertexKind::Carrier)
+			{
+				edge.demand = edge.grossDemand;
+			}
+
+			component.demand += edge.demand;
+		}
+
+		// Merged inputs are asked for what they supply, or an even share when none supplies anything
+		for (auto edgeIndex : component.entering)
+		{
+			auto& edge = edges[edgeIndex];
+
+			edge.demand = component.supply > 0
+				              ? component.demand * edge.supply / component.supply
+				              : component.demand / component.entering.Num();
+		}
+	}
+}
+
+void FEfficiencyCheckerFlowField::propagateLimits(const FRegion& region)
+{
+	for (auto index = region.components.Num() - 1; index >= 0; --index)
+	{
+		auto& component = components[region.components[index]];
+
+		if (component.entering.Num())
+		{
+			float enteringLimit = 0;
+
+			for (auto edgeIndex : component.entering)
+			{
+				const auto& source = vertices[edges[edgeIndex].from];
+
+				enteringLimit = addLimits(enteringLimit, source.kind == EVertexKind::Carrier ? components[source.component].inLimit : FLT_MAX);
+			}
+
+			component.inLimit = FMath::Min(component.capacity, enteringLimit);
+		}
+		else
+		{
+			component.inLimit = component.capacity;
+		}
+	}
+
+	for (auto componentIndex : region.components)
+	{
+		auto& component = components[componentIndex];
+
+		if (component.leaving.Num())
+		{
+			float leavingLimit = 0;
+
+			for (auto edgeIndex : component.leaving)
+			{
+				const auto& target = vertices[edges[edgeIndex].to];
+
+				leavingLimit = addLimits(leavingLimit, target.kind == EVertexKind::Carrier ? components[target.component].outLimit : FLT_MAX);
+			}
+
+			component.outLimit = FMath::Min(component.capacity, leavingLimit);
+		}
+		else
+		{
+			component.outLimit = component.capacity;
+		}
+	}
+}
+
+FEfficiencyCheckerItemSet FEfficiencyCheckerFlowField::filterItems(AEfficiencyCheckerLogic* logic, const FEdge& edge, const FEfficiencyCheckerItemSet& items) const
+{
+	const auto& vertex = vertices[edge.from];
+
+	const auto smartSplitter = edge.fluid
+		                           ? nullptr
+		                           : AEfficiencyCheckerLogic::castOwner<AFGBuildableSplitterSmart>(vertex.buildable, vertex.classFlags, EEfficiencyCheckerClassFlags::SplitterSmart);
+	if (!smartSplitter || !edge.fromConnection)
+	{
+		return items;
+	}
+
+	const auto sortRules = logic->getSortRules(smartSplitter);
+
+	TArray<FEfficiencyCheckerItemSet> restrictedItemsByOutput;
+	sortRules->resolve(items, logic->anyUndefinedItemMask, restrictedItemsByOutput);
+
+	return FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, sortRules->getOutputIndex(edge.fromConnection)).Intersect(items);
+}
+
+float FEfficiencyCheckerFlowField::getProduction(AEfficiencyCheckerLogic* logic, const FEdge& edge, FEfficiencyCheckerItemSet& out_items) const
+{
+	const auto& vertex = vertices[edge.from];
+
+	// The production is shared among the outputs of the same form
+	int32 outputs = 0;
+
+	for (auto edgeIndex : vertex.outEdges)
+	{
+		outputs += edges[edgeIndex].fluid == edge.fluid ? 1 : 0;
+	}
+
+	const auto manufacturer = AEfficiencyCheckerLogic::castOwner<AFGBuildableManufacturer>(vertex.buildable, vertex.classFlags, EEfficiencyCheckerClassFlags::Manufacturer);
+	if (manufacturer)
+	{
+		const auto recipe = logic->getRecipe(manufacturer->GetCurrentRecipe());
+
+		if (recipe)
+		{
+			for (const auto& item : recipe->products)
+			{
+				const auto fluidItem = item.isFluid();
+
+				if (fluidItem != edge.fluid || !fluidItem && !logic->isSolidConveyorItem(item.item))
+				{
+					continue;
+				}
+
+				out_items.Add(item.itemIndex);
+
+				float itemAmountPerMinute = item.amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
+
+				if (fluidItem)
+				{
+					itemAmountPerMinute /= 1000;
+				}
+
+				return itemAmountPerMinute / outputs;
+			}
+		}
+
+		return 0;
+	}
+
+	const auto extractor = AEfficiencyCheckerLogic::castOwner<AFGBuildableResourceExtractor>(vertex.buildable, vertex.classFlags, EEfficiencyCheckerClassFlags::ResourceExtractor);
+	if (extractor)
+	{
+		TSubclassOf<UFGItemDescriptor> item;
+
+		const auto resource = extractor->GetExtractableResource();
+		if (resource)
+		{
+			item = IFGExtractableResourceInterface::Execute_GetResourceClass(resource.GetObject());
+		}
+
+		if (!item)
+		{
+			item = extractor->GetOutputInventory()->GetAllowedItemOnIndex(0);
+		}
+
+		if (!item || isFluidForm(UFGItemDescriptor::GetForm(item)) != edge.fluid)
+		{
+			return 0;
+		}
+
+		out_items.Add(logic->getItemIndex(item));
+
+		float itemAmountPerMinute = extractor->GetNumExtractedItemsPerCycle() * (60.0 / extractor->CalcProductionCycleTimeForPotential(extractor->GetPendingPotential()));
+
+		if (edge.fluid)
+		{
+			itemAmountPerMinute /= 1000;
+		}
+
+		if (EnumHasAnyFlags(vertex.classFlags, EEfficiencyCheckerClassFlags::MinerMk4))
+		{
+			itemAmountPerMinute = 2000;
+		}
+
+		return itemAmountPerMinute / outputs;
+	}
+
+	if (EnumHasAnyFlags(vertex.classFlags, EEfficiencyCheckerClassFlags::GeneratorNuclear))
+	{
+		if (edge.fluid)
+		{
+			return 0;
+		}
+
+		out_items.Append(logic->nuclearWasteItemMask);
+
+		return 0.2 / outputs;
+	}
+
+	if (EnumHasAnyFlags(vertex.classFlags, EEfficiencyCheckerClassFlags::SimpleProducer))
+	{
+		TSubclassOf<UFGItemDescriptor> itemType = FReflectionHelper::GetObjectPropertyValue<UClass>(vertex.buildable, TEXT("mItemType"));
+		auto timeToProduceItem = FReflectionHelper::GetPropertyValue<UFloatProperty>(vertex.buildable, TEXT("mTimeToProduceItem"));
+
+		if (edge.fluid || !timeToProduceItem || !itemType)
+		{
+			return 0;
+		}
+
+		out_items.Add(logic->getItemIndex(itemType));
+
+		return 60 / timeToProduceItem / outputs;
+	}
+
+	return 0;
+}
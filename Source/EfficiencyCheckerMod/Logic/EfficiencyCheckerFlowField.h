@@ -0,0 +1,212 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+
+class AActor;
+class AEfficiencyCheckerLogic;
+class AFGBuildable;
+class UFGConnectionComponent;
+
+// Rates of a belt or pipe, as a checker placed on it shows them
+struct FEfficiencyCheckerFlowValues
+{
+    float injectedInput = 0;
+    float limitedThroughput = 0;
+    float requiredOutput = 0;
+
+    FEfficiencyCheckerItemSet injectedItems;
+};
+
+/**
+ * Factory-wide dataflow over the indexed graph, so that the checkers read the rates of their belt or pipe instead of
+ * walking the graph each.
+ *
+ * Belts, pipes, attachments and storages carry flow. Machines, extractors and generators are terminals, that feed a
+ * constant production to their output edges and take their consumption from their input edges. The carrying part is
+ * condensed into strongly connected components (loops, and whole pipe networks, as pipes flow both ways) and walked in
+ * topological order: items and supply forward, demand backward. A branch gets a share of the flow proportional to what
+ * is required past it, and a merge gets a share of the demand proportional to what it supplies.
+ *
+ * Carriers connected to each other form a region, and regions only affect each other through the terminals between
+ * them. Edits are recorded with invalidateStructure/invalidateRates and applied by update: the regions around a built
+ * or dismantled buildable are rebuilt, and the regions around a changed one are propagated again. A region whose
+ * terminal shares change pushes the change to the regions on the other side, until nothing changes anymore.
+ *
+ * Train cargo platforms, drone stations and storage teleporters link distant places, and buildables that are not
+ * indexed are unknown. Values that depend on any of them are reported as unresolved, and the checker walks the graph.
+ */
+class FEfficiencyCheckerFlowField
+{
+public:
+    // Recomputes everything from the graph. The caller holds AEfficiencyCheckerLogic::eclCritical
+    void build(AEfficiencyCheckerLogic* logic, const FEfficiencyCheckerGraph& graph);
+
+    // Applies the recorded edits, or builds everything if it was never built. The caller holds AEfficiencyCheckerLogic::eclCritical
+    void update(AEfficiencyCheckerLogic* logic, const FEfficiencyCheckerGraph& graph);
+
+    inline bool
+    isDirty() const
+    {
+        return needsBuild || changedActors.Num() || staleActors.Num();
+    }
+
+    // The buildable was built or dismantled. Its connections are read again on the next update
+    void invalidateStructure(const AActor* buildable);
+
+    // The rates of the buildable changed (potential, recipe or sort rules). Its regions are propagated again on the next update
+    void invalidateRates(const AActor* buildable);
+
+    // Values on a belt, pipe or attachment, and the buildables they come from. False when they are unresolved
+    bool getValues(const AActor* buildable, FEfficiencyCheckerFlowValues& out_values, TSet<AFGBuildable*>& out_connected) const;
+
+    void Empty();
+
+    inline int32
+    Num() const
+    {
+        return vertices.Num();
+    }
+
+protected:
+    enum class EVertexKind : uint8
+    {
+        Carrier,
+        Terminal,
+        Unresolved
+    };
+
+    struct FVertex
+    {
+        AFGBuildable* buildable = nullptr;
+        EEfficiencyCheckerClassFlags classFlags = EEfficiencyCheckerClassFlags::None;
+        EVertexKind kind = EVertexKind::Terminal;
+
+        // Belt or pipe speed. Unlimited for the rest
+        float capacity = FLT_MAX;
+
+        // Connected to something that is not indexed, on the input or on the output side
+        bool unknownInput = false;
+        bool unknownOutput = false;
+
+        TArray<int32> inEdges;
+        TArray<int32> outEdges;
+
+        // Only for carriers. Terminals sit between regions
+        int32 component = INDEX_NONE;
+        int32 region = INDEX_NONE;
+    };
+
+    struct FEdge
+    {
+        int32 from = INDEX_NONE;
+        int32 to = INDEX_NONE;
+
+        // Connection on the source side, to pick the smart splitter rules
+        UFGConnectionComponent* fromConnection = nullptr;
+
+        bool fluid = false;
+
+        FEfficiencyCheckerItemSet items;
+
+        float supply = 0;
+        float grossDemand = 0;
+        float demand = 0;
+    };
+
+    // Strongly connected component of carriers
+    struct FComponent
+    {
+        TArray<int32> vertices;
+
+        TArray<int32> entering;
+        TArray<int32> leaving;
+
+        float capacity = FLT_MAX;
+
+        FEfficiencyCheckerItemSet items;
+
+        float supply = 0;
+        float grossDemand = 0;
+        float demand = 0;
+
+        float inLimit = FLT_MAX;
+        float outLimit = FLT_MAX;
+
+        bool unresolvedSupply = false;
+        bool unresolvedDemand = false;
+    };
+
+    struct FRegion
+    {
+        TArray<int32> carriers;
+
+        // Sinks first, so in reverse topological order
+        TArray<int32> components;
+
+        // Terminals and unresolved buildables around the carriers
+        TArray<int32> terminals;
+
+        // Carriers and terminals. What a checker on any of them depends on
+        TArray<AFGBuildable*> buildables;
+    };
+
+    static EVertexKind getVertexKind(EEfficiencyCheckerClassFlags classFlags);
+
+    int32 addVertex(const FEfficiencyCheckerNode& node);
+    void addEdge(int32 from, int32 to, UFGConnectionComponent* fromConnection, bool fluid);
+    void removeEdge(int32 edgeIndex);
+
+    // Collects the carriers connected to the seed, the terminals around them, and condenses them. Returns the region index
+    int32 addRegion(const FEfficiencyCheckerGraph& graph, int32 seedNode);
+
+    // Drops the carriers of the region and their edges. Terminals left without edges are dropped too, and the rest are marked stale
+    void removeRegion(int32 regionIndex);
+
+    // Tarjan's algorithm with an explicit stack. Components come out sinks first, so in reverse topological order
+    void findComponents(int32 regionIndex);
+
+    void enqueueRegion(int32 regionIndex);
+
+    // Propagates the queued regions, and the ones their changes reach
+    void propagate(AEfficiencyCheckerLogic* logic);
+    void propagateRegion(AEfficiencyCheckerLogic* logic, int32 regionIndex);
+
+    // Production of a terminal on its output edges, and its consumption from its input edges. Regions on the other side are queued when their edges change
+    void refreshProduction(AEfficiencyCheckerLogic* logic, int32 vertexIndex, int32 regionIndex);
+    void refreshConsumption(AEfficiencyCheckerLogic* logic, int32 vertexIndex, int32 regionIndex);
+
+    void propagateItems(AEfficiencyCheckerLogic* logic, const FRegion& region);
+    void propagateGrossDemand(const FRegion& region);
+    void propagateSupply(const FRegion& region);
+    void propagateDemand(const FRegion& region);
+    void propagateLimits(const FRegion& region);
+
+    // Items leaving a carrier by the edge, after the smart splitter rules
+    FEfficiencyCheckerItemSet filterItems(AEfficiencyCheckerLogic* logic, const FEdge& edge, const FEfficiencyCheckerItemSet& items) const;
+
+    // Production of a terminal on the edge, shared among its outputs of the same form
+    float getProduction(AEfficiencyCheckerLogic* logic, const FEdge& edge, FEfficiencyCheckerItemSet& out_items) const;
+
+
+    TSparseArray<FVertex> vertices;
+    TSparseArray<FEdge> edges;
+    TSparseArray<FComponent> components;
+    TSparseArray<FRegion> regions;
+
+    TMap<const AActor*, int32> vertexByActor;
+
+    bool needsBuild = true;
+
+    // Edits recorded since the last update. Actors are only used as keys, as dismantled ones may be gone already
+    TSet<const AActor*> changedActors;
+    TSet<const AActor*> staleActors;
+
+    TArray<int32> regionQueue;
+    TSet<int32> queuedRegions;
+
+    // Bounds the passes over a region on each update, for feedback loops through machines
+    static constexpr int32 maxRegionPasses = 8;
+};
@@ -0,0 +1,142 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerGraph.h"
+
+#include "FGBuildable.h"
+#include "FGBuildableFactory.h"
+#include "FGConnectionComponent.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGFluidIntegrantInterface.h"
+#include "FGPipeConnectionComponent.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+int32 FEfficiencyCheckerGraph::addNode(AFGBuildable* buildable, EEfficiencyCheckerClassFlags classFlags)
+{
+	if (!buildable)
+	{
+		return INDEX_NONE;
+	}
+
+	const auto existingIndex = nodeByActor.Find(buildable);
+	if (existingIndex)
+	{
+		return *existingIndex;
+	}
+
+	if (!buildable->HasActorBegunPlay())
+	{
+		// Connection components are only known after BeginPlay. It will be indexed when first reached
+		return INDEX_NONE;
+	}
+
+	FEfficiencyCheckerNode node;
+	node.buildable = buildable;
+	node.classFlags = classFlags;
+
+	const auto factory = Cast<AFGBuildableFactory>(buildable);
+	if (factory)
+	{
+		node.factoryConnections = factory->GetConnectionComponents();
+	}
+	else
+	{
+		buildable->GetComponents(node.factoryConnections);
+	}
+
+	const auto fluidIntegrant = Cast<IFGFluidIntegrantInterface>(buildable);
+	if (fluidIntegrant)
+	{
+		node.pipeConnections = fluidIntegrant->GetPipeConnections();
+	}
+	else
+	{
+		buildable->GetComponents(node.pipeConnections);
+	}
+
+	const auto nodeIndex = nodes.Add(MoveTemp(node));
+
+	nodeByActor.Add(buildable, nodeIndex);
+
+	for (auto connection : nodes[nodeIndex].factoryConnections)
+	{
+		nodeByConnection.Add(connection, nodeIndex);
+	}
+
+	for (auto connection : nodes[nodeIndex].pipeConnections)
+	{
+		nodeByConnection.Add(connection, nodeIndex);
+	}
+
+	return nodeIndex;
+}
+
+void FEfficiencyCheckerGraph::removeNode(const AActor* actor)
+{
+	int32 nodeIndex = INDEX_NONE;
+	if (!nodeByActor.RemoveAndCopyValue(actor, nodeIndex))
+	{
+		return;
+	}
+
+	for (auto connection : nodes[nodeIndex].factoryConnections)
+	{
+		nodeByConnection.Remove(connection);
+	}
+
+	for (auto connection : nodes[nodeIndex].pipeConnections)
+	{
+		nodeByConnection.Remove(connection);
+	}
+
+	nodes.RemoveAt(nodeIndex);
+}
+
+int32 FEfficiencyCheckerGraph::findNode(const AActor* actor) const
+{
+	const auto nodeIndex = nodeByActor.Find(actor);
+
+	return nodeIndex ? *nodeIndex : INDEX_NONE;
+}
+
+int32 FEfficiencyCheckerGraph::findConnectionNode(const UFGConnectionComponent* connection) const
+{
+	const auto nodeIndex = nodeByConnection.Find(connection);
+
+	return nodeIndex ? *nodeIndex : INDEX_NONE;
+}
+
+int32 FEfficiencyCheckerGraph::findConnectedNode(const UFGConnectionComponent* connection) const
+{
+	if (!connection)
+	{
+		return INDEX_NONE;
+	}
+
+	const auto factoryConnection = Cast<UFGFactoryConnectionComponent>(connection);
+	if (factoryConnection)
+	{
+		return factoryConnection->IsConnected() ? findConnectionNode(factoryConnection->GetConnection()) : INDEX_NONE;
+	}
+
+	const auto pipeConnection = Cast<UFGPipeConnectionComponent>(connection);
+	if (pipeConnection)
+	{
+		return pipeConnection->IsConnected() ? findConnectionNode(pipeConnection->GetConnection()) : INDEX_NONE;
+	}
+
+	return INDEX_NONE;
+}
+
+void FEfficiencyCheckerGraph::Empty()
+{
+	nodes.Empty();
+	nodeByActor.Empty();
+	nodeByConnection.Empty();
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+
+class AActor;
+class AFGBuildable;
+class UFGConnectionComponent;
+class UFGFactoryConnectionComponent;
+class UFGPipeConnectionComponent;
+
+// What the traversals need to know about a buildable class. Resolved once per UClass
+enum class EEfficiencyCheckerClassFlags : uint32
+{
+    None = 0,
+    Manufacturer = 1 << 0,
+    ResourceExtractor = 1 << 1,
+    MinerMk4 = 1 << 2,
+    ConveyorBase = 1 << 3,
+    ConveyorAttachment = 1 << 4,
+    SplitterSmart = 1 << 5,
+    Storage = 1 << 6,
+    TrainPlatformCargo = 1 << 7,
+    DockingStation = 1 << 8,
+    StorageTeleporter = 1 << 9,
+    FluidIntegrant = 1 << 10,
+    Pipeline = 1 << 11,
+    PipelinePump = 1 << 12,
+    GeneratorFuel = 1 << 13,
+    GeneratorNuclear = 1 << 14,
+    SimpleProducer = 1 << 15,
+};
+
+ENUM_CLASS_FLAGS(EEfficiencyCheckerClassFlags);
+
+struct FEfficiencyCheckerNode
+{
+    class AFGBuildable* buildable = nullptr;
+
+    EEfficiencyCheckerClassFlags classFlags = EEfficiencyCheckerClassFlags::None;
+
+    // Connection components are resolved once, when the buildable is indexed
+    TArray<class UFGFactoryConnectionComponent*> factoryConnections;
+    TArray<class UFGPipeConnectionComponent*> pipeConnections;
+};
+
+/**
+ * Persistent index of the buildables that take part on the traversals, keyed by actor and by connection component.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerGraph
+{
+public:
+    int32 addNode(class AFGBuildable* buildable, EEfficiencyCheckerClassFlags classFlags);
+    void removeNode(const AActor* actor);
+
+    int32 findNode(const AActor* actor) const;
+    int32 findConnectionNode(const class UFGConnectionComponent* connection) const;
+
+    // Node on the other side of the connection, if it is connected and indexed
+    int32 findConnectedNode(const class UFGConnectionComponent* connection) const;
+
+    inline const FEfficiencyCheckerNode*
+    getNode(int32 nodeIndex) const
+    {
+        return nodes.IsValidIndex(nodeIndex) ? &nodes[nodeIndex] : nullptr;
+    }
+
+    inline int32
+    Num() const
+    {
+        return nodes.Num();
+    }
+
+    // Every indexed node, for the passes that run over the whole graph
+    inline const TSparseArray<FEfficiencyCheckerNode>&
+    getNodes() const
+    {
+        return nodes;
+    }
+
+    void Empty();
+
+protected:
+    TSparseArray<FEfficiencyCheckerNode> nodes;
+
+    TMap<const AActor*, int32> nodeByActor;
+    TMap<const class UFGConnectionComponent*, int32> nodeByConnection;
+};
@@ -0,0 +1,290 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Set of interned item indexes (see AEfficiencyCheckerLogic::getItemIndex).
+ * Mirrors the TSet operations used by the traversals, but all of them are done word by word. The first 1024 items fit
+ * on the inline words and never allocate. The set grows past them, so no item is ever dropped. Missing words are taken
+ * as empty.
+ */
+struct FEfficiencyCheckerItemSet
+{
+    static constexpr int32 NumInlineWords = 1024 / 64;
+
+    TArray<uint64, TInlineAllocator<NumInlineWords>> words;
+
+    FORCEINLINE static bool
+    IsValidItem(int32 itemIndex)
+    {
+        return 0 <= itemIndex;
+    }
+
+    FORCEINLINE void
+    Add(int32 itemIndex)
+    {
+        if (!IsValidItem(itemIndex))
+        {
+            return;
+        }
+
+        const auto wordIndex = itemIndex >> 6;
+        if (wordIndex >= words.Num())
+        {
+            words.AddZeroed(wordIndex + 1 - words.Num());
+        }
+
+        words[wordIndex] |= uint64(1) << (itemIndex & 63);
+    }
+
+    FORCEINLINE void
+    Remove(int32 itemIndex)
+    {
+        if (IsValidItem(itemIndex) && (itemIndex >> 6) < words.Num())
+        {
+            words[itemIndex >> 6] &= ~(uint64(1) << (itemIndex & 63));
+        }
+    }
+
+    FORCEINLINE bool
+    Contains(int32 itemIndex) const
+    {
+        return IsValidItem(itemIndex) && (itemIndex >> 6) < words.Num() && (words[itemIndex >> 6] & uint64(1) << (itemIndex & 63)) != 0;
+    }
+
+    FORCEINLINE void
+    Empty()
+    {
+        // Keeps the words, as the set is usually filled again
+        FMemory::Memzero(words.GetData(), words.Num() * sizeof(uint64));
+    }
+
+    FORCEINLINE bool
+    IsEmpty() const
+    {
+        for (auto word : words)
+        {
+            if (word)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int32
+    Num() const
+    {
+        int32 count = 0;
+
+        for (auto word : words)
+        {
+            count += FPlatformMath::CountBits(word);
+        }
+
+        return count;
+    }
+
+    // True if any item is on both sets
+    FORCEINLINE bool
+    Intersects(const FEfficiencyCheckerItemSet& other) const
+    {
+        const auto numWords = FMath::Min(words.Num(), other.words.Num());
+
+        for (int32 x = 0; x < numWords; x++)
+        {
+            if (words[x] & other.words[x])
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // True if all items of other are on this set
+    FORCEINLINE bool
+    Includes(const FEfficiencyCheckerItemSet& other) const
+    {
+        for (int32 x = 0; x < other.words.Num(); x++)
+        {
+            if (other.words[x] & ~getWord(x))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    FORCEINLINE FEfficiencyCheckerItemSet
+    Intersect(const FEfficiencyCheckerItemSet& other) const
+    {
+        FEfficiencyCheckerItemSet result;
+
+        const auto numWords = FMath::Min(words.Num(), other.words.Num());
+        result.words.SetNumUninitialized(numWords);
+
+        for (int32 x = 0; x < numWords; x++)
+        {
+            result.words[x] = words[x] & other.words[x];
+        }
+
+        return result;
+    }
+
+    FORCEINLINE FEfficiencyCheckerItemSet
+    Union(const FEfficiencyCheckerItemSet& other) const
+    {
+        FEfficiencyCheckerItemSet result(*this);
+
+        result.Append(other);
+
+        return result;
+    }
+
+    FORCEINLINE FEfficiencyCheckerItemSet
+    Difference(const FEfficiencyCheckerItemSet& other) const
+    {
+        FEfficiencyCheckerItemSet result;
+
+        result.words.SetNumUninitialized(words.Num());
+
+        for (int32 x = 0; x < words.Num(); x++)
+        {
+            result.words[x] = words[x] & ~other.getWord(x);
+        }
+
+        return result;
+    }
+
+    FORCEINLINE void
+    Append(const FEfficiencyCheckerItemSet& other)
+    {
+        if (other.words.Num() > words.Num())
+        {
+            words.AddZeroed(other.words.Num() - words.Num());
+        }
+
+        for (int32 x = 0; x < other.words.Num(); x++)
+        {
+            words[x] |= other.words[x];
+        }
+    }
+
+    FORCEINLINE bool
+    operator==(const FEfficiencyCheckerItemSet& other) const
+    {
+        const auto numWords = FMath::Max(words.Num(), other.words.Num());
+
+        for (int32 x = 0; x < numWords; x++)
+        {
+            if (getWord(x) != other.getWord(x))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    FORCEINLINE bool
+    operator!=(const FEfficiencyCheckerItemSet& other) const
+    {
+        return !(*this == other);
+    }
+
+    friend FORCEINLINE uint32
+    GetTypeHash(const FEfficiencyCheckerItemSet& itemSet)
+    {
+        // Trailing empty words are left out, so equal sets hash the same whatever their width
+        auto numWords = itemSet.words.Num();
+        while (numWords && !itemSet.words[numWords - 1])
+        {
+            numWords--;
+        }
+
+        return FCrc::MemCrc32(itemSet.words.GetData(), numWords * sizeof(uint64));
+    }
+
+    // Iterates over the item indexes on the set, in ascending order
+    class TConstIterator
+    {
+    public:
+        TConstIterator(const FEfficiencyCheckerItemSet& in_itemSet, int32 in_wordIndex)
+            : itemSet(in_itemSet),
+              wordIndex(in_wordIndex),
+              pendingBits(in_itemSet.getWord(in_wordIndex))
+        {
+            skipEmptyWords();
+        }
+
+        FORCEINLINE int32
+        operator*() const
+        {
+            return (wordIndex << 6) + countTrailingZeros(pendingBits);
+        }
+
+        FORCEINLINE TConstIterator&
+        operator++()
+        {
+            // Clear the lowest bit set
+            pendingBits &= pendingBits - 1;
+
+            skipEmptyWords();
+
+            return *this;
+        }
+
+        FORCEINLINE bool
+        operator!=(const TConstIterator& other) const
+        {
+            return wordIndex != other.wordIndex || pendingBits != other.pendingBits;
+        }
+
+    private:
+        FORCEINLINE void
+        skipEmptyWords()
+        {
+            while (!pendingBits && wordIndex < itemSet.words.Num())
+            {
+                ++wordIndex;
+                pendingBits = itemSet.getWord(wordIndex);
+            }
+        }
+
+        FORCEINLINE static int32
+        countTrailingZeros(uint64 value)
+        {
+            const auto lowBits = static_cast<uint32>(value);
+
+            return lowBits
+                       ? FPlatformMath::CountTrailingZeros(lowBits)
+                       : 32 + FPlatformMath::CountTrailingZeros(static_cast<uint32>(value >> 32));
+        }
+
+        const FEfficiencyCheckerItemSet& itemSet;
+        int32 wordIndex;
+        uint64 pendingBits;
+    };
+
+    FORCEINLINE TConstIterator
+    begin() const
+    {
+        return TConstIterator(*this, 0);
+    }
+
+    FORCEINLINE TConstIterator
+    end() const
+    {
+        return TConstIterator(*this, words.Num());
+    }
+
+private:
+    FORCEINLINE uint64
+    getWord(int32 wordIndex) const
+    {
+        return wordIndex < words.Num() ? words[wordIndex] : 0;
+    }
+};
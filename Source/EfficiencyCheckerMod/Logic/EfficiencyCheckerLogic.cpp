@@ -5,6 +5,7 @@
 #include "EfficiencyCheckerLogic.h"
 #include "EfficiencyCheckerModModule.h"
 #include "EfficiencyCheckerRCO.h"
+#include "EfficiencyCheckerTraversal.h"
 
 #include "Animation/AnimSequence.h"
 #include "FGBuildableConveyorAttachment.h"
@@ -24,14 +25,17 @@
 #include "FGConnectionComponent.h"
 #include "FGEquipmentAttachment.h"
 #include "FGEquipmentDescriptor.h"
+#include "FGFactoryConnectionComponent.h"
 #include "FGGameMode.h"
 #include "FGItemCategory.h"
 #include "FGItemDescriptor.h"
 #include "FGPipeConnectionComponent.h"
 #include "FGRailroadSubsystem.h"
 #include "FGRailroadTimeTable.h"
+#include "FGRecipe.h"
 #include "FGTrain.h"
 #include "FGTrainStationIdentifier.h"
+#include "TimerManager.h"
 
 #include "SML/util/Logging.h"
 #include "SML/util/ReflectionHelper.h"
@@ -40,7 +44,6 @@
 #include "Util/Util.h"
 
 #include <set>
-#include <map>
 
 
 #ifndef OPTIMIZE
@@ -78,6 +81,14 @@ inline FString getEnumItemName(TCHAR* name, int value)
 	return FString::Printf(TEXT("%s (%d)"), *valueStr, value);
 }
 
+AEfficiencyCheckerLogic::AEfficiencyCheckerLogic()
+{
+	// Only ticks while there are queued checker updates
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bAllowTickOnDedicatedServer = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
 void AEfficiencyCheckerLogic::Initialize
 (
 	const TSet<TSubclassOf<UFGItemDescriptor>>& in_noneItemDescriptors,
@@ -95,10 +106,32 @@ void AEfficiencyCheckerLogic::Initialize
 	overflowItemDescriptors = in_overflowItemDescriptors;
 	nuclearWasteItemDescriptors = in_nuclearWasteItemDescriptors;
 
+	{
+		FScopeLock ScopeLock(&eclCritical);
+
+		// Intern all known items upfront, so the indexes are dense and stable for the session
+		TArray<TSubclassOf<UFGItemDescriptor>> allItems;
+		UFGBlueprintFunctionLibrary::Cheat_GetAllDescriptors(allItems);
+
+		for (auto item : allItems)
+		{
+			getItemIndex(item);
+		}
+
+		noneItemMask = toItemSet(noneItemDescriptors);
+		wildCardItemMask = toItemSet(wildCardItemDescriptors);
+		anyUndefinedItemMask = toItemSet(anyUndefinedItemDescriptors);
+		overflowItemMask = toItemSet(overflowItemDescriptors);
+		nuclearWasteItemMask = toItemSet(nuclearWasteItemDescriptors);
+	}
+
 	removeEffiencyBuildingDelegate.BindDynamic(this, &AEfficiencyCheckerLogic::removeEfficiencyBuilding);
 	removeBeltDelegate.BindDynamic(this, &AEfficiencyCheckerLogic::removeBelt);
 	removePipeDelegate.BindDynamic(this, &AEfficiencyCheckerLogic::removePipe);
 	removeTeleporterDelegate.BindDynamic(this, &AEfficiencyCheckerLogic::removeTeleporter);
+	removeBuildableDelegate.BindDynamic(this, &AEfficiencyCheckerLogic::removeBuildable);
+
+	GetWorldTimerManager().SetTimer(storageIDTimer, this, &AEfficiencyCheckerLogic::pollStorageIDs, 1, true);
 
 	auto subsystem = AFGBuildableSubsystem::Get(this);
 
@@ -112,6 +145,12 @@ void AEfficiencyCheckerLogic::Initialize
 		for (auto buildableActor : allBuildables)
 		{
 			IsValidBuildable(Cast<AFGBuildable>(buildableActor));
+
+			const auto manufacturer = Cast<AFGBuildableManufacturer>(buildableActor);
+			if (manufacturer)
+			{
+				getRecipe(manufacturer->GetCurrentRecipe());
+			}
 		}
 
 		auto gameMode = Cast<AFGGameMode>(UGameplayStatics::GetGameMode(subsystem->GetWorld()));
@@ -124,50 +163,84 @@ void AEfficiencyCheckerLogic::Initialize
 
 void AEfficiencyCheckerLogic::Terminate()
 {
+	if (GetWorld())
+	{
+		GetWorldTimerManager().ClearTimer(storageIDTimer);
+	}
+
 	FScopeLock ScopeLock(&eclCritical);
 	allEfficiencyBuildings.Empty();
 	allBelts.Empty();
 	allPipes.Empty();
+	beltGrid.Empty();
+	pipeGrid.Empty();
 	allTeleporters.Empty();
+	teleportersByStorageID.Empty();
+	railroadRoutes.Empty();
+	teleporterStorageIDs.Empty();
+	storageIDProperty = nullptr;
+	graph.Empty();
+	classFlags.Empty();
+	checkersByBuildable.Empty();
+	pendingUpdates.Empty();
+	pendingUpdatesHead = 0;
+	pendingUpdatesSet.Empty();
+	currentUpdate.Reset();
+	flowField.Empty();
+	loops.Empty();
+	pipeNetworks.Empty();
+	chains.Empty();
+	sortRules.Empty();
+	loopsVersion = INDEX_NONE;
+	subWalks.Empty();
+	components.Empty();
+	itemDescriptors.Empty();
+	itemIndexes.Empty();
+	itemEnergyValues.Empty();
+	recipes.Empty();
+	solidConveyorItemMask.Empty();
 
 	singleton = nullptr;
 }
 
-bool AEfficiencyCheckerLogic::containsActor(const std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors, AActor* actor)
+bool AEfficiencyCheckerLogic::containsActor(const FEfficiencyCheckerSeenActors& seenActors, AActor* actor)
 {
-	return seenActors.find(actor) != seenActors.end();
+	return seenActors.Contains(actor);
 }
 
 bool AEfficiencyCheckerLogic::actorContainsItem
 (
-	const std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors,
+	const FEfficiencyCheckerSeenActors& seenActors,
 	AActor* actor,
-	const TSubclassOf<UFGItemDescriptor>& item
+	int32 itemIndex
 )
 {
-	auto it = seenActors.find(actor);
-	if (it == seenActors.end())
-	{
-		return false;
-	}
+	const auto items = seenActors.Find(actor);
+
+	return items && items->Contains(itemIndex);
+}
+
+bool AEfficiencyCheckerLogic::actorContainsAllItems
+(
+	const FEfficiencyCheckerSeenActors& seenActors,
+	AActor* actor,
+	const FEfficiencyCheckerItemSet& items
+)
+{
+	const auto seenItems = seenActors.Find(actor);
 
-	return it->second.Contains(item);
+	return seenItems && seenItems->Includes(items);
 }
 
 void AEfficiencyCheckerLogic::addAllItemsToActor
 (
-	std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors,
+	FEfficiencyCheckerSeenActors& seenActors,
 	AActor* actor,
-	const TSet<TSubclassOf<UFGItemDescriptor>>& items
+	const FEfficiencyCheckerItemSet& items
 )
 {
 	// Ensure the actor exists, even with an empty list
-	seenActors[actor];
-
-	for (auto item : items)
-	{
-		seenActors[actor].Add(item);
-	}
+	seenActors.FindOrAdd(actor).Append(items);
 }
 
 void AEfficiencyCheckerLogic::collectInput
@@ -179,3157 +252,1427 @@ void AEfficiencyCheckerLogic::collectInput
 	float& out_limitedThroughput,
 	TSet<AActor*>& seenActors,
 	TSet<class AFGBuildable*>& connected,
-	TSet<TSubclassOf<UFGItemDescriptor>>& out_injectedItems,
-	const TSet<TSubclassOf<UFGItemDescriptor>>& in_restrictItems,
+	FEfficiencyCheckerItemSet& out_injectedItems,
+	const FEfficiencyCheckerItemSet& restrictItems,
 	class AFGBuildableSubsystem* buildableSubsystem,
-	int level,
-	bool& overflow,
-	const FString& indent
+	bool& overflow
 )
 {
-	TSet<TSubclassOf<UFGItemDescriptor>> restrictItems = in_restrictItems;
+	FEfficiencyCheckerTraversal traversal(resourceForm, connected, buildableSubsystem);
+
+	traversal.collectInput(
+		customInjectedInput,
+		connector,
+		out_injectedInput,
+		out_limitedThroughput,
+		seenActors,
+		out_injectedItems,
+		restrictItems
+		);
+
+	overflow |= traversal.hasOverflow();
+}
 
-	for (;;)
-	{
-		if (!connector)
-		{
-			return;
-		}
+void AEfficiencyCheckerLogic::collectOutput
+(
+	EResourceForm resourceForm,
+	class UFGConnectionComponent* connector,
+	float& out_requiredOutput,
+	float& out_limitedThroughput,
+	FEfficiencyCheckerSeenActors& seenActors,
+	TSet<AFGBuildable*>& connected,
+	const FEfficiencyCheckerItemSet& injectedItems,
+	class AFGBuildableSubsystem* buildableSubsystem,
+	bool& overflow
+)
+{
+	FEfficiencyCheckerTraversal traversal(resourceForm, connected, buildableSubsystem);
 
-		auto owner = connector->GetOwner();
+	traversal.collectOutput(
+		connector,
+		out_requiredOutput,
+		out_limitedThroughput,
+		seenActors,
+		injectedItems
+		);
+
+	overflow |= traversal.hasOverflow();
+}
 
-		if (!owner || seenActors.Contains(owner))
+bool AEfficiencyCheckerLogic::inheritsFrom(UClass* actorClass, const FString& className)
+{
+	for (auto cls = actorClass; cls && cls != AActor::StaticClass(); cls = cls->GetSuperClass())
+	{
+		if (GetPathNameSafe(cls) == className)
 		{
-			return;
+			return true;
 		}
+	}
 
-		const auto fullClassName = GetPathNameSafe(owner->GetClass());
-
-		if (level > 100)
-		{
-			SML::Logging::error(
-				*getTimeStamp(),
-				*indent,
-				TEXT("collectInput: level is too deep: "),
-				level,
-				TEXT("; "),
-				*owner->GetName(),
-				TEXT(" / "),
-				*fullClassName
-				);
+	return false;
+}
 
-			overflow = true;
+void AEfficiencyCheckerLogic::dumpUnknownClass(const FString& indent, AActor* owner)
+{
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(*getTimeStamp(), *indent, TEXT("Unknown Class "), *GetPathNameSafe(owner->GetClass()));
 
-			return;
+		for (auto cls = owner->GetClass()->GetSuperClass(); cls && cls != AActor::StaticClass(); cls = cls->GetSuperClass())
+		{
+			SML::Logging::info(*getTimeStamp(), *indent, TEXT("    - Super: "), *GetPathNameSafe(cls));
 		}
 
-		if (FEfficiencyCheckerModModule::dumpConnections)
+		SML::Logging::info(*getTimeStamp(), *indent, TEXT("Properties "), *GetPathNameSafe(owner->GetClass()));
+
+		for (TFieldIterator<UProperty> property(owner->GetClass()); property; ++property)
 		{
 			SML::Logging::info(
 				*getTimeStamp(),
 				*indent,
-				TEXT("collectInput at level "),
-				level,
-				TEXT(": "),
-				*owner->GetName(),
-				TEXT(" / "),
-				*fullClassName
+				TEXT("        - "),
+				*property->GetName(),
+				TEXT(" ("),
+				*property->GetCPPType(),
+				TEXT(" / Type: "),
+				*GetPathNameSafe(property->GetClass()),
+				TEXT(" / From: "),
+				*GetPathNameSafe(property->GetOwnerClass()),
+				TEXT(")")
 				);
-		}
 
-		seenActors.Add(owner);
+			auto floatProperty = Cast<UFloatProperty>(*property);
+			if (floatProperty)
+			{
+				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), floatProperty->GetPropertyValue_InContainer(owner));
+			}
 
-		{
-			const auto manufacturer = Cast<AFGBuildableManufacturer>(owner);
-			if (manufacturer)
+			auto intProperty = Cast<UIntProperty>(*property);
+			if (intProperty)
+			{
+				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), intProperty->GetPropertyValue_InContainer(owner));
+			}
+
+			auto boolProperty = Cast<UBoolProperty>(*property);
+			if (boolProperty)
 			{
-				const auto recipeClass = manufacturer->GetCurrentRecipe();
+				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), boolProperty->GetPropertyValue_InContainer(owner) ? TEXT("true") : TEXT("false"));
+			}
 
-				if (recipeClass)
+			auto structProperty = Cast<UStructProperty>(*property);
+			if (structProperty && property->GetName() == TEXT("mFactoryTickFunction"))
+			{
+				auto factoryTick = structProperty->ContainerPtrToValuePtr<FFactoryTickFunction>(owner);
+				if (factoryTick)
 				{
-					auto products = UFGRecipe::GetProducts(recipeClass);
-
-					for (auto item : products)
-					{
-						auto itemForm = UFGItemDescriptor::GetForm(item.ItemClass);
-
-						if (itemForm == EResourceForm::RF_SOLID && resourceForm != EResourceForm::RF_SOLID ||
-							(itemForm == EResourceForm::RF_LIQUID || itemForm == EResourceForm::RF_GAS) &&
-							resourceForm != EResourceForm::RF_LIQUID && resourceForm != EResourceForm::RF_GAS ||
-							!restrictItems.Contains(item.ItemClass))
-						{
-							continue;
-						}
-
-						out_injectedItems.Add(item.ItemClass);
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Item amount = "), item.Amount);
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Current potential = "), manufacturer->GetCurrentPotential());
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Pending potential = "), manufacturer->GetPendingPotential());
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Production cycle time = "),
-								manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential())
-								);
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Recipe duration = "), UFGRecipe::GetManufacturingDuration(recipeClass));
-						}
-
-						float itemAmountPerMinute = item.Amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
-
-						if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-						{
-							itemAmountPerMinute /= 1000;
-						}
-
-						// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
-						// {
-						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
-						//     {
-						//         itemAmountPerMinute *= 1.5;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
-						//     {
-						//         itemAmountPerMinute *= 2;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("Mk4_C")))
-						//     {
-						//         itemAmountPerMinute *= 2.5;
-						//     }
-						// }
-						// else if (fullClassName.StartsWith(TEXT("/Game/FarmingMod/Buildable")))
-						// {
-						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
-						//     {
-						//         itemAmountPerMinute *= 2;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
-						//     {
-						//         itemAmountPerMinute *= 3;
-						//     }
-						// }
-
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								*manufacturer->GetName(),
-								TEXT(" produces "),
-								itemAmountPerMinute,
-								TEXT(" "),
-								*UFGItemDescriptor::GetItemName(item.ItemClass).ToString(),
-								TEXT("/minute")
-								);
-						}
-
-						if (!customInjectedInput)
-						{
-							out_injectedInput += itemAmountPerMinute;
-						}
-
-						break;
-					}
+					SML::Logging::info(*getTimeStamp(), *indent, TEXT("            - Tick Interval = "), factoryTick->TickInterval);
 				}
+			}
 
-				connected.Add(manufacturer);
+			auto strProperty = Cast<UStrProperty>(*property);
+			if (strProperty)
+			{
+				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), *strProperty->GetPropertyValue_InContainer(owner));
+			}
 
-				return;
+			auto classProperty = Cast<UClassProperty>(*property);
+			if (classProperty)
+			{
+				auto ClassObject = Cast<UClass>(classProperty->GetPropertyValue_InContainer(owner));
+				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            - Class = "), *GetPathNameSafe(ClassObject));
 			}
 		}
+	}
+}
 
+void AEfficiencyCheckerLogic::DumpInformation(TSubclassOf<UFGItemDescriptor> itemDescriptorClass)
+{
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		if (!itemDescriptorClass)
 		{
-			const auto extractor = Cast<AFGBuildableResourceExtractor>(owner);
-			if (extractor)
-			{
-				TSubclassOf<UFGItemDescriptor> item;
+			return;
+		}
 
-				if (!item)
-				{
-					const auto resource = extractor->GetExtractableResource();
-					if (resource)
-					{
-						const auto resourceObj = resource.GetObject();
-
-						item = IFGExtractableResourceInterface::Execute_GetResourceClass(resourceObj);
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Extraction Speed Multiplier = "),
-								IFGExtractableResourceInterface::Execute_GetExtractionSpeedMultiplier(resourceObj)
-								);
-						}
-					}
-					else
-					{
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Extractable resource is null"));
-						}
-					}
-				}
+		auto className = GetFullNameSafe(itemDescriptorClass);
 
-				if (!item)
-				{
-					item = extractor->GetOutputInventory()->GetAllowedItemOnIndex(0);
-				}
+		SML::Logging::info(*getTimeStamp(), TEXT(" Dumping "), *className);
 
-				if (!item || !restrictItems.Contains(item))
-				{
-					return;
-				}
+		auto itemDescriptor = Cast<UFGItemDescriptor>(itemDescriptorClass->GetDefaultObject());
+		if (!itemDescriptor)
+		{
+			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment small icon = "), *GetPathNameSafe(itemDescriptor->mSmallIcon));
+			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment big icon = "), *GetPathNameSafe(itemDescriptor->mPersistentBigIcon));
+			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment conveyor mesh = "), *GetPathNameSafe(itemDescriptor->mConveyorMesh));
+			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment item category = "), *GetPathNameSafe(itemDescriptor->mItemCategory));
+		}
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("Resource name = "), *UFGItemDescriptor::GetItemName(item).ToString());
-				}
+		auto equipmentDescriptor = Cast<UFGEquipmentDescriptor>(itemDescriptor);
+		if (!equipmentDescriptor)
+		{
+			SML::Logging::info(*getTimeStamp(), TEXT(" Class "), *className, TEXT(" is not an Equipment Descriptor"));
 
-				out_injectedItems.Add(item);
+			return;
+		}
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("Current potential = "), extractor->GetCurrentPotential());
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("Pending potential = "), extractor->GetPendingPotential());
-					SML::Logging::info(
-						*getTimeStamp(),
-						*indent,
-						TEXT("Production cycle time = "),
-						extractor->CalcProductionCycleTimeForPotential(extractor->GetPendingPotential())
-						);
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("Items per cycle converted = "), extractor->GetNumExtractedItemsPerCycleConverted());
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("Items per cycle = "), extractor->GetNumExtractedItemsPerCycle());
-				}
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment stack size = "), *getEnumItemName(TEXT("EStackSize"), (int)equipmentDescriptor->mStackSize));
 
-				float itemAmountPerMinute = extractor->GetNumExtractedItemsPerCycle() * (60.0 / extractor->CalcProductionCycleTimeForPotential(extractor->GetPendingPotential()));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment class = "), *GetPathNameSafe(equipmentDescriptor->mEquipmentClass));
 
-				if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-				{
-					itemAmountPerMinute /= 1000;
-				}
+		if (!equipmentDescriptor->mEquipmentClass)
+		{
+			return;
+		}
 
-				if (fullClassName == TEXT("/Game/Miner_Mk4/Build_MinerMk4.Build_MinerMk4_C"))
-				{
-					itemAmountPerMinute = 2000;
-				}
+		auto equipment = Cast<AFGEquipment>(equipmentDescriptor->mEquipmentClass->GetDefaultObject());
 
-				// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
-				// {
-				//     if (fullClassName.EndsWith(TEXT("MK2_C")))
-				//     {
-				//         itemAmountPerMinute *= 1.5;
-				//     }
-				//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
-				//     {
-				//         itemAmountPerMinute *= 2;
-				//     }
-				//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
-				//     {
-				//         itemAmountPerMinute *= 2.5;
-				//     }
-				// }
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment attachment = "), *GetPathNameSafe(equipment->mAttachmentClass));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment secondary attachment = "), *GetPathNameSafe(equipment->mSecondaryAttachmentClass));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment slot = "), *getEnumItemName(TEXT("EEquipmentSlot"), (int)equipment->mEquipmentSlot));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment attachment socket = "), *equipment->mAttachSocket.ToString());
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment arm animation = "), *getEnumItemName(TEXT("EArmEquipment"), (int)equipment->mArmAnimation));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment back animation = "), *getEnumItemName(TEXT("EBackEquipment"), (int)equipment->mBackAnimation));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment equip sound = "), *GetPathNameSafe(equipment->mEquipSound));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment unequip sound = "), *GetPathNameSafe(equipment->mUnequipSound));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment widget = "), *GetPathNameSafe(equipment->mEquipmentWidget));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment use default primary fire = "), equipment->mUseDefaultPrimaryFire ? TEXT("true") : TEXT("false"));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment idle pose animation = "), *GetPathNameSafe(equipment->GetIdlePoseAnimation()));
+		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment idle pose animation 3p = "), *GetPathNameSafe(equipment->GetIdlePoseAnimation3p()));
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(
-						*getTimeStamp(),
-						*indent,
-						*extractor->GetName(),
-						TEXT(" extracts "),
-						itemAmountPerMinute,
-						TEXT(" "),
-						*UFGItemDescriptor::GetItemName(item).ToString(),
-						TEXT("/minute")
-						);
-				}
+		SML::Logging::info(*getTimeStamp(), TEXT(" Dump done"));
+	}
+}
 
-				if (!customInjectedInput)
-				{
-					out_injectedInput += itemAmountPerMinute;
-				}
+bool AEfficiencyCheckerLogic::IsValidBuildable(AFGBuildable* newBuildable)
+{
+	if (!newBuildable)
+	{
+		return false;
+	}
 
-				connected.Add(extractor);
+	if (auto checker = Cast<AEfficiencyCheckerBuilding>(newBuildable))
+	{
+		addEfficiencyBuilding(checker);
 
-				return;
-			}
-		}
+		return true;
+	}
+	if (Cast<AFGBuildableManufacturer>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-		if (resourceForm == EResourceForm::RF_SOLID)
-		{
-			const auto conveyor = Cast<AFGBuildableConveyorBase>(owner);
-			if (conveyor)
-			{
-				// The innitial limit for a belt is its own speed
-				// out_limitedThroughput = conveyor->GetSpeed() / 2;
-
-				// const auto conveyorInput = conveyor->GetConnection0();
-				// if (conveyorInput && conveyorInput->IsConnected())
-				// {
-				//     float previousLimit = out_limitedThroughput;
-				//     collectInput(
-				//         resourceForm,
-				//         customInjectedInput,
-				//         conveyorInput->GetConnection(),
-				//         out_injectedInput,
-				//         previousLimit,
-				//         seenActors,
-				//         connected,
-				//         out_injectedItems,
-				//         restrictItems,
-				//         buildableSubsystem,
-				//         level + 1,
-				//         indent + TEXT("    ")
-				//         );
-				//
-				//     out_limitedThroughput = FMath::Min(out_limitedThroughput, previousLimit);
-				// }
-
-				connected.Add(conveyor);
-
-				connector = conveyor->GetConnection0()->GetConnection();
-
-				out_limitedThroughput = FMath::Min(out_limitedThroughput, conveyor->GetSpeed() / 2);
+		return true;
+	}
+	if (Cast<AFGBuildableResourceExtractor>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, *conveyor->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
-				}
+		return true;
+	}
+	if (Cast<AFGBuildableStorage>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-				continue;
-			}
+		return true;
+	}
+	if (auto belt = Cast<AFGBuildableConveyorBelt>(newBuildable))
+	{
+		addBelt(belt);
 
-			AFGBuildableStorage* storageContainer = nullptr;
-			AFGBuildableTrainPlatformCargo* cargoPlatform = nullptr;
-			AFGBuildableConveyorAttachment* conveyorAttachment = nullptr;
-			AFGBuildableDockingStation* dockingStation = nullptr;
-			AFGBuildableFactory* storageTeleporter = nullptr;
+		addBuildable(newBuildable);
 
-			AFGBuildableFactory* buildable = conveyorAttachment = Cast<AFGBuildableConveyorAttachment>(owner);
-			if (!buildable)
-			{
-				buildable = storageContainer = Cast<AFGBuildableStorage>(owner);
-			}
+		return true;
+	}
+	if (Cast<AFGBuildableConveyorBase>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-			if (!buildable)
-			{
-				cargoPlatform = Cast<AFGBuildableTrainPlatformCargo>(owner);
-				if (cargoPlatform)
-				{
-					buildable = cargoPlatform;
+		return true;
+	}
+	if (Cast<AFGBuildableConveyorAttachment>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-					TArray<FInventoryStack> stacks;
+		return true;
+	}
+	if (auto pipe = Cast<AFGBuildablePipeline>(newBuildable))
+	{
+		addPipe(pipe);
 
-					cargoPlatform->GetInventory()->GetInventoryStacks(stacks);
+		addBuildable(newBuildable);
 
-					for (auto stack : stacks)
-					{
-						if (!restrictItems.Contains(stack.Item.ItemClass))
-						{
-							continue;
-						}
+		return true;
+	}
+	if (Cast<AFGBuildablePipelineAttachment>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-						out_injectedItems.Add(stack.Item.ItemClass);
-					}
-				}
-			}
+		return true;
+	}
+	if (Cast<AFGBuildableTrainPlatform>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-			if (!buildable)
-			{
-				dockingStation = Cast<AFGBuildableDockingStation>(owner);
-				if (dockingStation)
-				{
-					buildable = dockingStation;
-
-					TArray<FInventoryStack> stacks;
+		return true;
+	}
+	if (Cast<AFGBuildableRailroadStation>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-					dockingStation->GetInventory()->GetInventoryStacks(stacks);
+		return true;
+	}
+	if (Cast<AFGBuildableDockingStation>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-					for (auto stack : stacks)
-					{
-						if (!restrictItems.Contains(stack.Item.ItemClass))
-						{
-							continue;
-						}
+		return true;
+	}
+	if (Cast<AFGBuildableGeneratorFuel>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-						out_injectedItems.Add(stack.Item.ItemClass);
-					}
-				}
-			}
+		return true;
+	}
+	if (Cast<AFGBuildableGeneratorNuclear>(newBuildable))
+	{
+		addBuildable(newBuildable);
 
-			if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
-				!buildable && fullClassName == TEXT("/Game/StorageTeleporter/Buildables/ItemTeleporter/ItemTeleporter_Build.ItemTeleporter_Build_C"))
-			{
-				buildable = storageTeleporter = Cast<AFGBuildableFactory>(owner);
-			}
+		return true;
+	}
+	if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
+		GetPathNameSafe(newBuildable->GetClass()) == TEXT("/Game/StorageTeleporter/Buildables/ItemTeleporter/ItemTeleporter_Build.ItemTeleporter_Build_C"))
+	{
+		addTeleporter(newBuildable);
 
-			if (buildable)
-			{
-				auto components = buildable->GetConnectionComponents();
+		addBuildable(newBuildable);
 
-				if (cargoPlatform)
-				{
-					auto trackId = cargoPlatform->GetTrackGraphID();
-
-					auto railroadSubsystem = AFGRailroadSubsystem::Get(owner->GetWorld());
-
-					// Determine offsets from all the connected stations
-					std::set<int> stationOffsets;
-					TSet<AFGBuildableRailroadStation*> destinationStations;
-
-					for (auto i = 0; i <= 1; i++)
-					{
-						auto offsetDistance = 1;
-
-						for (auto connectedPlatform = cargoPlatform->GetConnectedPlatformInDirectionOf(i);
-						     connectedPlatform;
-						     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-						     ++offsetDistance)
-						{
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									*connectedPlatform->GetName(),
-									TEXT(" direction = "),
-									i,
-									TEXT(" / orientation reversed = "),
-									connectedPlatform->IsOrientationReversed() ? TEXT("true") : TEXT("false")
-									);
-							}
-
-							auto station = Cast<AFGBuildableRailroadStation>(connectedPlatform);
-							if (station)
-							{
-								destinationStations.Add(station);
-
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(
-										*getTimeStamp(),
-										*indent,
-										TEXT("    Station = "),
-										*station->GetStationIdentifier()->GetStationName().ToString()
-										);
-								}
-
-								if (i == 0 && connectedPlatform->IsOrientationReversed() ||
-									i == 1 && !connectedPlatform->IsOrientationReversed())
-								{
-									stationOffsets.insert(offsetDistance);
-									if (FEfficiencyCheckerModModule::dumpConnections)
-									{
-										SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), offsetDistance);
-									}
-								}
-								else
-								{
-									stationOffsets.insert(-offsetDistance);
-									if (FEfficiencyCheckerModModule::dumpConnections)
-									{
-										SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), -offsetDistance);
-									}
-								}
-							}
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								auto cargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-								if (cargo)
-								{
-									SML::Logging::info(
-										*getTimeStamp(),
-										*indent,
-										TEXT("    Load mode = "),
-										cargo->GetIsInLoadMode() ? TEXT("true") : TEXT("false")
-										);
-								}
-							}
-						}
-					}
-
-					TArray<AFGTrain*> trains;
-					railroadSubsystem->GetTrains(trackId, trains);
-
-					for (auto train : trains)
-					{
-						if (!train->HasTimeTable())
-						{
-							continue;
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							if (!train->GetTrainName().IsEmpty())
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("Train = "),
-									*train->GetTrainName().ToString()
-									);
-							}
-							else
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("Anonymous Train")
-									);
-							}
-						}
-
-						// Get train stations
-						auto timeTable = train->GetTimeTable();
-
-						TArray<FTimeTableStop> stops;
-						timeTable->GetStops(stops);
-
-						bool stopAtStations = false;
-
-						for (auto stop : stops)
-						{
-							if (!stop.Station || !stop.Station->GetStation() || !destinationStations.Contains(stop.Station->GetStation()))
-							{
-								continue;
-							}
-
-							stopAtStations = true;
-
-							break;
-						}
-
-						if (!stopAtStations)
-						{
-							continue;
-						}
-
-						for (auto stop : stops)
-						{
-							if (!stop.Station || !stop.Station->GetStation())
-							{
-								continue;
-							}
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Stop = "),
-									*stop.Station->GetStationName().ToString()
-									);
-							}
-
-							for (auto i = 0; i <= 1; i++)
-							{
-								auto offsetDistance = 1;
-
-								for (auto connectedPlatform = stop.Station->GetStation()->GetConnectedPlatformInDirectionOf(i);
-								     connectedPlatform;
-								     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-								     ++offsetDistance)
-								{
-									auto stopCargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-									if (!stopCargo || stopCargo == cargoPlatform)
-									{
-										// Not a cargo or the same as the current one. Skip
-										continue;
-									}
-
-									auto adjustedOffsetDistance = i == 0 && !stop.Station->GetStation()->IsOrientationReversed()
-									                              || i == 1 && stop.Station->GetStation()->IsOrientationReversed()
-										                              ? offsetDistance
-										                              : -offsetDistance;
-
-									if (stationOffsets.find(adjustedOffsetDistance) == stationOffsets.end())
-									{
-										// Not on a valid offset. Skip
-										continue;
-									}
-
-									seenActors.Add(stopCargo);
-
-									components.Append(
-										stopCargo->GetConnectionComponents().FilterByPredicate(
-											[&components, stopCargo](UFGFactoryConnectionComponent* connection)
-											{
-												return !components.Contains(connection) &&
-													(stopCargo->GetIsInLoadMode() || connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT);
-											}
-											)
-										);
-								}
-							}
-						}
-					}
-				}
+		return true;
+	}
 
-				if (storageTeleporter)
-				{
-					// Find all others of the same type
-					auto currentStorageID = FReflectionHelper::GetPropertyValue<UStrProperty>(storageTeleporter, TEXT("StorageID"));
-
-					// TArray<AActor*> allTeleporters;
-					// if (IsInGameThread())
-					// {
-					//     UGameplayStatics::GetAllActorsOfClass(storageTeleporter->GetWorld(), storageTeleporter->GetClass(), allTeleporters);
-					// }
-
-					FScopeLock ScopeLock(&singleton->eclCritical);
-
-					for (auto testTeleporter : AEfficiencyCheckerLogic::singleton->allTeleporters)
-					{
-						if (testTeleporter->IsPendingKill() || testTeleporter == storageTeleporter)
-						{
-							continue;
-						}
-
-						auto storageID = FReflectionHelper::GetPropertyValue<UStrProperty>(testTeleporter, TEXT("StorageID"));
-						if (storageID == currentStorageID)
-						{
-							seenActors.Add(testTeleporter);
-
-							auto factory = Cast<AFGBuildableFactory>(testTeleporter);
-							if (factory)
-							{
-								components.Append(
-									factory->GetConnectionComponents().FilterByPredicate(
-										[&components](UFGFactoryConnectionComponent* connection)
-										{
-											return !components.Contains(connection); // Not in use already
-										}
-										)
-									);
-							}
-						}
-					}
-				}
+	return false;
+}
 
-				int currentOutputIndex = -1;
-				std::map<int, TSet<TSubclassOf<UFGItemDescriptor>>> restrictedItemsByOutput;
+void AEfficiencyCheckerLogic::addEfficiencyBuilding(class AEfficiencyCheckerBuilding* checker)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allEfficiencyBuildings.Add(checker);
 
-				// Filter items
-				auto smartSplitter = Cast<AFGBuildableSplitterSmart>(buildable);
-				if (smartSplitter)
-				{
-					for (int connectorIndex = 0; connectorIndex < components.Num(); connectorIndex++)
-					{
-						auto connection = components[connectorIndex];
-
-						if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
-						{
-							continue;
-						}
-
-						if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
-						{
-							continue;
-						}
-
-						auto outputIndex = connection->GetName()[connection->GetName().Len() - 1] - '1';
-
-						if (connection == connector)
-						{
-							currentOutputIndex = outputIndex;
-						}
-					}
-
-					// Already restricted. Restrict further
-					for (int x = 0; x < smartSplitter->GetNumSortRules(); ++x)
-					{
-						auto rule = smartSplitter->GetSortRuleAt(x);
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Rule "),
-								x,
-								TEXT(" / output index = "),
-								rule.OutputIndex,
-								TEXT(" / item = "),
-								*UFGItemDescriptor::GetItemName(rule.ItemClass).ToString(),
-								TEXT(" / class = "),
-								*GetPathNameSafe(rule.ItemClass)
-								);
-						}
-
-						restrictedItemsByOutput[rule.OutputIndex].Add(rule.ItemClass);
-					}
-
-					TSet<TSubclassOf<UFGItemDescriptor>> definedItems;
-
-					// First pass
-					for (auto it = restrictedItemsByOutput.begin(); it != restrictedItemsByOutput.end(); ++it)
-					{
-						if (singleton->noneItemDescriptors.Intersect(it->second).Num())
-						{
-							// No item is valid. Empty it all
-							it->second.Empty();
-						}
-						else if (singleton->wildCardItemDescriptors.Intersect(it->second).Num() || singleton->overflowItemDescriptors.Intersect(it->second).Num())
-						{
-							// Add all current restrictItems as valid items
-							it->second = restrictItems;
-						}
-
-						for (auto item : it->second)
-						{
-							definedItems.Add(item);
-						}
-					}
-
-					for (auto it = restrictedItemsByOutput.begin(); it != restrictedItemsByOutput.end(); ++it)
-					{
-						if (singleton->anyUndefinedItemDescriptors.Intersect(it->second).Num())
-						{
-							it->second = it->second.Union(restrictItems.Difference(definedItems));
-						}
-
-						if (it->first == currentOutputIndex && !it->second.Num())
-						{
-							// Can't go further. Return
-							return;
-						}
-					}
-				}
+	checker->OnEndPlay.Add(removeEffiencyBuildingDelegate);
+}
 
-				TArray<UFGFactoryConnectionComponent*> connectedInputs, connectedOutputs;
-				for (auto connection : components)
-				{
-					if (!connection->IsConnected())
-					{
-						continue;
-					}
-
-					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
-					{
-						continue;
-					}
-
-					if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT)
-					{
-						connectedInputs.Add(connection);
-					}
-					else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
-					{
-						connectedOutputs.Add(connection);
-					}
-				}
+void AEfficiencyCheckerLogic::removeEfficiencyBuilding(AActor* actor, EEndPlayReason::Type reason)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allEfficiencyBuildings.Remove(Cast<AEfficiencyCheckerBuilding>(actor));
 
-				if (connectedInputs.Num() == 1 && connectedOutputs.Num() == 1)
-				{
-					connected.Add(buildable);
+	cancelUpdate(Cast<AEfficiencyCheckerBuilding>(actor));
 
-					connector = connectedInputs[0]->GetConnection();
+	actor->OnEndPlay.Remove(removeEffiencyBuildingDelegate);
+}
 
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
-					}
+void AEfficiencyCheckerLogic::addBelt(AFGBuildableConveyorBelt* belt)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allBelts.Add(belt);
 
-					if (smartSplitter)
-					{
-						auto outputIndex = connectedOutputs[0]->GetName()[connectedOutputs[0]->GetName().Len() - 1] - '1';
+	// The spline can bend outside of the box of its connectors, so the meshes are taken as well
+	auto bounds = belt->GetComponentsBoundingBox(true);
+	bounds += belt->GetConnection0()->GetConnectorLocation();
+	bounds += belt->GetConnection1()->GetConnectorLocation();
 
-						restrictItems = restrictedItemsByOutput[outputIndex];
-					}
+	beltGrid.Add(belt, bounds.ExpandBy(50));
 
-					continue;
-				}
+	belt->OnEndPlay.Add(removeBeltDelegate);
+}
 
-				if (connectedInputs.Num() == 0)
-				{
-					// Nothing is being inputed. Bail
-					SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" has no input"));
-				}
-				else
-				{
-					bool firstConnection = true;
-					float limitedThroughput = 0;
-
-					for (auto connection : components)
-					{
-						if (!connection->IsConnected())
-						{
-							continue;
-						}
-
-						if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
-						{
-							continue;
-						}
-
-						if (connection->GetDirection() != EFactoryConnectionDirection::FCD_INPUT)
-						{
-							continue;
-						}
-
-						if (dockingStation && connection->GetName().Equals(TEXT("Input0"), ESearchCase::IgnoreCase))
-						{
-							continue;
-						}
-
-						float previousLimit = out_limitedThroughput;
-						collectInput(
-							resourceForm,
-							customInjectedInput,
-							connection->GetConnection(),
-							out_injectedInput,
-							previousLimit,
-							seenActors,
-							connected,
-							out_injectedItems,
-							currentOutputIndex < 0 ? restrictItems : restrictedItemsByOutput[currentOutputIndex],
-							buildableSubsystem,
-							level + 1,
-							overflow,
-							indent + TEXT("    ")
-							);
-
-						if (firstConnection)
-						{
-							limitedThroughput = previousLimit;
-							firstConnection = false;
-						}
-						else
-						{
-							limitedThroughput += previousLimit;
-						}
-					}
-
-					out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
-
-					for (int connectorIndex = 0; connectorIndex < components.Num(); connectorIndex++)
-					{
-						auto connection = components[connectorIndex];
-
-						if (connection == connector)
-						{
-							continue;
-						}
-
-						if (!connection->IsConnected())
-						{
-							continue;
-						}
-
-						if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
-						{
-							continue;
-						}
-
-						auto outputIndex = connection->GetName()[connection->GetName().Len() - 1] - '1';
-
-						float previousLimit = 0;
-						float discountedInput = 0;
-						std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>> seenActorsCopy;
-
-						auto tempInjectedItems = out_injectedItems;
-
-						if (currentOutputIndex >= 0)
-						{
-							tempInjectedItems = tempInjectedItems.Intersect(restrictedItemsByOutput[outputIndex]);
-						}
-
-						for (auto actor : seenActors)
-						{
-							seenActorsCopy[actor] = out_injectedItems;
-						}
-
-						collectOutput(
-							resourceForm,
-							connection->GetConnection(),
-							discountedInput,
-							previousLimit,
-							seenActorsCopy,
-							connected,
-							tempInjectedItems,
-							buildableSubsystem,
-							level + 1,
-							overflow,
-							indent + TEXT("    ")
-							);
-
-						if (discountedInput > 0)
-						{
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Discounting "), discountedInput, TEXT(" items/minute"));
-							}
-
-							if (!customInjectedInput)
-							{
-								out_injectedInput -= discountedInput;
-							}
-						}
-					}
-
-					if (dockingStation /*|| cargoPlatform*/)
-					{
-						out_injectedInput += out_limitedThroughput;
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
-					}
-				}
+void AEfficiencyCheckerLogic::removeBelt(AActor* actor, EEndPlayReason::Type reason)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allBelts.Remove(Cast<AFGBuildableConveyorBelt>(actor));
+	beltGrid.Remove(Cast<AFGBuildableConveyorBelt>(actor));
 
-				connected.Add(buildable);
+	actor->OnEndPlay.Remove(removeBeltDelegate);
+}
 
-				return;
-			}
-		}
+void AEfficiencyCheckerLogic::addPipe(AFGBuildablePipeline* pipe)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allPipes.Add(pipe);
 
-		if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-		{
-			auto pipeline = Cast<AFGBuildablePipeline>(owner);
-			// if (pipeline)
-			// {
-			//     // out_limitedThroughput = UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(pipeline->GetFlowLimit() * 60, 4);
-			//     // // out_limitedThroughput = pipeline->mFlowLimit * 60;
-			//     //
-			//     // //out_limitedThroughput = 300;
-			//     //
-			//     // auto components = pipeline->GetPipeConnections();
-			//     //
-			//     // for (auto connection : components)
-			//     // {
-			//     //     if (!connection->IsConnected() ||
-			//     //         connection->GetPipeConnection()->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER /*||
-			//     //     connection == connector*/)
-			//     //     {
-			//     //         continue;
-			//     //     }
-			//     //
-			//     //     float previousLimit = out_limitedThroughput;
-			//     //     collectInput(
-			//     //         resourceForm,
-			//     //         customInjectedInput,
-			//     //         connection->GetConnection(),
-			//     //         out_injectedInput,
-			//     //         previousLimit,
-			//     //         seenActors,
-			//     //         connected,
-			//     //         out_injectedItems,
-			//     //         restrictItems,
-			//     //         buildableSubsystem,
-			//     //         level + 1,
-			//     //         indent + TEXT("    ")
-			//     //         );
-			//     //
-			//     //     out_limitedThroughput = FMath::Min(out_limitedThroughput, previousLimit);
-			//     // }
-			//
-			//     auto flowLimit = getPipeSpeed(pipeline);
-			//
-			//     out_limitedThroughput = FMath::Min(out_limitedThroughput, flowLimit);
-			//
-			//     if (FEfficiencyCheckerModModule::dumpConnections)
-			//     {
-			//         SML::Logging::info(*getTimeStamp(), *indent, *pipeline->GetName(), TEXT(" flow limit = "), flowLimit, TEXT(" m³/minute"));
-			//         SML::Logging::info(*getTimeStamp(), *indent, *pipeline->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" m³/minute"));
-			//     }
-			//
-			//     connected.Add(pipeline);
-			//
-			//     // Get the opposing connector
-			//     connector = connector == pipeline->GetPipeConnection0()
-			//                     ? pipeline->GetPipeConnection1()->GetConnection()
-			//                     : pipeline->GetPipeConnection0()->GetConnection();
-			//
-			//     continue;
-			// }
-
-			auto fluidIntegrant = Cast<IFGFluidIntegrantInterface>(owner);
-			if (fluidIntegrant)
-			{
-				auto buildable = Cast<AFGBuildable>(owner);
+	const auto connection0Location = pipe->GetPipeConnection0()->GetConnectorLocation();
+	const auto connection1Location = pipe->GetPipeConnection1()->GetConnectorLocation();
 
-				auto components = fluidIntegrant->GetPipeConnections();
+	pipeGrid.Add(pipe, FBox(connection0Location, connection0Location));
+	pipeGrid.Add(pipe, FBox(connection1Location, connection1Location));
 
-				if (pipeline)
-				{
-					out_limitedThroughput = FMath::Min(out_limitedThroughput, getPipeSpeed(pipeline));
-				}
+	pipe->OnEndPlay.Add(removePipeDelegate);
+}
 
-				auto otherConnections = seenActors.Num() == 1
-					                        ? components
-					                        : components.FilterByPredicate(
-						                        [connector, seenActors](UFGPipeConnectionComponent* pipeConnection)
-						                        {
-							                        return
-								                        pipeConnection != connector && pipeConnection->IsConnected();
-						                        }
-						                        );
+void AEfficiencyCheckerLogic::removePipe(AActor* actor, EEndPlayReason::Type reason)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allPipes.Remove(Cast<AFGBuildablePipeline>(actor));
+	pipeGrid.Remove(Cast<AFGBuildablePipeline>(actor));
 
-				auto pipePump = Cast<AFGBuildablePipelinePump>(fluidIntegrant);
-				auto pipeConnection = Cast<UFGPipeConnectionComponent>(connector);
+	actor->OnEndPlay.Remove(removePipeDelegate);
+}
 
-				if (pipePump && pipePump->GetUserFlowLimit() > 0 && components.Num() == 2 && components[0]->IsConnected() && components[1]->IsConnected())
-				{
-					auto pipe0 = Cast<AFGBuildablePipeline>(components[0]->GetPipeConnection()->GetOwner());
-					auto pipe1 = Cast<AFGBuildablePipeline>(components[1]->GetPipeConnection()->GetOwner());
-
-					out_limitedThroughput = FMath::Min(
-                        out_limitedThroughput,
-                        UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(
-                            FMath::Min(getPipeSpeed(pipe0), getPipeSpeed(pipe1)) * pipePump->GetUserFlowLimit() / pipePump->GetDefaultFlowLimit(),
-                            4
-                            )
-                        );
-				}
+void AEfficiencyCheckerLogic::addTeleporter(AFGBuildable* teleporter)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allTeleporters.Add(teleporter);
+	indexTeleporter(teleporter);
 
-				if (otherConnections.Num() == 0)
-				{
-					// No more connections. Bail
-					SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" has no other connection"));
-				}
-				else if (otherConnections.Num() == 1 &&
-					(otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER &&
-						otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER ||
-						pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER &&
-						otherConnections[0]->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER))
-				{
-					connected.Add(buildable);
+	// Teleporters already sharing its StorageID are linked to it now
+	components.touchAll();
 
-					connector = otherConnections[0]->GetConnection();
+	teleporter->OnEndPlay.Add(removeTeleporterDelegate);
+}
 
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
-					}
+void AEfficiencyCheckerLogic::removeTeleporter(AActor* actor, EEndPlayReason::Type reason)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	allTeleporters.Remove(Cast<AFGBuildable>(actor));
+	unindexTeleporter(Cast<AFGBuildable>(actor));
 
-					continue;
-				}
-				else
-				{
-					bool firstConnection = true;
-					float limitedThroughput = 0;
-
-					bool firstActor = seenActors.Num() == 1;
-
-					for (auto connection : components)
-					{
-						if (connection == connector && !firstActor)
-						{
-							continue;
-						}
-
-						if (!connection->IsConnected())
-						{
-							continue;
-						}
-
-						if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
-						{
-							continue;
-						}
-
-						float previousLimit = out_limitedThroughput;
-						collectInput(
-							resourceForm,
-							customInjectedInput,
-							connection->GetConnection(),
-							out_injectedInput,
-							previousLimit,
-							seenActors,
-							connected,
-							out_injectedItems,
-							restrictItems,
-							buildableSubsystem,
-							level + 1,
-							overflow,
-							indent + TEXT("    ")
-							);
-
-						if (pipeline)
-						{
-							out_limitedThroughput = FMath::Min(out_limitedThroughput, previousLimit);
-						}
-						else if (firstConnection)
-						{
-							limitedThroughput = previousLimit;
-							firstConnection = false;
-						}
-						else
-						{
-							limitedThroughput += limitedThroughput;
-						}
-					}
-
-					if (!pipeline && !firstConnection)
-					{
-						out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
-					}
-
-					auto pipeConnector = Cast<UFGPipeConnectionComponent>(connector);
-
-					if (pipePump && pipeConnector->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
-					{
-						for (auto connection : components)
-						{
-							if (connection == connector)
-							{
-								continue;
-							}
-
-							if (!connection->IsConnected() || connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER)
-							{
-								continue;
-							}
-
-							float previousLimit = 0;
-							float discountedInput = 0;
-
-							std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>> seenActorsCopy;
-
-							for (auto actor : seenActors)
-							{
-								seenActorsCopy[actor] = out_injectedItems;
-							}
-
-							collectOutput(
-								resourceForm,
-								connection->GetConnection(),
-								discountedInput,
-								previousLimit,
-								seenActorsCopy,
-								connected,
-								out_injectedItems,
-								buildableSubsystem,
-								level + 1,
-								overflow,
-								indent + TEXT("    ")
-								);
-
-							if (discountedInput > 0)
-							{
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("Discounting "), discountedInput, TEXT(" m³/minute"));
-								}
-
-								if (!customInjectedInput)
-								{
-									out_injectedInput -= discountedInput;
-								}
-							}
-						}
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" m³/minute"));
-					}
-				}
+	actor->OnEndPlay.Remove(removeTeleporterDelegate);
+}
 
-				connected.Add(buildable);
+TArray<AFGBuildableTrainPlatformCargo*> AEfficiencyCheckerLogic::getLinkedCargoPlatforms
+(
+	AFGBuildableTrainPlatformCargo* cargoPlatform,
+	const FString& indent
+)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				return;
-			}
+	return railroadRoutes.getLinkedCargoPlatforms(cargoPlatform, indent);
+}
 
-			auto cargoPlatform = Cast<AFGBuildableTrainPlatformCargo>(owner);
-			if (cargoPlatform)
-			{
-				TArray<UFGPipeConnectionComponent*> pipeConnections;
-				cargoPlatform->GetComponents(pipeConnections);
+const FString* AEfficiencyCheckerLogic::getStorageID(AFGBuildable* teleporter)
+{
+	if (!storageIDProperty)
+	{
+		storageIDProperty = FindField<UStrProperty>(teleporter->GetClass(), TEXT("StorageID"));
+	}
 
-				auto trackId = cargoPlatform->GetTrackGraphID();
+	if (!storageIDProperty || !teleporter->GetClass()->IsChildOf(storageIDProperty->GetOwnerClass()))
+	{
+		return nullptr;
+	}
 
-				auto railroadSubsystem = AFGRailroadSubsystem::Get(owner->GetWorld());
+	return storageIDProperty->GetPropertyValuePtr_InContainer(teleporter);
+}
 
-				// Determine offsets from all the connected stations
-				std::set<int> stationOffsets;
-				TSet<AFGBuildableRailroadStation*> destinationStations;
+bool AEfficiencyCheckerLogic::indexTeleporter(AFGBuildable* teleporter)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				for (auto i = 0; i <= 1; i++)
-				{
-					auto offsetDistance = 1;
-
-					for (auto connectedPlatform = cargoPlatform->GetConnectedPlatformInDirectionOf(i);
-					     connectedPlatform;
-					     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-					     ++offsetDistance)
-					{
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								*connectedPlatform->GetName(),
-								TEXT(" direction = "),
-								i,
-								TEXT(" / orientation reversed = "),
-								connectedPlatform->IsOrientationReversed() ? TEXT("true") : TEXT("false")
-								);
-						}
-
-						auto station = Cast<AFGBuildableRailroadStation>(connectedPlatform);
-						if (station)
-						{
-							destinationStations.Add(station);
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Station = "),
-									*station->GetStationIdentifier()->GetStationName().ToString()
-									);
-							}
-
-							if (i == 0 && connectedPlatform->IsOrientationReversed() ||
-								i == 1 && !connectedPlatform->IsOrientationReversed())
-							{
-								stationOffsets.insert(offsetDistance);
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), offsetDistance);
-								}
-							}
-							else
-							{
-								stationOffsets.insert(-offsetDistance);
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), -offsetDistance);
-								}
-							}
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							auto cargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-							if (cargo)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Load mode = "),
-									cargo->GetIsInLoadMode() ? TEXT("true") : TEXT("false")
-									);
-							}
-						}
-					}
-				}
+	const auto storageID = teleporter ? getStorageID(teleporter) : nullptr;
+	if (!storageID)
+	{
+		return false;
+	}
 
-				TArray<AFGTrain*> trains;
-				railroadSubsystem->GetTrains(trackId, trains);
+	const auto indexedStorageID = teleporterStorageIDs.Find(teleporter);
+	if (indexedStorageID && *indexedStorageID == *storageID)
+	{
+		return false;
+	}
 
-				for (auto train : trains)
-				{
-					if (!train->HasTimeTable())
-					{
-						continue;
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						if (!train->GetTrainName().IsEmpty())
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Train = "),
-								*train->GetTrainName().ToString()
-								);
-						}
-						else
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Anonymous Train")
-								);
-						}
-					}
-
-					// Get train stations
-					auto timeTable = train->GetTimeTable();
-
-					TArray<FTimeTableStop> stops;
-					timeTable->GetStops(stops);
-
-					bool stopAtStations = false;
-
-					for (auto stop : stops)
-					{
-						if (!stop.Station || !stop.Station->GetStation() || !destinationStations.Contains(stop.Station->GetStation()))
-						{
-							continue;
-						}
-
-						stopAtStations = true;
-
-						break;
-					}
-
-					if (!stopAtStations)
-					{
-						continue;
-					}
-
-					for (auto stop : stops)
-					{
-						if (!stop.Station || !stop.Station->GetStation())
-						{
-							continue;
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("    Stop = "),
-								*stop.Station->GetStationName().ToString()
-								);
-						}
-
-						for (auto i = 0; i <= 1; i++)
-						{
-							auto offsetDistance = 1;
-
-							for (auto connectedPlatform = stop.Station->GetStation()->GetConnectedPlatformInDirectionOf(i);
-							     connectedPlatform;
-							     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-							     ++offsetDistance)
-							{
-								auto stopCargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-								if (!stopCargo || stopCargo == cargoPlatform)
-								{
-									// Not a cargo or the same as the current one. Skip
-									continue;
-								}
-
-								auto adjustedOffsetDistance = i == 0 && !stop.Station->GetStation()->IsOrientationReversed()
-								                              || i == 1 && stop.Station->GetStation()->IsOrientationReversed()
-									                              ? offsetDistance
-									                              : -offsetDistance;
-
-								if (stationOffsets.find(adjustedOffsetDistance) == stationOffsets.end())
-								{
-									// Not on a valid offset. Skip
-									continue;
-								}
-
-								seenActors.Add(stopCargo);
-
-								TArray<UFGPipeConnectionComponent*> cargoPipeConnections;
-								stopCargo->GetComponents(cargoPipeConnections);
-
-								pipeConnections.Append(
-									cargoPipeConnections.FilterByPredicate(
-										[&pipeConnections, stopCargo](UFGPipeConnectionComponent* connection)
-										{
-											if (pipeConnections.Contains(connection))
-											{
-												// Already in use
-												return false;
-											}
-
-											if (stopCargo->GetIsInLoadMode())
-											{
-												// Loading
-												return true;
-											}
-
-											if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
-											{
-												// Is not a consumer connection
-												return true;
-											}
-
-											return false;
-										}
-										)
-									);
-							}
-						}
-					}
-				}
+	const auto moved = indexedStorageID != nullptr;
 
-				bool firstConnection = true;
-				float limitedThroughput = out_limitedThroughput;
+	unindexTeleporter(teleporter);
 
-				for (auto connection : pipeConnections)
-				{
-					if (!connection->IsConnected() ||
-						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER ||
-						connection == connector)
-					{
-						continue;
-					}
-
-					float previousLimit = out_limitedThroughput;
-					collectInput(
-						resourceForm,
-						customInjectedInput,
-						connection->GetConnection(),
-						out_injectedInput,
-						previousLimit,
-						seenActors,
-						connected,
-						out_injectedItems,
-						restrictItems,
-						buildableSubsystem,
-						level + 1,
-						overflow,
-						indent + TEXT("    ")
-						);
-
-					if (firstConnection)
-					{
-						limitedThroughput = previousLimit;
-						firstConnection = false;
-					}
-					else
-					{
-						limitedThroughput += previousLimit;
-					}
-				}
+	teleporterStorageIDs.Add(teleporter, *storageID);
+	teleportersByStorageID.FindOrAdd(*storageID).Add(teleporter);
 
-				out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
+	if (moved)
+	{
+		// Now linked to other teleporters
+		components.touchAll();
+	}
 
-				for (auto connection : pipeConnections)
-				{
-					if (connection == connector ||
-						!connection->IsConnected() ||
-						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
-					{
-						continue;
-					}
-
-					float previousLimit = 0;
-					float discountedInput = 0;
-
-					std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>> seenActorsCopy;
-
-					for (auto actor : seenActors)
-					{
-						seenActorsCopy[actor] = out_injectedItems;
-					}
-
-					collectOutput(
-						resourceForm,
-						connection->GetConnection(),
-						discountedInput,
-						previousLimit,
-						seenActorsCopy,
-						connected,
-						out_injectedItems,
-						buildableSubsystem,
-						level + 1,
-						overflow,
-						indent + TEXT("    ")
-						);
-
-					if (discountedInput > 0)
-					{
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Discounting "), discountedInput, TEXT(" m³/minute"));
-						}
-
-						if (!customInjectedInput)
-						{
-							out_injectedInput -= discountedInput;
-						}
-					}
-				}
+	return moved;
+}
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" m³/minute"));
-				}
+void AEfficiencyCheckerLogic::pollStorageIDs()
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				connected.Add(Cast<AFGBuildable>(fluidIntegrant));
+	TArray<AFGBuildable*> movedTeleporters;
 
-				return;
-			}
+	for (auto teleporter : allTeleporters)
+	{
+		if (indexTeleporter(teleporter))
+		{
+			movedTeleporters.Add(teleporter);
 		}
+	}
 
-		{
-			const auto nuclearGenerator = Cast<AFGBuildableGeneratorNuclear>(owner);
-			if (nuclearGenerator)
-			{
-				for (auto item : singleton->nuclearWasteItemDescriptors)
-				{
-					out_injectedItems.Add(item);
-				}
+	if (!FEfficiencyCheckerModModule::autoUpdate)
+	{
+		// Read again on a manual refresh
+		return;
+	}
 
-				connected.Add(nuclearGenerator);
+	TSet<AEfficiencyCheckerBuilding*> checkers;
 
-				out_injectedInput += 0.2;
+	for (auto teleporter : movedTeleporters)
+	{
+		checkers.Append(getDependentCheckers(teleporter));
+		flowField.invalidateStructure(teleporter);
+		invalidateSubWalks(teleporter, true);
 
-				return;
-			}
+		for (auto linkedTeleporter : getLinkedTeleporters(teleporter))
+		{
+			checkers.Append(getDependentCheckers(linkedTeleporter));
+			flowField.invalidateStructure(linkedTeleporter);
+			invalidateSubWalks(linkedTeleporter, true);
 		}
+	}
 
-		if (inheritsFrom(owner, TEXT("/Script/FactoryGame.FGBuildableFactorySimpleProducer")))
+	for (auto checker : checkers)
+	{
+		if (checker->HasAuthority())
 		{
-			TSubclassOf<UFGItemDescriptor> itemType = FReflectionHelper::GetObjectPropertyValue<UClass>(owner, TEXT("mItemType"));
-			auto timeToProduceItem = FReflectionHelper::GetPropertyValue<UFloatProperty>(owner, TEXT("mTimeToProduceItem"));
+			requestUpdate(checker);
+		}
+	}
+}
 
-			if (timeToProduceItem && itemType)
-			{
-				out_injectedItems.Add(itemType);
+void AEfficiencyCheckerLogic::unindexTeleporter(AFGBuildable* teleporter)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				out_injectedInput += 60 / timeToProduceItem;
-			}
+	FString storageID;
+	if (!teleporterStorageIDs.RemoveAndCopyValue(teleporter, storageID))
+	{
+		return;
+	}
 
-			connected.Add(Cast<AFGBuildable>(owner));
+	auto teleporters = teleportersByStorageID.Find(storageID);
+	if (teleporters)
+	{
+		teleporters->RemoveSwap(teleporter);
 
-			return;
+		if (!teleporters->Num())
+		{
+			teleportersByStorageID.Remove(storageID);
 		}
+	}
+}
 
-		// out_limitedThroughput = 0;
+TArray<AFGBuildable*> AEfficiencyCheckerLogic::getLinkedTeleporters(AFGBuildable* teleporter)
+{
+	TArray<AFGBuildable*> linkedTeleporters;
 
-		if (FEfficiencyCheckerModModule::dumpConnections)
+	FScopeLock ScopeLock(&eclCritical);
+
+	// Its own id is read now, in case it changed since the last poll
+	indexTeleporter(teleporter);
+
+	const auto storageID = teleporterStorageIDs.Find(teleporter);
+	const auto teleporters = storageID ? teleportersByStorageID.Find(*storageID) : nullptr;
+
+	if (teleporters)
+	{
+		for (auto testTeleporter : *teleporters)
 		{
-			dumpUnknownClass(indent, owner);
+			if (!testTeleporter->IsPendingKill() && testTeleporter != teleporter)
+			{
+				linkedTeleporters.Add(testTeleporter);
+			}
 		}
+	}
+
+	return linkedTeleporters;
+}
+
+void AEfficiencyCheckerLogic::addBuildable(AFGBuildable* buildable)
+{
+	FScopeLock ScopeLock(&eclCritical);
+	if (graph.findNode(buildable) != INDEX_NONE)
+	{
+		return;
+	}
 
+	const auto nodeIndex = graph.addNode(buildable, getClassFlags(buildable->GetClass()));
+	if (nodeIndex == INDEX_NONE)
+	{
 		return;
 	}
+
+	components.addNode(graph, nodeIndex);
+	noteGraphChange(nodeIndex);
+	pipeNetworks.invalidateNode(graph, nodeIndex);
+	chains.invalidate(graph, buildable);
+	flowField.invalidateStructure(buildable);
+	invalidateSubWalks(buildable, true);
+
+	if (Cast<AFGBuildableTrainPlatform>(buildable))
+	{
+		railroadRoutes.invalidatePlatforms();
+
+		// Platforms already walked can be linked to it by the trains, with no connection between them
+		components.touchAll();
+	}
+	else if (EnumHasAnyFlags(graph.getNode(nodeIndex)->classFlags, EEfficiencyCheckerClassFlags::DockingStation))
+	{
+		// Same for the stations linked to it by the vehicles
+		components.touchAll();
+	}
+
+	buildable->OnEndPlay.Add(removeBuildableDelegate);
 }
 
-void AEfficiencyCheckerLogic::collectOutput
-(
-	EResourceForm resourceForm,
-	class UFGConnectionComponent* connector,
-	float& out_requiredOutput,
-	float& out_limitedThroughput,
-	std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors,
-	TSet<AFGBuildable*>& connected,
-	const TSet<TSubclassOf<UFGItemDescriptor>>& in_injectedItems,
-	class AFGBuildableSubsystem* buildableSubsystem,
-	int level,
-	bool& overflow,
-	const FString& indent
-)
+void AEfficiencyCheckerLogic::removeBuildable(AActor* actor, EEndPlayReason::Type reason)
 {
-	TSet<TSubclassOf<UFGItemDescriptor>> injectedItems = in_injectedItems;
+	FScopeLock ScopeLock(&eclCritical);
+	invalidateSubWalks(actor, true);
+	noteGraphChange(graph.findNode(actor));
+	components.removeNode(graph, graph.findNode(actor));
+	pipeNetworks.invalidateNode(graph, graph.findNode(actor));
+	chains.invalidate(graph, actor);
+	graph.removeNode(actor);
+	checkersByBuildable.Remove(Cast<AFGBuildable>(actor));
+	sortRules.Remove(actor);
+	flowField.invalidateStructure(actor);
+
+	if (Cast<AFGBuildableTrainPlatform>(actor))
+	{
+		railroadRoutes.invalidatePlatforms();
+	}
+
+	actor->OnEndPlay.Remove(removeBuildableDelegate);
+}
+
+void AEfficiencyCheckerLogic::noteGraphChange(int32 nodeIndex)
+{
+	const auto node = graph.getNode(nodeIndex);
+	if (!node)
+	{
+		return;
+	}
 
-	for (;;)
+	graphVersion++;
+
+	if (EnumHasAnyFlags(node->classFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment))
 	{
-		if (!connector)
+		conveyorVersion++;
+	}
+
+	if (!currentUpdate)
+	{
+		// Refreshes started from now on already see the change
+		return;
+	}
+
+	changedBuildables.Add(node->buildable);
+
+	for (auto connection : node->factoryConnections)
+	{
+		if (connection->IsConnected())
 		{
-			return;
+			changedBuildables.Add(Cast<AFGBuildable>(connection->GetConnection()->GetOwner()));
 		}
+	}
 
-		auto owner = connector->GetOwner();
-
-		if (!owner)
+	for (auto connection : node->pipeConnections)
+	{
+		if (connection->IsConnected())
 		{
-			return;
+			changedBuildables.Add(Cast<AFGBuildable>(connection->GetConnection()->GetOwner()));
 		}
+	}
+}
 
-		auto fullClassName = GetPathNameSafe(owner->GetClass());
+int32 AEfficiencyCheckerLogic::findNode(const AActor* actor)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-		if (level > 100)
-		{
-			SML::Logging::error(
-				*getTimeStamp(),
-				*indent,
-				TEXT("collectOutput: level is too deep: "),
-				level,
-				TEXT("; "),
-				*owner->GetName(),
-				TEXT(" / "),
-				*fullClassName
-				);
+	return graph.findNode(actor);
+}
 
-			overflow = true;
+int32 AEfficiencyCheckerLogic::findConnectionNode(const UFGConnectionComponent* connection)
+{
+	if (!connection)
+	{
+		return INDEX_NONE;
+	}
 
-			return;
-		}
+	FScopeLock ScopeLock(&eclCritical);
 
-		if (injectedItems.Num())
-		{
-			bool unusedItems = false;
+	const auto nodeIndex = graph.findConnectionNode(connection);
+	if (nodeIndex != INDEX_NONE)
+	{
+		return nodeIndex;
+	}
 
-			for (auto item : injectedItems)
-			{
-				if (!actorContainsItem(seenActors, owner, item))
-				{
-					unusedItems = true;
-					break;
-				}
-			}
+	return graph.findNode(connection->GetOwner());
+}
 
-			if (!unusedItems)
-			{
-				return;
-			}
-		}
-		else
-		{
-			if (containsActor(seenActors, owner))
-			{
-				return;
-			}
-		}
+void AEfficiencyCheckerLogic::indexBuildable(AFGBuildable* buildable)
+{
+	if (!buildable)
+	{
+		return;
+	}
 
-		if (FEfficiencyCheckerModModule::dumpConnections)
-		{
-			SML::Logging::info(
-				*getTimeStamp(),
-				*indent,
-				TEXT("collectOutput at level "),
-				level,
-				TEXT(": "),
-				*owner->GetName(),
-				TEXT(" / "),
-				*fullClassName
-				);
-		}
+	FScopeLock ScopeLock(&eclCritical);
+
+	if (graph.findNode(buildable) != INDEX_NONE || allEfficiencyBuildings.Contains(Cast<AEfficiencyCheckerBuilding>(buildable)))
+	{
+		return;
+	}
+
+	IsValidBuildable(buildable);
+}
+
+const TArray<UFGFactoryConnectionComponent*>& AEfficiencyCheckerLogic::getFactoryConnections
+(
+	AFGBuildableFactory* buildable,
+	TArray<UFGFactoryConnectionComponent*>& out_unindexed
+)
+{
+	const auto node = singleton->getNode(singleton->findNode(buildable));
+	if (node)
+	{
+		return node->factoryConnections;
+	}
+
+	out_unindexed = buildable->GetConnectionComponents();
+
+	return out_unindexed;
+}
+
+const TArray<UFGPipeConnectionComponent*>& AEfficiencyCheckerLogic::getPipeConnections(AActor* actor, TArray<UFGPipeConnectionComponent*>& out_unindexed)
+{
+	const auto node = singleton->getNode(singleton->findNode(actor));
+	if (node)
+	{
+		return node->pipeConnections;
+	}
+
+	const auto fluidIntegrant = Cast<IFGFluidIntegrantInterface>(actor);
+	if (fluidIntegrant)
+	{
+		out_unindexed = fluidIntegrant->GetPipeConnections();
+	}
+	else
+	{
+		actor->GetComponents(out_unindexed);
+	}
+
+	return out_unindexed;
+}
+
+EEfficiencyCheckerClassFlags AEfficiencyCheckerLogic::getClassFlags(UClass* actorClass)
+{
+	if (!actorClass)
+	{
+		return EEfficiencyCheckerClassFlags::None;
+	}
+
+	FScopeLock ScopeLock(&eclCritical);
 
-		{
-			const auto manufacturer = Cast<AFGBuildableManufacturer>(owner);
-			if (manufacturer)
-			{
-				const auto recipeClass = manufacturer->GetCurrentRecipe();
+	const auto existingFlags = classFlags.Find(actorClass);
+	if (existingFlags)
+	{
+		return *existingFlags;
+	}
 
-				if (recipeClass)
-				{
-					auto ingredients = UFGRecipe::GetIngredients(recipeClass);
-
-					for (auto item : ingredients)
-					{
-						auto itemForm = UFGItemDescriptor::GetForm(item.ItemClass);
-
-						if (itemForm == EResourceForm::RF_SOLID && resourceForm != EResourceForm::RF_SOLID ||
-							(itemForm == EResourceForm::RF_LIQUID || itemForm == EResourceForm::RF_GAS) &&
-							resourceForm != EResourceForm::RF_LIQUID && resourceForm != EResourceForm::RF_GAS)
-						{
-							continue;
-						}
-
-						if (!injectedItems.Contains(item.ItemClass) || seenActors[manufacturer].Contains(item.ItemClass))
-						{
-							continue;
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Item amount = "), item.Amount);
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Current potential = "), manufacturer->GetCurrentPotential());
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Pending potential = "), manufacturer->GetPendingPotential());
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Production cycle time = "),
-								manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential())
-								);
-							SML::Logging::info(*getTimeStamp(), *indent, TEXT("Recipe duration = "), UFGRecipe::GetManufacturingDuration(recipeClass));
-						}
-
-						float itemAmountPerMinute = item.Amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
-
-						if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-						{
-							itemAmountPerMinute /= 1000;
-						}
-
-						// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
-						// {
-						//     if (fullClassName.EndsWith(TEXT("MK2_C")))
-						//     {
-						//         itemAmountPerMinute *= 1.5;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
-						//     {
-						//         itemAmountPerMinute *= 2;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
-						//     {
-						//         itemAmountPerMinute *= 2.5;
-						//     }
-						// }
-						// else if (fullClassName.StartsWith(TEXT("/Game/FarmingMod/Buildable")))
-						// {
-						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
-						//     {
-						//         itemAmountPerMinute *= 2;
-						//     }
-						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
-						//     {
-						//         itemAmountPerMinute *= 3;
-						//     }
-						// }
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								*manufacturer->GetName(),
-								TEXT(" consumes "),
-								itemAmountPerMinute,
-								TEXT(" "),
-								*UFGItemDescriptor::GetItemName(item.ItemClass).ToString(),
-								TEXT("/minute")
-								);
-						}
-
-						out_requiredOutput += itemAmountPerMinute;
-
-						seenActors[manufacturer].Add(item.ItemClass);
-					}
-				}
+	return classFlags.Add(actorClass, resolveClassFlags(actorClass));
+}
 
-				connected.Add(manufacturer);
+EEfficiencyCheckerClassFlags AEfficiencyCheckerLogic::resolveClassFlags(UClass* actorClass)
+{
+	auto flags = EEfficiencyCheckerClassFlags::None;
 
-				return;
-			}
-		}
+	const auto fullClassName = GetPathNameSafe(actorClass);
 
-		if (resourceForm == EResourceForm::RF_SOLID)
-		{
-			const auto conveyor = Cast<AFGBuildableConveyorBase>(owner);
-			if (conveyor)
-			{
-				addAllItemsToActor(seenActors, conveyor, injectedItems);
-
-				// // The innitial limit for a belt is its own speed
-				// out_limitedThroughput = conveyor->GetSpeed() / 2;
-				//
-				// const auto conveyorInput = conveyor->GetConnection1();
-				// if (conveyorInput && conveyorInput->IsConnected())
-				// {
-				//     float previousLimit = out_limitedThroughput;
-				//     collectOutput(
-				//         resourceForm,
-				//         conveyorInput->GetConnection(),
-				//         out_requiredOutput,
-				//         previousLimit,
-				//         seenActors,
-				//         connected,
-				//         injectedItems,
-				//         buildableSubsystem,
-				//         level + 1,
-				//         indent + TEXT("    ")
-				//         );
-				//
-				//     out_limitedThroughput = FMath::Min(out_limitedThroughput, previousLimit);
-				// }
-
-				connected.Add(conveyor);
-
-				connector = conveyor->GetConnection1()->GetConnection();
-
-				out_limitedThroughput = FMath::Min(out_limitedThroughput, conveyor->GetSpeed() / 2);
+	if (actorClass->IsChildOf(AFGBuildableManufacturer::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::Manufacturer;
+	}
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, *conveyor->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
-				}
+	if (actorClass->IsChildOf(AFGBuildableResourceExtractor::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::ResourceExtractor;
 
-				continue;
-			}
+		if (fullClassName == TEXT("/Game/Miner_Mk4/Build_MinerMk4.Build_MinerMk4_C"))
+		{
+			flags |= EEfficiencyCheckerClassFlags::MinerMk4;
+		}
+	}
 
-			AFGBuildableStorage* storageContainer = nullptr;
-			AFGBuildableTrainPlatformCargo* cargoPlatform = nullptr;
-			AFGBuildableConveyorAttachment* conveyorAttachment = nullptr;
-			AFGBuildableDockingStation* dockingStation = nullptr;
-			AFGBuildableFactory* storageTeleporter = nullptr;
+	if (actorClass->IsChildOf(AFGBuildableConveyorBase::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::ConveyorBase;
+	}
 
-			AFGBuildableFactory* buildable = Cast<AFGBuildableConveyorAttachment>(owner);
-			if (!buildable)
-			{
-				buildable = storageContainer = Cast<AFGBuildableStorage>(owner);
-			}
+	if (actorClass->IsChildOf(AFGBuildableConveyorAttachment::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::ConveyorAttachment;
+	}
 
-			if (!buildable)
-			{
-				buildable = cargoPlatform = Cast<AFGBuildableTrainPlatformCargo>(owner);
-			}
+	if (actorClass->IsChildOf(AFGBuildableSplitterSmart::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::SplitterSmart;
+	}
 
-			if (!buildable)
-			{
-				buildable = dockingStation = Cast<AFGBuildableDockingStation>(owner);
-			}
+	if (actorClass->IsChildOf(AFGBuildableStorage::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::Storage;
+	}
 
-			if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
-				!buildable && fullClassName == TEXT("/Game/StorageTeleporter/Buildables/ItemTeleporter/ItemTeleporter_Build.ItemTeleporter_Build_C"))
-			{
-				buildable = storageTeleporter = Cast<AFGBuildableFactory>(owner);
-			}
+	if (actorClass->IsChildOf(AFGBuildableTrainPlatformCargo::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::TrainPlatformCargo;
+	}
 
-			if (buildable)
-			{
-				addAllItemsToActor(seenActors, buildable, injectedItems);
+	if (actorClass->IsChildOf(AFGBuildableDockingStation::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::DockingStation;
+	}
 
-				auto components = buildable->GetConnectionComponents();
+	if (actorClass->IsChildOf(AFGBuildableFactory::StaticClass()) &&
+		fullClassName == TEXT("/Game/StorageTeleporter/Buildables/ItemTeleporter/ItemTeleporter_Build.ItemTeleporter_Build_C"))
+	{
+		flags |= EEfficiencyCheckerClassFlags::StorageTeleporter;
+	}
 
-				if (cargoPlatform)
-				{
-					auto trackId = cargoPlatform->GetTrackGraphID();
-
-					auto railroadSubsystem = AFGRailroadSubsystem::Get(owner->GetWorld());
-
-					// Determine offsets from all the connected stations
-					std::set<int> stationOffsets;
-					TSet<AFGBuildableRailroadStation*> destinationStations;
-
-					for (auto i = 0; i <= 1; i++)
-					{
-						auto offsetDistance = 1;
-
-						for (auto connectedPlatform = cargoPlatform->GetConnectedPlatformInDirectionOf(i);
-						     connectedPlatform;
-						     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-						     ++offsetDistance)
-						{
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									*connectedPlatform->GetName(),
-									TEXT(" direction = "),
-									i,
-									TEXT(" / orientation reversed = "),
-									connectedPlatform->IsOrientationReversed() ? TEXT("true") : TEXT("false")
-									);
-							}
-
-							auto station = Cast<AFGBuildableRailroadStation>(connectedPlatform);
-							if (station)
-							{
-								destinationStations.Add(station);
-
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(
-										*getTimeStamp(),
-										*indent,
-										TEXT("    Station = "),
-										*station->GetStationIdentifier()->GetStationName().ToString()
-										);
-								}
-
-								if (i == 0 && connectedPlatform->IsOrientationReversed() ||
-									i == 1 && !connectedPlatform->IsOrientationReversed())
-								{
-									stationOffsets.insert(offsetDistance);
-									if (FEfficiencyCheckerModModule::dumpConnections)
-									{
-										SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), offsetDistance);
-									}
-								}
-								else
-								{
-									stationOffsets.insert(-offsetDistance);
-									if (FEfficiencyCheckerModModule::dumpConnections)
-									{
-										SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), -offsetDistance);
-									}
-								}
-							}
-
-							auto cargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-							if (cargo)
-							{
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(
-										*getTimeStamp(),
-										*indent,
-										TEXT("    Load mode = "),
-										cargo->GetIsInLoadMode() ? TEXT("true") : TEXT("false")
-										);
-								}
-							}
-						}
-					}
-
-					TArray<AFGTrain*> trains;
-					railroadSubsystem->GetTrains(trackId, trains);
-
-					for (auto train : trains)
-					{
-						if (!train->HasTimeTable())
-						{
-							continue;
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							if (!train->GetTrainName().IsEmpty())
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("Train = "),
-									*train->GetTrainName().ToString()
-									);
-							}
-							else
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("Anonymous Train")
-									);
-							}
-						}
-
-						// Get train stations
-						auto timeTable = train->GetTimeTable();
-
-						TArray<FTimeTableStop> stops;
-						timeTable->GetStops(stops);
-
-						bool stopAtStations = false;
-
-						for (auto stop : stops)
-						{
-							if (!stop.Station || !stop.Station->GetStation() || !destinationStations.Contains(stop.Station->GetStation()))
-							{
-								continue;
-							}
-
-							stopAtStations = true;
-
-							break;
-						}
-
-						if (!stopAtStations)
-						{
-							continue;
-						}
-
-						for (auto stop : stops)
-						{
-							if (!stop.Station || !stop.Station->GetStation())
-							{
-								continue;
-							}
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Stop = "),
-									*stop.Station->GetStationName().ToString()
-									);
-							}
-
-							for (auto i = 0; i <= 1; i++)
-							{
-								auto offsetDistance = 1;
-
-								for (auto connectedPlatform = stop.Station->GetStation()->GetConnectedPlatformInDirectionOf(i);
-								     connectedPlatform;
-								     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-								     ++offsetDistance)
-								{
-									auto stopCargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-									if (!stopCargo || stopCargo == cargoPlatform)
-									{
-										// Not a cargo or the same as the current one. Skip
-										continue;
-									}
-
-									auto adjustedOffsetDistance = i == 0 && !stop.Station->GetStation()->IsOrientationReversed()
-									                              || i == 1 && stop.Station->GetStation()->IsOrientationReversed()
-										                              ? offsetDistance
-										                              : -offsetDistance;
-
-									if (stationOffsets.find(adjustedOffsetDistance) == stationOffsets.end())
-									{
-										// Not on a valid offset. Skip
-										continue;
-									}
-
-									addAllItemsToActor(seenActors, stopCargo, injectedItems);
-
-									components.Append(
-										stopCargo->GetConnectionComponents().FilterByPredicate(
-											[&components, stopCargo](UFGFactoryConnectionComponent* connection)
-											{
-												return !components.Contains(connection) && // Not in use already
-													!stopCargo->GetIsInLoadMode() && // Unload mode
-													connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT; // Is output connection
-											}
-											)
-										);
-								}
-							}
-						}
-					}
-				}
+	if (actorClass->ImplementsInterface(UFGFluidIntegrantInterface::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::FluidIntegrant;
+	}
 
-				if (storageTeleporter)
-				{
-					auto currentStorageID = FReflectionHelper::GetPropertyValue<UStrProperty>(storageTeleporter, TEXT("StorageID"));
-
-					// TArray<AActor*> allTeleporters;
-					// if (IsInGameThread())
-					// {
-					//     UGameplayStatics::GetAllActorsOfClass(storageTeleporter->GetWorld(), storageTeleporter->GetClass(), allTeleporters);
-					// }
-
-					FScopeLock ScopeLock(&singleton->eclCritical);
-
-					for (auto testTeleporter : AEfficiencyCheckerLogic::singleton->allTeleporters)
-					{
-						if (testTeleporter == storageTeleporter)
-						{
-							continue;
-						}
-
-						auto storageID = FReflectionHelper::GetPropertyValue<UStrProperty>(testTeleporter, TEXT("StorageID"));
-						if (storageID == currentStorageID)
-						{
-							addAllItemsToActor(seenActors, testTeleporter, injectedItems);
-
-							auto factory = Cast<AFGBuildableFactory>(testTeleporter);
-							if (factory)
-							{
-								components.Append(
-									factory->GetConnectionComponents().FilterByPredicate(
-										[&components](UFGFactoryConnectionComponent* connection)
-										{
-											return !components.Contains(connection) && // Not in use already
-												connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT; // Is output connection
-										}
-										)
-									);
-							}
-						}
-					}
-				}
+	if (actorClass->IsChildOf(AFGBuildablePipeline::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::Pipeline;
+	}
 
-				std::map<int, TSet<TSubclassOf<UFGItemDescriptor>>> restrictedItemsByOutput;
+	if (actorClass->IsChildOf(AFGBuildablePipelinePump::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::PipelinePump;
+	}
 
-				// Filter items
-				auto smartSplitter = Cast<AFGBuildableSplitterSmart>(buildable);
-				if (smartSplitter)
-				{
-					for (int x = 0; x < smartSplitter->GetNumSortRules(); ++x)
-					{
-						auto rule = smartSplitter->GetSortRuleAt(x);
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Rule "),
-								x,
-								TEXT(" / output index = "),
-								rule.OutputIndex,
-								TEXT(" / item = "),
-								*UFGItemDescriptor::GetItemName(rule.ItemClass).ToString(),
-								TEXT(" / class = "),
-								*GetPathNameSafe(rule.ItemClass)
-								);
-						}
-
-						restrictedItemsByOutput[rule.OutputIndex].Add(rule.ItemClass);
-					}
-
-					TSet<TSubclassOf<UFGItemDescriptor>> definedItems;
-
-					for (auto it = restrictedItemsByOutput.begin(); it != restrictedItemsByOutput.end(); ++it)
-					{
-						if (singleton->noneItemDescriptors.Intersect(it->second).Num())
-						{
-							// No item is valid. Empty it all
-							it->second.Empty();
-						}
-						else if (singleton->wildCardItemDescriptors.Intersect(it->second).Num() || singleton->overflowItemDescriptors.Intersect(it->second).Num())
-						{
-							// Add all current restrictItems as valid items
-							it->second = injectedItems;
-						}
-
-						for (auto item : it->second)
-						{
-							definedItems.Add(item);
-						}
-					}
-
-					for (auto it = restrictedItemsByOutput.begin(); it != restrictedItemsByOutput.end(); ++it)
-					{
-						if (singleton->anyUndefinedItemDescriptors.Intersect(it->second).Num())
-						{
-							it->second = it->second.Union(injectedItems.Difference(definedItems));
-						}
-
-						it->second = it->second.Intersect(injectedItems);
-					}
-				}
+	if (actorClass->IsChildOf(AFGBuildableGeneratorFuel::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::GeneratorFuel;
+	}
 
+	if (actorClass->IsChildOf(AFGBuildableGeneratorNuclear::StaticClass()))
+	{
+		flags |= EEfficiencyCheckerClassFlags::GeneratorNuclear;
+	}
 
-				TArray<UFGFactoryConnectionComponent*> connectedInputs, connectedOutputs;
-				for (auto connection : components)
-				{
-					if (!connection->IsConnected())
-					{
-						continue;
-					}
-
-					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
-					{
-						continue;
-					}
-
-					if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT)
-					{
-						connectedInputs.Add(connection);
-					}
-					else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
-					{
-						connectedOutputs.Add(connection);
-					}
-				}
+	if (inheritsFrom(actorClass, TEXT("/Script/FactoryGame.FGBuildableFactorySimpleProducer")))
+	{
+		flags |= EEfficiencyCheckerClassFlags::SimpleProducer;
+	}
 
-				if (connectedInputs.Num() == 1 && connectedOutputs.Num() == 1)
-				{
-					connected.Add(buildable);
+	return flags;
+}
 
-					connector = connectedOutputs[0]->GetConnection();
+float AEfficiencyCheckerLogic::getPipeSpeed(AFGBuildablePipeline* pipe)
+{
+	if (!pipe)
+	{
+		return 0;
+	}
 
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
-					}
+	return UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(pipe->GetFlowLimit() * 60, 4);
+}
 
-					if (smartSplitter)
-					{
-						auto outputIndex = connectedOutputs[0]->GetName()[connectedOutputs[0]->GetName().Len() - 1] - '1';
+float AEfficiencyCheckerLogic::getPumpFlowLimit(AFGBuildablePipelinePump* pipePump)
+{
+	TArray<UFGPipeConnectionComponent*> unindexedComponents;
+	const auto& components = getPipeConnections(pipePump, unindexedComponents);
 
-						injectedItems = restrictedItemsByOutput[outputIndex];
-					}
+	if (pipePump->GetUserFlowLimit() <= 0 || components.Num() != 2 || !components[0]->IsConnected() || !components[1]->IsConnected())
+	{
+		return FLT_MAX;
+	}
 
-					continue;
-				}
+	auto pipe0 = Cast<AFGBuildablePipeline>(components[0]->GetPipeConnection()->GetOwner());
+	auto pipe1 = Cast<AFGBuildablePipeline>(components[1]->GetPipeConnection()->GetOwner());
 
-				if (connectedOutputs.Num() == 0)
-				{
-					// Nothing is being outputed. Bail
-					SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" has no input"));
-				}
-				else
-				{
-					if (!dockingStation || !connector->GetName().Equals(TEXT("Input0"), ESearchCase::IgnoreCase))
-					{
-						bool firstConnection = true;
-						float limitedThroughput = 0;
-
-						for (int connectorIndex = 0; connectorIndex < components.Num(); connectorIndex++)
-						{
-							auto connection = components[connectorIndex];
-
-							if (!connection->IsConnected())
-							{
-								continue;
-							}
-
-							if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
-							{
-								continue;
-							}
-
-							if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
-							{
-								continue;
-							}
-
-							auto outputIndex = connection->GetName()[connection->GetName().Len() - 1] - '1';
-
-							float previousLimit = out_limitedThroughput;
-							collectOutput(
-								resourceForm,
-								connection->GetConnection(),
-								out_requiredOutput,
-								previousLimit,
-								seenActors,
-								connected,
-								smartSplitter ? restrictedItemsByOutput[outputIndex] : injectedItems,
-								buildableSubsystem,
-								level + 1,
-								overflow,
-								indent + TEXT("    ")
-								);
-
-							if (firstConnection)
-							{
-								limitedThroughput = previousLimit;
-								firstConnection = false;
-							}
-							else
-							{
-								limitedThroughput += previousLimit;
-							}
-						}
-
-						out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
-
-						for (int connectorIndex = 0; connectorIndex < components.Num(); connectorIndex++)
-						{
-							auto connection = components[connectorIndex];
-
-							if (connection == connector)
-							{
-								continue;
-							}
-
-							if (!connection->IsConnected())
-							{
-								continue;
-							}
-
-							if (connection->GetDirection() != EFactoryConnectionDirection::FCD_INPUT)
-							{
-								continue;
-							}
-
-							auto inputIndex = connection->GetName()[connection->GetName().Len() - 1] - '1';
-
-							float previousLimit = 0;
-							float discountedOutput = 0;
-							TSet<AActor*> seenActorsCopy;
-
-							auto tempInjectedItems = injectedItems;
-
-							for (auto actor : seenActors)
-							{
-								seenActorsCopy.Add(actor.first);
-							}
-
-							collectInput(
-								resourceForm,
-								false,
-								connection->GetConnection(),
-								discountedOutput,
-								previousLimit,
-								seenActorsCopy,
-								connected,
-								tempInjectedItems,
-								tempInjectedItems,
-								buildableSubsystem,
-								level + 1,
-								overflow,
-								indent + TEXT("    ")
-								);
-
-							if (discountedOutput > 0)
-							{
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("Discounting "), discountedOutput, TEXT(" items/minute"));
-								}
-
-								out_requiredOutput -= discountedOutput;
-							}
-						}
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
-					}
-				}
+	return UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(
+		FMath::Min(getPipeSpeed(pipe0), getPipeSpeed(pipe1)) * pipePump->GetUserFlowLimit() / pipePump->GetDefaultFlowLimit(),
+		4
+		);
+}
 
-				connected.Add(buildable);
+void AEfficiencyCheckerLogic::requestUpdate(AEfficiencyCheckerBuilding* checker)
+{
+	{
+		FScopeLock ScopeLock(&eclCritical);
 
-				return;
-			}
+		if (pendingUpdatesSet.Contains(checker))
+		{
+			return;
 		}
 
-		if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-		{
-			auto pipeline = Cast<AFGBuildablePipeline>(owner);
+		pendingUpdatesSet.Add(checker);
+		pendingUpdates.Add(checker);
+	}
 
-			auto fluidIntegrant = Cast<IFGFluidIntegrantInterface>(owner);
-			if (fluidIntegrant)
-			{
-				auto buildable = Cast<AFGBuildable>(fluidIntegrant);
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyCheckerLogic: queued update of "), *checker->GetName());
+	}
 
-				addAllItemsToActor(seenActors, Cast<AFGBuildable>(fluidIntegrant), injectedItems);
+	SetActorTickEnabled(true);
+}
 
-				auto components = fluidIntegrant->GetPipeConnections();
+void AEfficiencyCheckerLogic::cancelUpdate(AEfficiencyCheckerBuilding* checker)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				if (pipeline)
-				{
-					out_limitedThroughput = FMath::Min(out_limitedThroughput, getPipeSpeed(pipeline));
-				}
+	// The queue entry is skipped when it is reached
+	pendingUpdatesSet.Remove(checker);
 
-				auto otherConnections = seenActors.size() == 1
-					                        ? components
-					                        : components.FilterByPredicate(
-						                        [connector, seenActors](UFGPipeConnectionComponent* pipeConnection)
-						                        {
-							                        return pipeConnection != connector && pipeConnection->IsConnected();
-						                        }
-						                        );
+	if (currentUpdate && currentUpdate->checker == checker)
+	{
+		currentUpdate.Reset();
+	}
+}
 
-				auto pipePump = Cast<AFGBuildablePipelinePump>(fluidIntegrant);
-				auto pipeConnection = Cast<UFGPipeConnectionComponent>(connector);
+bool AEfficiencyCheckerLogic::getFlowValues(const AActor* buildable, FEfficiencyCheckerFlowValues& out_values, TSet<AFGBuildable*>& out_connected)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				if (pipePump && pipePump->GetUserFlowLimit() > 0 && components.Num() == 2 && components[0]->IsConnected() && components[1]->IsConnected())
-				{
-					auto pipe0 = Cast<AFGBuildablePipeline>(components[0]->GetPipeConnection()->GetOwner());
-					auto pipe1 = Cast<AFGBuildablePipeline>(components[1]->GetPipeConnection()->GetOwner());
-
-					out_limitedThroughput = FMath::Min(
-						out_limitedThroughput,
-						UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(
-							FMath::Min(getPipeSpeed(pipe0), getPipeSpeed(pipe1)) * pipePump->GetUserFlowLimit() / pipePump->GetDefaultFlowLimit(),
-							4
-							)
-						);
-				}
+	if (flowField.isDirty())
+	{
+		const auto startTime = FPlatformTime::Seconds();
 
-				if (otherConnections.Num() == 0)
-				{
-					// No more connections. Bail
-					SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" has no other connection"));
-				}
-				else if (otherConnections.Num() == 1 &&
-					(otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER &&
-						otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER ||
-						pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER &&
-						otherConnections[0]->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER))
-				{
-					connected.Add(buildable);
+		flowField.update(this, graph);
 
-					connector = otherConnections[0]->GetConnection();
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			SML::Logging::info(
+				*getTimeStamp(),
+				TEXT(" EfficiencyCheckerLogic: flow field updated with "),
+				flowField.Num(),
+				TEXT(" buildables in "),
+				(FPlatformTime::Seconds() - startTime) * 1000,
+				TEXT(" ms")
+				);
+		}
+	}
 
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
-					}
+	return flowField.getValues(buildable, out_values, out_connected);
+}
 
-					continue;
-				}
-				else
-				{
-					// out_limitedThroughput = 0;
-					bool firstConnection = true;
-					float limitedThroughput = out_limitedThroughput;
-
-					bool firstActor = seenActors.size() == 1;
-
-					for (auto connection : (firstActor ? components : otherConnections))
-					{
-						if (connection == connector && !firstActor)
-						{
-							continue;
-						}
-
-						if (!connection->IsConnected())
-						{
-							continue;
-						}
-
-						if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER)
-						{
-							continue;
-						}
-
-						float previousLimit = out_limitedThroughput;
-						collectOutput(
-							resourceForm,
-							connection->GetConnection(),
-							out_requiredOutput,
-							previousLimit,
-							seenActors,
-							connected,
-							injectedItems,
-							buildableSubsystem,
-							level + 1,
-							overflow,
-							indent + TEXT("    ")
-							);
-
-						if (pipeline)
-						{
-							out_limitedThroughput = FMath::Min(out_limitedThroughput, previousLimit);
-						}
-						else if (firstConnection)
-						{
-							limitedThroughput = previousLimit;
-							firstConnection = false;
-						}
-						else
-						{
-							limitedThroughput += previousLimit;
-						}
-					}
-
-					if (!pipeline && !firstConnection)
-					{
-						out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
-					}
-
-					auto pipeConnector = Cast<UFGPipeConnectionComponent>(connector);
-
-					if (pipePump && pipeConnector->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER)
-					{
-						for (auto connection : components)
-						{
-							if (connection == connector)
-							{
-								continue;
-							}
-
-							if (!connection->IsConnected() || connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
-							{
-								continue;
-							}
-
-							float previousLimit = 0;
-							float discountedOutput = 0;
-
-							TSet<AActor*> seenActorsCopy;
-
-							auto tempInjectedItems = injectedItems;
-
-							for (auto actor : seenActors)
-							{
-								seenActorsCopy.Add(actor.first);
-							}
-
-							collectInput(
-								resourceForm,
-								false,
-								connection->GetConnection(),
-								discountedOutput,
-								previousLimit,
-								seenActorsCopy,
-								connected,
-								tempInjectedItems,
-								tempInjectedItems,
-								buildableSubsystem,
-								level + 1,
-								overflow,
-								indent + TEXT("    ")
-								);
-
-							if (discountedOutput > 0)
-							{
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("Discounting "), discountedOutput, TEXT(" m³/minute"));
-								}
-
-								out_requiredOutput -= discountedOutput;
-							}
-						}
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" m³/minute"));
-					}
-				}
+TSharedPtr<const FEfficiencyCheckerSortRules> AEfficiencyCheckerLogic::getSortRules(AFGBuildableSplitterSmart* smartSplitter)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				connected.Add(buildable);
+	if (!FEfficiencyCheckerModModule::autoUpdate)
+	{
+		return FEfficiencyCheckerSortRules::compile(this, smartSplitter);
+	}
 
-				return;
-			}
+	auto& compiledRules = sortRules.FindOrAdd(smartSplitter);
+	if (!compiledRules)
+	{
+		compiledRules = FEfficiencyCheckerSortRules::compile(this, smartSplitter);
+	}
 
-			auto cargoPlatform = Cast<AFGBuildableTrainPlatformCargo>(owner);
-			if (cargoPlatform)
-			{
-				addAllItemsToActor(seenActors, Cast<AFGBuildable>(cargoPlatform), injectedItems);
+	return compiledRules;
+}
 
-				TArray<UFGPipeConnectionComponent*> pipeConnections;
-				cargoPlatform->GetComponents(pipeConnections);
+void AEfficiencyCheckerLogic::invalidateSortRules(const AActor* smartSplitter)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				auto trackId = cargoPlatform->GetTrackGraphID();
+	sortRules.Remove(smartSplitter);
+}
 
-				auto railroadSubsystem = AFGRailroadSubsystem::Get(owner->GetWorld());
+TSharedPtr<const FEfficiencyCheckerPipeNetwork> AEfficiencyCheckerLogic::getPipeNetwork(const AActor* actor)
+{
+	if (!FEfficiencyCheckerModModule::aggregatePipeNetworks)
+	{
+		return nullptr;
+	}
 
-				// Determine offsets from all the connected stations
-				std::set<int> stationOffsets;
-				TSet<AFGBuildableRailroadStation*> destinationStations;
+	FScopeLock ScopeLock(&eclCritical);
 
-				for (auto i = 0; i <= 1; i++)
-				{
-					auto offsetDistance = 1;
-
-					for (auto connectedPlatform = cargoPlatform->GetConnectedPlatformInDirectionOf(i);
-					     connectedPlatform;
-					     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-					     ++offsetDistance)
-					{
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								*connectedPlatform->GetName(),
-								TEXT(" direction = "),
-								i,
-								TEXT(" / orientation reversed = "),
-								connectedPlatform->IsOrientationReversed() ? TEXT("true") : TEXT("false")
-								);
-						}
-
-						auto station = Cast<AFGBuildableRailroadStation>(connectedPlatform);
-						if (station)
-						{
-							destinationStations.Add(station);
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Station = "),
-									*station->GetStationIdentifier()->GetStationName().ToString()
-									);
-							}
-
-							if (i == 0 && connectedPlatform->IsOrientationReversed() ||
-								i == 1 && !connectedPlatform->IsOrientationReversed())
-							{
-								stationOffsets.insert(offsetDistance);
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), offsetDistance);
-								}
-							}
-							else
-							{
-								stationOffsets.insert(-offsetDistance);
-								if (FEfficiencyCheckerModModule::dumpConnections)
-								{
-									SML::Logging::info(*getTimeStamp(), *indent, TEXT("        offset distance = "), -offsetDistance);
-								}
-							}
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							auto cargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-							if (cargo)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									TEXT("    Load mode = "),
-									cargo->GetIsInLoadMode() ? TEXT("true") : TEXT("false")
-									);
-							}
-						}
-					}
-				}
+	return pipeNetworks.findNetwork(graph, actor);
+}
 
-				TArray<AFGTrain*> trains;
-				railroadSubsystem->GetTrains(trackId, trains);
+FEfficiencyCheckerPipeCut AEfficiencyCheckerLogic::getPipeNetworkCut(const AActor* member, bool input)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-				for (auto train : trains)
-				{
-					if (!train->HasTimeTable())
-					{
-						continue;
-					}
-
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						if (!train->GetTrainName().IsEmpty())
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Train = "),
-								*train->GetTrainName().ToString()
-								);
-						}
-						else
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("Anonymous Train")
-								);
-						}
-					}
-
-					// Get train stations
-					auto timeTable = train->GetTimeTable();
-
-					TArray<FTimeTableStop> stops;
-					timeTable->GetStops(stops);
-
-					bool stopAtStations = false;
-
-					for (auto stop : stops)
-					{
-						if (!stop.Station || !stop.Station->GetStation() || !destinationStations.Contains(stop.Station->GetStation()))
-						{
-							continue;
-						}
-
-						stopAtStations = true;
-
-						break;
-					}
-
-					if (!stopAtStations)
-					{
-						continue;
-					}
-
-					for (auto stop : stops)
-					{
-						if (!stop.Station || !stop.Station->GetStation())
-						{
-							continue;
-						}
-
-						if (FEfficiencyCheckerModModule::dumpConnections)
-						{
-							SML::Logging::info(
-								*getTimeStamp(),
-								*indent,
-								TEXT("    Stop = "),
-								*stop.Station->GetStationName().ToString()
-								);
-						}
-
-						for (auto i = 0; i <= 1; i++)
-						{
-							auto offsetDistance = 1;
-
-							for (auto connectedPlatform = stop.Station->GetStation()->GetConnectedPlatformInDirectionOf(i);
-							     connectedPlatform;
-							     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
-							     ++offsetDistance)
-							{
-								auto stopCargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
-								if (!stopCargo || stopCargo == cargoPlatform)
-								{
-									// Not a cargo or the same as the current one. Skip
-									continue;
-								}
-
-								auto adjustedOffsetDistance = i == 0 && !stop.Station->GetStation()->IsOrientationReversed()
-								                              || i == 1 && stop.Station->GetStation()->IsOrientationReversed()
-									                              ? offsetDistance
-									                              : -offsetDistance;
-
-								if (stationOffsets.find(adjustedOffsetDistance) == stationOffsets.end())
-								{
-									// Not on a valid offset. Skip
-									continue;
-								}
-
-								addAllItemsToActor(seenActors, stopCargo, injectedItems);
-
-								TArray<UFGPipeConnectionComponent*> cargoPipeConnections;
-								stopCargo->GetComponents(cargoPipeConnections);
-
-								pipeConnections.Append(
-									cargoPipeConnections.FilterByPredicate(
-										[&pipeConnections, stopCargo](UFGPipeConnectionComponent* connection)
-										{
-											if (pipeConnections.Contains(connection))
-											{
-												// Already in use
-												return false;
-											}
-
-											if (stopCargo->GetIsInLoadMode())
-											{
-												// Loading
-												return false;
-											}
-
-											if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
-											{
-												// It is a producer connection
-												return true;
-											}
-
-											return false;
-										}
-										)
-									);
-							}
-						}
-					}
-				}
+	return pipeNetworks.getCut(graph, member, input);
+}
 
-				bool firstConnection = true;
-				float limitedThroughput = 0;
+TSharedPtr<const FEfficiencyCheckerChain> AEfficiencyCheckerLogic::getChain(const AActor* actor, int32& out_position)
+{
+	if (!FEfficiencyCheckerModModule::compressChains)
+	{
+		return nullptr;
+	}
 
-				for (auto connection : pipeConnections)
-				{
-					if (!connection->IsConnected() ||
-						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
-					{
-						continue;
-					}
-
-					float previousLimit = out_limitedThroughput;
-					collectOutput(
-						resourceForm,
-						connection->GetConnection(),
-						out_requiredOutput,
-						previousLimit,
-						seenActors,
-						connected,
-						injectedItems,
-						buildableSubsystem,
-						level + 1,
-						overflow,
-						indent + TEXT("    ")
-						);
-
-					if (firstConnection)
-					{
-						limitedThroughput = previousLimit;
-						firstConnection = false;
-					}
-					else
-					{
-						limitedThroughput += previousLimit;
-					}
-				}
+	FScopeLock ScopeLock(&eclCritical);
 
-				out_limitedThroughput = FMath::Min(out_limitedThroughput, limitedThroughput);
+	return chains.findChain(graph, actor, out_position);
+}
 
-				if (FEfficiencyCheckerModModule::dumpConnections)
-				{
-					SML::Logging::info(*getTimeStamp(), *indent, *owner->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" m³/minute"));
-				}
+const FEfficiencyCheckerLoop* AEfficiencyCheckerLogic::getLoop(const AActor* actor)
+{
+	if (!FEfficiencyCheckerModModule::condenseLoops)
+	{
+		return nullptr;
+	}
 
-				connected.Add(Cast<AFGBuildable>(fluidIntegrant));
+	FScopeLock ScopeLock(&eclCritical);
 
-				return;
-			}
-		}
+	if (loopsVersion != conveyorVersion)
+	{
+		const auto startTime = FPlatformTime::Seconds();
 
+		loops.build(graph);
+		loopsVersion = conveyorVersion;
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
 		{
-			const auto generator = Cast<AFGBuildableGeneratorFuel>(owner);
-			if (generator)
-			{
-				if (injectedItems.Contains(generator->GetSupplementalResourceClass()) && !seenActors[generator].Contains(generator->GetSupplementalResourceClass()))
-				{
-					if (FEfficiencyCheckerModModule::dumpConnections)
-					{
-						SML::Logging::info(
-							*getTimeStamp(),
-							*indent,
-							TEXT("Supplemental item = "),
-							*UFGItemDescriptor::GetItemName(generator->GetSupplementalResourceClass()).ToString()
-							);
-						SML::Logging::info(*getTimeStamp(), *indent, TEXT("Supplemental amount = "), generator->GetSupplementalConsumptionRateMaximum());
-					}
-
-					out_requiredOutput += generator->GetSupplementalConsumptionRateMaximum() * (
-						(UFGItemDescriptor::GetForm(generator->GetSupplementalResourceClass()) == EResourceForm::RF_LIQUID ||
-							UFGItemDescriptor::GetForm(generator->GetSupplementalResourceClass()) == EResourceForm::RF_GAS)
-							? 60
-							: 1);
-
-					seenActors[generator].Add(generator->GetSupplementalResourceClass());
-				}
-				else
-				{
-					for (auto item : injectedItems)
-					{
-						if (generator->IsValidFuel(item) && !seenActors[generator].Contains(item))
-						{
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Energy item = "), *UFGItemDescriptor::GetItemName(item).ToString());
-							}
-
-							float energy = UFGItemDescriptor::GetEnergyValue(item);
-
-							// if (UFGItemDescriptor::GetForm(out_injectedItem) == EResourceForm::RF_LIQUID)
-							// {
-							//     energy *= 1000;
-							// }
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Energy = "), energy);
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Current potential = "), generator->GetCurrentPotential());
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Pending potential = "), generator->GetPendingPotential());
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Power production capacity = "), generator->GetPowerProductionCapacity());
-								SML::Logging::info(*getTimeStamp(), *indent, TEXT("Default power production capacity = "), generator->GetDefaultPowerProductionCapacity());
-							}
-
-							float itemAmountPerMinute = 60 / (energy / generator->GetPowerProductionCapacity());
-
-							if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
-							{
-								itemAmountPerMinute /= 1000;
-							}
-
-							// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
-							// {
-							//     if (fullClassName.EndsWith(TEXT("MK2_C")))
-							//     {
-							//         itemAmountPerMinute *= 1.5;
-							//     }
-							//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
-							//     {
-							//         itemAmountPerMinute *= 2;
-							//     }
-							//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
-							//     {
-							//         itemAmountPerMinute *= 2.5;
-							//     }
-							// }
-
-							if (FEfficiencyCheckerModModule::dumpConnections)
-							{
-								SML::Logging::info(
-									*getTimeStamp(),
-									*indent,
-									*generator->GetName(),
-									TEXT(" consumes "),
-									itemAmountPerMinute,
-									TEXT(" "),
-									*UFGItemDescriptor::GetItemName(item).ToString(),
-									TEXT("/minute")
-									);
-							}
-
-							seenActors[generator].Add(item);
-							out_requiredOutput += itemAmountPerMinute;
-
-							break;
-						}
-					}
-				}
+			SML::Logging::info(
+				*getTimeStamp(),
+				TEXT(" EfficiencyCheckerLogic: "),
+				loops.Num(),
+				TEXT(" conveyor loops found in "),
+				(FPlatformTime::Seconds() - startTime) * 1000,
+				TEXT(" ms")
+				);
+		}
+	}
 
-				connected.Add(generator);
+	return loops.findLoop(actor);
+}
 
-				return;
-			}
-		}
+FEfficiencyCheckerLoopCut AEfficiencyCheckerLogic::getLoopCut(const AActor* member, bool input)
+{
+	FScopeLock ScopeLock(&eclCritical);
+
+	return loops.getCut(member, input);
+}
 
-		addAllItemsToActor(seenActors, owner, injectedItems);
+TSharedPtr<const FEfficiencyCheckerSubWalk> AEfficiencyCheckerLogic::findSubWalk(const FEfficiencyCheckerSubWalkKey& key, int32& out_epoch)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-		// out_limitedThroughput = 0;
+	out_epoch = subWalks.getEpoch();
 
-		if (FEfficiencyCheckerModModule::dumpConnections)
-		{
-			dumpUnknownClass(indent, owner);
-		}
+	return subWalks.find(key);
+}
+
+void AEfficiencyCheckerLogic::addSubWalk(const FEfficiencyCheckerSubWalkKey& key, FEfficiencyCheckerSubWalk&& walk, int32 epoch)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
+	subWalks.add(key, MoveTemp(walk), epoch);
+}
+
+void AEfficiencyCheckerLogic::touchComponents(AFGBuildable* buildable)
+{
+	if (!buildable)
+	{
 		return;
 	}
+
+	FScopeLock ScopeLock(&eclCritical);
+
+	if (graph.findNode(buildable) != INDEX_NONE)
+	{
+		components.touch(buildable);
+		chains.invalidate(graph, buildable);
+	}
+	else if (buildable->FindComponentByClass<UFGFactoryConnectionComponent>() || buildable->FindComponentByClass<UFGPipeConnectionComponent>())
+	{
+		// Not indexed yet, so what it connects to is not known
+		components.touchAll();
+		chains.Empty();
+	}
 }
 
-bool AEfficiencyCheckerLogic::inheritsFrom(AActor* owner, const FString& className)
+bool AEfficiencyCheckerLogic::haveComponentsChanged(const TSet<AFGBuildable*>& buildables, int32 version)
 {
-	for (auto cls = owner->GetClass(); cls && cls != AActor::StaticClass(); cls = cls->GetSuperClass())
+	if (!buildables.Num() || version == INDEX_NONE)
 	{
-		if (GetPathNameSafe(cls) == className)
-		{
-			return true;
-		}
+		return true;
 	}
 
-	return false;
+	FScopeLock ScopeLock(&eclCritical);
+
+	if (railroadRoutes.invalidateChangedTimetables(GetWorld()))
+	{
+		// Platforms are linked to others by the trains, with nothing to tell when they change
+		components.touchAll();
+	}
+
+	return components.getVersion(graph, buildables) > version;
 }
 
-void AEfficiencyCheckerLogic::dumpUnknownClass(const FString& indent, AActor* owner)
+void AEfficiencyCheckerLogic::invalidateSubWalks(AActor* buildable, bool neighbours)
 {
-	if (FEfficiencyCheckerModModule::dumpConnections)
+	if (!buildable)
 	{
-		SML::Logging::info(*getTimeStamp(), *indent, TEXT("Unknown Class "), *GetPathNameSafe(owner->GetClass()));
+		return;
+	}
 
-		for (auto cls = owner->GetClass()->GetSuperClass(); cls && cls != AActor::StaticClass(); cls = cls->GetSuperClass())
+	FScopeLock ScopeLock(&eclCritical);
+
+	// Bumps the epoch even when nothing is cached, for the sub-walks still running
+	subWalks.invalidate(buildable);
+
+	if (!neighbours || !subWalks.Num())
+	{
+		return;
+	}
+
+	const auto node = graph.getNode(graph.findNode(buildable));
+	if (!node)
+	{
+		return;
+	}
+
+	for (auto connection : node->factoryConnections)
+	{
+		if (connection->IsConnected())
 		{
-			SML::Logging::info(*getTimeStamp(), *indent, TEXT("    - Super: "), *GetPathNameSafe(cls));
+			subWalks.invalidate(connection->GetConnection()->GetOwner());
 		}
+	}
 
-		SML::Logging::info(*getTimeStamp(), *indent, TEXT("Properties "), *GetPathNameSafe(owner->GetClass()));
-
-		for (TFieldIterator<UProperty> property(owner->GetClass()); property; ++property)
+	for (auto connection : node->pipeConnections)
+	{
+		if (connection->IsConnected())
 		{
-			SML::Logging::info(
-				*getTimeStamp(),
-				*indent,
-				TEXT("        - "),
-				*property->GetName(),
-				TEXT(" ("),
-				*property->GetCPPType(),
-				TEXT(" / Type: "),
-				*GetPathNameSafe(property->GetClass()),
-				TEXT(" / From: "),
-				*GetPathNameSafe(property->GetOwnerClass()),
-				TEXT(")")
-				);
+			subWalks.invalidate(connection->GetConnection()->GetOwner());
+		}
+	}
+}
 
-			auto floatProperty = Cast<UFloatProperty>(*property);
-			if (floatProperty)
-			{
-				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), floatProperty->GetPropertyValue_InContainer(owner));
-			}
+void AEfficiencyCheckerLogic::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
 
-			auto intProperty = Cast<UIntProperty>(*property);
-			if (intProperty)
+	const auto deadline = FPlatformTime::Seconds() + FEfficiencyCheckerModModule::updateBudgetMs / 1000;
+
+	runSequentialUpdates(deadline);
+}
+
+void AEfficiencyCheckerLogic::runSequentialUpdates(double deadline)
+{
+	// At least one slice is run on every tick, so that the queue always moves
+	for (auto stepped = false;; stepped = true)
+	{
+		if (currentUpdate && currentUpdate->graphVersion != graphVersion)
+		{
+			FScopeLock ScopeLock(&eclCritical);
+
+			if (currentUpdate->dependsOnAny(changedBuildables))
 			{
-				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), intProperty->GetPropertyValue_InContainer(owner));
-			}
+				// The suspended walk went through what was built or removed since, so it starts over
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(*getTimeStamp(), TEXT(" EfficiencyCheckerLogic: restarting update of "), *currentUpdate->checker->GetName());
+				}
 
-			auto boolProperty = Cast<UBoolProperty>(*property);
-			if (boolProperty)
+				currentUpdate = currentUpdate->checker->beginScheduledUpdate();
+			}
+			else
 			{
-				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), boolProperty->GetPropertyValue_InContainer(owner) ? TEXT("true") : TEXT("false"));
+				currentUpdate->graphVersion = graphVersion;
 			}
 
-			auto structProperty = Cast<UStructProperty>(*property);
-			if (structProperty && property->GetName() == TEXT("mFactoryTickFunction"))
+			changedBuildables.Reset();
+		}
+
+		if (!currentUpdate)
+		{
+			AEfficiencyCheckerBuilding* checker;
+
 			{
-				auto factoryTick = structProperty->ContainerPtrToValuePtr<FFactoryTickFunction>(owner);
-				if (factoryTick)
+				FScopeLock ScopeLock(&eclCritical);
+
+				if (!pendingUpdatesSet.Num())
 				{
-					SML::Logging::info(*getTimeStamp(), *indent, TEXT("            - Tick Interval = "), factoryTick->TickInterval);
+					pendingUpdates.Reset();
+					pendingUpdatesHead = 0;
+
+					SetActorTickEnabled(false);
+
+					return;
+				}
+
+				if (stepped && FPlatformTime::Seconds() >= deadline)
+				{
+					// Carry the rest over to the next tick
+					break;
+				}
+
+				checker = pendingUpdates[pendingUpdatesHead++];
+
+				if (pendingUpdatesHead * 2 >= pendingUpdates.Num())
+				{
+					// Drop the consumed half at once, so the queue is shifted O(1) times per entry
+					pendingUpdates.RemoveAt(0, pendingUpdatesHead, false);
+					pendingUpdatesHead = 0;
+				}
+
+				if (!pendingUpdatesSet.Remove(checker))
+				{
+					// Cancelled, or already taken from an earlier entry
+					continue;
 				}
 			}
 
-			auto strProperty = Cast<UStrProperty>(*property);
-			if (strProperty)
+			if (checker->IsPendingKill())
 			{
-				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            = "), *strProperty->GetPropertyValue_InContainer(owner));
+				continue;
 			}
 
-			auto classProperty = Cast<UClassProperty>(*property);
-			if (classProperty)
+			currentUpdate = checker->beginScheduledUpdate();
+
+			if (!currentUpdate)
 			{
-				auto ClassObject = Cast<UClass>(classProperty->GetPropertyValue_InContainer(owner));
-				SML::Logging::info(*getTimeStamp(), *indent, TEXT("            - Class = "), *GetPathNameSafe(ClassObject));
+				continue;
 			}
 		}
+		else if (stepped && FPlatformTime::Seconds() >= deadline)
+		{
+			break;
+		}
+
+		if (!currentUpdate->resume(FEfficiencyCheckerModModule::updateSliceNodes, deadline))
+		{
+			// Slice spent. The walk goes on from where it stopped on the next tick
+			break;
+		}
+
+		// Only complete results are published
+		const auto job = MoveTemp(currentUpdate);
+
+		job->checker->applyConnectedProduction(*job);
 	}
-}
 
-void AEfficiencyCheckerLogic::DumpInformation(TSubclassOf<UFGItemDescriptor> itemDescriptorClass)
-{
 	if (FEfficiencyCheckerModModule::dumpConnections)
 	{
-		if (!itemDescriptorClass)
-		{
-			return;
-		}
+		SML::Logging::info(
+			*getTimeStamp(),
+			TEXT(" EfficiencyCheckerLogic: "),
+			pendingUpdatesSet.Num(),
+			TEXT(" updates carried over to the next tick"),
+			currentUpdate ? TEXT(", one of them suspended") : TEXT("")
+			);
+	}
+}
 
-		auto className = GetFullNameSafe(itemDescriptorClass);
+void AEfficiencyCheckerLogic::addCheckerDependencies(AEfficiencyCheckerBuilding* checker, const TSet<AFGBuildable*>& buildables)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-		SML::Logging::info(*getTimeStamp(), TEXT(" Dumping "), *className);
+	for (auto buildable : buildables)
+	{
+		checkersByBuildable.FindOrAdd(buildable).Add(checker);
+	}
+}
 
-		auto itemDescriptor = Cast<UFGItemDescriptor>(itemDescriptorClass->GetDefaultObject());
-		if (!itemDescriptor)
-		{
-			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment small icon = "), *GetPathNameSafe(itemDescriptor->mSmallIcon));
-			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment big icon = "), *GetPathNameSafe(itemDescriptor->mPersistentBigIcon));
-			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment conveyor mesh = "), *GetPathNameSafe(itemDescriptor->mConveyorMesh));
-			SML::Logging::info(*getTimeStamp(), TEXT(" Equipment item category = "), *GetPathNameSafe(itemDescriptor->mItemCategory));
-		}
+void AEfficiencyCheckerLogic::removeCheckerDependencies(AEfficiencyCheckerBuilding* checker, const TSet<AFGBuildable*>& buildables)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-		auto equipmentDescriptor = Cast<UFGEquipmentDescriptor>(itemDescriptor);
-		if (!equipmentDescriptor)
+	for (auto buildable : buildables)
+	{
+		auto checkers = checkersByBuildable.Find(buildable);
+		if (!checkers)
 		{
-			SML::Logging::info(*getTimeStamp(), TEXT(" Class "), *className, TEXT(" is not an Equipment Descriptor"));
-
-			return;
+			continue;
 		}
 
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment stack size = "), *getEnumItemName(TEXT("EStackSize"), (int)equipmentDescriptor->mStackSize));
-
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment class = "), *GetPathNameSafe(equipmentDescriptor->mEquipmentClass));
+		checkers->Remove(checker);
 
-		if (!equipmentDescriptor->mEquipmentClass)
+		if (!checkers->Num())
 		{
-			return;
+			checkersByBuildable.Remove(buildable);
 		}
+	}
+}
 
-		auto equipment = Cast<AFGEquipment>(equipmentDescriptor->mEquipmentClass->GetDefaultObject());
+TSet<AEfficiencyCheckerBuilding*> AEfficiencyCheckerLogic::getDependentCheckers(AFGBuildable* buildable)
+{
+	FScopeLock ScopeLock(&eclCritical);
 
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment attachment = "), *GetPathNameSafe(equipment->mAttachmentClass));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment secondary attachment = "), *GetPathNameSafe(equipment->mSecondaryAttachmentClass));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment slot = "), *getEnumItemName(TEXT("EEquipmentSlot"), (int)equipment->mEquipmentSlot));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment attachment socket = "), *equipment->mAttachSocket.ToString());
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment arm animation = "), *getEnumItemName(TEXT("EArmEquipment"), (int)equipment->mArmAnimation));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment back animation = "), *getEnumItemName(TEXT("EBackEquipment"), (int)equipment->mBackAnimation));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment equip sound = "), *GetPathNameSafe(equipment->mEquipSound));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment unequip sound = "), *GetPathNameSafe(equipment->mUnequipSound));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment widget = "), *GetPathNameSafe(equipment->mEquipmentWidget));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment use default primary fire = "), equipment->mUseDefaultPrimaryFire ? TEXT("true") : TEXT("false"));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment idle pose animation = "), *GetPathNameSafe(equipment->GetIdlePoseAnimation()));
-		SML::Logging::info(*getTimeStamp(), TEXT(" Equipment idle pose animation 3p = "), *GetPathNameSafe(equipment->GetIdlePoseAnimation3p()));
+	const auto checkers = checkersByBuildable.Find(buildable);
 
-		SML::Logging::info(*getTimeStamp(), TEXT(" Dump done"));
-	}
+	return checkers ? *checkers : TSet<AEfficiencyCheckerBuilding*>();
 }
 
-bool AEfficiencyCheckerLogic::IsValidBuildable(AFGBuildable* newBuildable)
+TSet<AEfficiencyCheckerBuilding*> AEfficiencyCheckerLogic::getCheckersAffectedByNewBuildable(AFGBuildable* newBuildable)
 {
-	if (!newBuildable)
+	FScopeLock ScopeLock(&eclCritical);
+
+	const auto node = graph.getNode(graph.findNode(newBuildable));
+	if (!node)
 	{
-		return false;
+		// Can't tell what it connects to
+		return allEfficiencyBuildings;
 	}
 
-	if (auto checker = Cast<AEfficiencyCheckerBuilding>(newBuildable))
-	{
-		addEfficiencyBuilding(checker);
+	TSet<AEfficiencyCheckerBuilding*> checkers;
 
-		return true;
-	}
-	if (Cast<AFGBuildableManufacturer>(newBuildable))
-	{
-		return true;
-	}
-	if (Cast<AFGBuildableResourceExtractor>(newBuildable))
-	{
-		return true;
-	}
-	if (Cast<AFGBuildableStorage>(newBuildable))
-	{
-		return true;
-	}
-	if (auto belt = Cast<AFGBuildableConveyorBelt>(newBuildable))
+	const auto addDependentCheckers = [this, &checkers](AActor* actor)
 	{
-		addBelt(belt);
+		const auto dependentCheckers = checkersByBuildable.Find(Cast<AFGBuildable>(actor));
+		if (dependentCheckers)
+		{
+			checkers.Append(*dependentCheckers);
+		}
+	};
 
-		return true;
-	}
-	if (Cast<AFGBuildableConveyorBase>(newBuildable))
-	{
-		return true;
-	}
-	if (Cast<AFGBuildableConveyorAttachment>(newBuildable))
-	{
-		return true;
-	}
-	if (auto pipe = Cast<AFGBuildablePipeline>(newBuildable))
-	{
-		addPipe(pipe);
+	addDependentCheckers(newBuildable);
 
-		return true;
-	}
-	if (Cast<AFGBuildablePipelineAttachment>(newBuildable))
-	{
-		return true;
-	}
-	if (Cast<AFGBuildableTrainPlatform>(newBuildable))
+	for (auto connection : node->factoryConnections)
 	{
-		return true;
+		if (connection->IsConnected())
+		{
+			addDependentCheckers(connection->GetConnection()->GetOwner());
+		}
 	}
-	if (Cast<AFGBuildableRailroadStation>(newBuildable))
+
+	for (auto connection : node->pipeConnections)
 	{
-		return true;
+		if (connection->IsConnected())
+		{
+			addDependentCheckers(connection->GetConnection()->GetOwner());
+		}
 	}
-	if (Cast<AFGBuildableDockingStation>(newBuildable))
+
+	for (auto checker : allEfficiencyBuildings)
 	{
-		return true;
+		if (!checker->connectedBuildables.Num())
+		{
+			checkers.Add(checker);
+		}
 	}
-	if (Cast<AFGBuildableGeneratorFuel>(newBuildable))
+
+	return checkers;
+}
+
+int32 AEfficiencyCheckerLogic::getItemIndex(TSubclassOf<UFGItemDescriptor> item)
+{
+	if (!item)
 	{
-		return true;
+		return INDEX_NONE;
 	}
-	if (Cast<AFGBuildableGeneratorNuclear>(newBuildable))
+
+	FScopeLock ScopeLock(&eclCritical);
+
+	const auto existingIndex = itemIndexes.Find(item);
+	if (existingIndex)
 	{
-		return true;
+		return *existingIndex;
 	}
-	if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
-		GetPathNameSafe(newBuildable->GetClass()) == TEXT("/Game/StorageTeleporter/Buildables/ItemTeleporter/ItemTeleporter_Build.ItemTeleporter_Build_C"))
-	{
-		addTeleporter(newBuildable);
 
-		return true;
+	const auto itemIndex = itemDescriptors.Add(item);
+	itemIndexes.Add(item, itemIndex);
+	itemEnergyValues.Add(UFGItemDescriptor::GetEnergyValue(item));
+
+	if (isSolidConveyorItem(item))
+	{
+		solidConveyorItemMask.Add(itemIndex);
 	}
 
-	return false;
+	return itemIndex;
 }
 
-void AEfficiencyCheckerLogic::addEfficiencyBuilding(class AEfficiencyCheckerBuilding* checker)
+TSubclassOf<UFGItemDescriptor> AEfficiencyCheckerLogic::getItemDescriptor(int32 itemIndex) const
 {
-	FScopeLock ScopeLock(&eclCritical);
-	allEfficiencyBuildings.Add(checker);
-
-	checker->OnEndPlay.Add(removeEffiencyBuildingDelegate);
+	return itemDescriptors.IsValidIndex(itemIndex) ? itemDescriptors[itemIndex] : nullptr;
 }
 
-void AEfficiencyCheckerLogic::removeEfficiencyBuilding(AActor* actor, EEndPlayReason::Type reason)
+float AEfficiencyCheckerLogic::getItemEnergyValue(int32 itemIndex)
 {
 	FScopeLock ScopeLock(&eclCritical);
-	allEfficiencyBuildings.Remove(Cast<AEfficiencyCheckerBuilding>(actor));
 
-	actor->OnEndPlay.Remove(removeEffiencyBuildingDelegate);
+	return itemEnergyValues.IsValidIndex(itemIndex) ? itemEnergyValues[itemIndex] : 0;
 }
 
-void AEfficiencyCheckerLogic::addBelt(AFGBuildableConveyorBelt* belt)
+TSharedPtr<const FEfficiencyCheckerRecipe> AEfficiencyCheckerLogic::getRecipe(TSubclassOf<UFGRecipe> recipe)
 {
+	if (!recipe)
+	{
+		return nullptr;
+	}
+
 	FScopeLock ScopeLock(&eclCritical);
-	allBelts.Add(belt);
 
-	belt->OnEndPlay.Add(removeBeltDelegate);
-}
+	const auto existingRecipe = recipes.Find(recipe);
+	if (existingRecipe)
+	{
+		return *existingRecipe;
+	}
 
-void AEfficiencyCheckerLogic::removeBelt(AActor* actor, EEndPlayReason::Type reason)
-{
-	FScopeLock ScopeLock(&eclCritical);
-	allBelts.Remove(Cast<AFGBuildableConveyorBelt>(actor));
+	auto newRecipe = MakeShared<FEfficiencyCheckerRecipe>();
 
-	actor->OnEndPlay.Remove(removeBeltDelegate);
-}
+	const auto addItems = [this](const TArray<FItemAmount>& itemAmounts, TArray<FEfficiencyCheckerRecipeItem>& out_items)
+	{
+		for (const auto& itemAmount : itemAmounts)
+		{
+			auto& recipeItem = out_items.AddDefaulted_GetRef();
 
-void AEfficiencyCheckerLogic::addPipe(AFGBuildablePipeline* pipe)
-{
-	FScopeLock ScopeLock(&eclCritical);
-	allPipes.Add(pipe);
+			recipeItem.item = itemAmount.ItemClass;
+			recipeItem.itemIndex = getItemIndex(itemAmount.ItemClass);
+			recipeItem.amount = itemAmount.Amount;
+			recipeItem.form = UFGItemDescriptor::GetForm(itemAmount.ItemClass);
+		}
+	};
 
-	pipe->OnEndPlay.Add(removePipeDelegate);
+	addItems(UFGRecipe::GetIngredients(recipe), newRecipe->ingredients);
+	addItems(UFGRecipe::GetProducts(recipe), newRecipe->products);
+
+	recipes.Add(recipe, newRecipe);
+
+	return newRecipe;
 }
 
-void AEfficiencyCheckerLogic::removePipe(AActor* actor, EEndPlayReason::Type reason)
+FEfficiencyCheckerItemSet AEfficiencyCheckerLogic::getSolidConveyorItems()
 {
 	FScopeLock ScopeLock(&eclCritical);
-	allPipes.Remove(Cast<AFGBuildablePipeline>(actor));
 
-	actor->OnEndPlay.Remove(removePipeDelegate);
+	return solidConveyorItemMask;
 }
 
-void AEfficiencyCheckerLogic::addTeleporter(AFGBuildable* teleporter)
+bool AEfficiencyCheckerLogic::isSolidConveyorItem(TSubclassOf<UFGItemDescriptor> item) const
 {
-	FScopeLock ScopeLock(&eclCritical);
-	allTeleporters.Add(teleporter);
-
-	teleporter->OnEndPlay.Add(removeTeleporterDelegate);
+	return item &&
+		UFGBlueprintFunctionLibrary::CanBeOnConveyor(item) &&
+		UFGItemDescriptor::GetForm(item) == EResourceForm::RF_SOLID &&
+		!wildCardItemDescriptors.Contains(item) &&
+		!overflowItemDescriptors.Contains(item) &&
+		!noneItemDescriptors.Contains(item) &&
+		!anyUndefinedItemDescriptors.Contains(item);
 }
 
-void AEfficiencyCheckerLogic::removeTeleporter(AActor* actor, EEndPlayReason::Type reason)
+FEfficiencyCheckerItemSet AEfficiencyCheckerLogic::toItemSet(const TSet<TSubclassOf<UFGItemDescriptor>>& items)
 {
-	FScopeLock ScopeLock(&eclCritical);
-	allTeleporters.Remove(Cast<AFGBuildable>(actor));
+	FEfficiencyCheckerItemSet itemSet;
 
-	actor->OnEndPlay.Remove(removeTeleporterDelegate);
+	for (auto item : items)
+	{
+		itemSet.Add(getItemIndex(item));
+	}
+
+	return itemSet;
 }
 
-float AEfficiencyCheckerLogic::getPipeSpeed(AFGBuildablePipeline* pipe)
+void AEfficiencyCheckerLogic::addItemsToSet(const FEfficiencyCheckerItemSet& items, TSet<TSubclassOf<UFGItemDescriptor>>& out_items) const
 {
-	if (!pipe)
+	for (auto itemIndex : items)
 	{
-		return 0;
+		out_items.Add(getItemDescriptor(itemIndex));
 	}
-
-	return UFGBlueprintFunctionLibrary::RoundFloatWithPrecision(pipe->GetFlowLimit() * 60, 4);
 }
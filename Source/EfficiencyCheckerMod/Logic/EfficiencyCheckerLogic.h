@@ -1,9 +1,21 @@
 ﻿#pragma once
 
-#include <map>
-
 #include "EfficiencyCheckerBuilding.h"
 #include "FGItemDescriptor.h"
+#include "Logic/EfficiencyCheckerChains.h"
+#include "Logic/EfficiencyCheckerComponents.h"
+#include "Logic/EfficiencyCheckerFlowField.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+#include "Logic/EfficiencyCheckerLoops.h"
+#include "Logic/EfficiencyCheckerPipeNetworks.h"
+#include "Logic/EfficiencyCheckerRailroadRoutes.h"
+#include "Logic/EfficiencyCheckerRecipe.h"
+#include "Logic/EfficiencyCheckerSeenActors.h"
+#include "Logic/EfficiencyCheckerSortRules.h"
+#include "Logic/EfficiencyCheckerSpatialGrid.h"
+#include "Logic/EfficiencyCheckerSubWalkCache.h"
+#include "Logic/EfficiencyCheckerUpdateJob.h"
 #include "EfficiencyCheckerLogic.generated.h"
 
 UCLASS()
@@ -12,6 +24,10 @@ class AEfficiencyCheckerLogic : public AActor
     GENERATED_BODY()
 
 public:
+    AEfficiencyCheckerLogic();
+
+    virtual void Tick(float DeltaSeconds) override;
+
     UFUNCTION(BlueprintCallable, Category="EfficiencyCheckerLogic")
     virtual void Initialize
     (
@@ -40,12 +56,10 @@ public:
         float& out_limitedThroughput,
         TSet<AActor*>& seenActors,
         TSet<class AFGBuildable*>& connected,
-        TSet<TSubclassOf<UFGItemDescriptor>>& out_injectedItems,
-        const TSet<TSubclassOf<UFGItemDescriptor>>& restrictItems,
+        FEfficiencyCheckerItemSet& out_injectedItems,
+        const FEfficiencyCheckerItemSet& restrictItems,
         class AFGBuildableSubsystem* buildableSubsystem,
-        int level,
-        bool& overflow,
-        const FString& indent
+        bool& overflow
     );
 
     static void collectOutput
@@ -54,20 +68,19 @@ public:
         class UFGConnectionComponent* connector,
         float& out_requiredOutput,
         float& out_limitedThroughput,
-        std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors,
+        FEfficiencyCheckerSeenActors& seenActors,
         TSet<AFGBuildable*>& connected,
-        const TSet<TSubclassOf<UFGItemDescriptor>>& in_injectedItems,
+        const FEfficiencyCheckerItemSet& injectedItems,
         class AFGBuildableSubsystem* buildableSubsystem,
-        int level,
-        bool& overflow,
-        const FString& indent
+        bool& overflow
     );
 
-    static bool containsActor(const std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors, AActor* actor);
-    static bool actorContainsItem(const std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors, AActor* actor, const TSubclassOf<UFGItemDescriptor>& item);
-    static void addAllItemsToActor(std::map<AActor*, TSet<TSubclassOf<UFGItemDescriptor>>>& seenActors, AActor* actor, const TSet<TSubclassOf<UFGItemDescriptor>>& items);
+    static bool containsActor(const FEfficiencyCheckerSeenActors& seenActors, AActor* actor);
+    static bool actorContainsItem(const FEfficiencyCheckerSeenActors& seenActors, AActor* actor, int32 itemIndex);
+    static bool actorContainsAllItems(const FEfficiencyCheckerSeenActors& seenActors, AActor* actor, const FEfficiencyCheckerItemSet& items);
+    static void addAllItemsToActor(FEfficiencyCheckerSeenActors& seenActors, AActor* actor, const FEfficiencyCheckerItemSet& items);
 
-    static bool inheritsFrom(AActor* owner, const FString& className);
+    static bool inheritsFrom(UClass* actorClass, const FString& className);
     static void dumpUnknownClass(const FString& indent, AActor* owner);
 
     inline static FString
@@ -80,12 +93,85 @@ public:
 
     static float getPipeSpeed(AFGBuildablePipeline* pipe);
 
+    // Throughput allowed by the pump flow limit set by the player, from the speed of the pipes around it. FLT_MAX when not throttled
+    static float getPumpFlowLimit(class AFGBuildablePipelinePump* pipePump);
+
+    // Node index of the buildable, or of the owner of the connection. INDEX_NONE when it is not indexed. Buildables are
+    // only indexed from Initialize and the build hooks (see indexBuildable), so the lookups never change the graph
+    int32 findNode(const AActor* actor);
+    int32 findConnectionNode(const class UFGConnectionComponent* connection);
+
+    // Node at the index, resolved at the point of use. Only valid until the graph changes on the next build or dismantle
+    inline const FEfficiencyCheckerNode*
+    getNode(int32 nodeIndex) const
+    {
+        return graph.getNode(nodeIndex);
+    }
+
+    // Indexes a buildable built after Initialize, when it was not indexed yet
+    void indexBuildable(class AFGBuildable* buildable);
+
+    // Connections of the buildable, as resolved when it was indexed. The ones of a buildable that is not indexed are read
+    // into out_unindexed, so the indexed ones are never copied
+    static const TArray<class UFGFactoryConnectionComponent*>& getFactoryConnections
+    (
+        class AFGBuildableFactory* buildable,
+        TArray<class UFGFactoryConnectionComponent*>& out_unindexed
+    );
+
+    static const TArray<class UFGPipeConnectionComponent*>& getPipeConnections(AActor* actor, TArray<class UFGPipeConnectionComponent*>& out_unindexed);
+
+    // Node kind of the class, resolved on first sight and cached
+    EEfficiencyCheckerClassFlags getClassFlags(UClass* actorClass);
+    static EEfficiencyCheckerClassFlags resolveClassFlags(UClass* actorClass);
+
+    // Downcast of a traversed actor whose kind was already resolved
+    template <typename T>
+    inline static T*
+    castOwner(AActor* owner, EEfficiencyCheckerClassFlags ownerFlags, EEfficiencyCheckerClassFlags flag)
+    {
+        return EnumHasAnyFlags(ownerFlags, flag) ? static_cast<T*>(owner) : nullptr;
+    }
+
     TSet<TSubclassOf<UFGItemDescriptor>> nuclearWasteItemDescriptors;
     TSet<TSubclassOf<UFGItemDescriptor>> noneItemDescriptors;
     TSet<TSubclassOf<UFGItemDescriptor>> wildCardItemDescriptors;
     TSet<TSubclassOf<UFGItemDescriptor>> anyUndefinedItemDescriptors;
     TSet<TSubclassOf<UFGItemDescriptor>> overflowItemDescriptors;
 
+    FEfficiencyCheckerItemSet nuclearWasteItemMask;
+    FEfficiencyCheckerItemSet noneItemMask;
+    FEfficiencyCheckerItemSet wildCardItemMask;
+    FEfficiencyCheckerItemSet anyUndefinedItemMask;
+    FEfficiencyCheckerItemSet overflowItemMask;
+
+    // Every item that can be carried by belts, except the special ones. Updated as new descriptors are interned
+    FEfficiencyCheckerItemSet solidConveyorItemMask;
+
+    FEfficiencyCheckerItemSet getSolidConveyorItems();
+    bool isSolidConveyorItem(TSubclassOf<UFGItemDescriptor> item) const;
+
+    // Dense index of an item descriptor. Unknown descriptors are interned on first use
+    int32 getItemIndex(TSubclassOf<UFGItemDescriptor> item);
+    TSubclassOf<UFGItemDescriptor> getItemDescriptor(int32 itemIndex) const;
+
+    FEfficiencyCheckerItemSet toItemSet(const TSet<TSubclassOf<UFGItemDescriptor>>& items);
+    void addItemsToSet(const FEfficiencyCheckerItemSet& items, TSet<TSubclassOf<UFGItemDescriptor>>& out_items) const;
+
+    TArray<TSubclassOf<UFGItemDescriptor>> itemDescriptors;
+    TMap<UClass*, int32> itemIndexes;
+
+    // Energy value of each interned item, for the fuel rates of the generators
+    TArray<float> itemEnergyValues;
+
+    float getItemEnergyValue(int32 itemIndex);
+
+    // Ingredients and products of a recipe. Recipes are interned like the items, the ones in use when initializing and
+    // the rest on first use
+    TSharedPtr<const FEfficiencyCheckerRecipe> getRecipe(TSubclassOf<class UFGRecipe> recipe);
+
+    TMap<UClass*, TSharedPtr<const FEfficiencyCheckerRecipe>> recipes;
+
     FCriticalSection eclCritical;
 
     static AEfficiencyCheckerLogic* singleton;
@@ -95,15 +181,159 @@ public:
     TSet<class AFGBuildablePipeline*> allPipes;
     TSet<class AFGBuildable*> allTeleporters;
 
+    // Storage teleporters by StorageID, and the StorageID each one was indexed with. The id can be changed with nothing
+    // to tell, so pollStorageIDs moves the ones that changed
+    TMap<FString, TArray<class AFGBuildable*>> teleportersByStorageID;
+    TMap<class AFGBuildable*, FString> teleporterStorageIDs;
+
+    // Runs pollStorageIDs on its own timer, as the actor only ticks while there are queued updates
+    FTimerHandle storageIDTimer;
+
+    // Moves the teleporters whose StorageID changed, and queues a refresh of the checkers that went through them or
+    // through the teleporters they are linked to now
+    void pollStorageIDs();
+
+    // StorageID property of the teleporter class, resolved on the first teleporter
+    class UStrProperty* storageIDProperty = nullptr;
+
+    const FString* getStorageID(class AFGBuildable* teleporter);
+
+    // Indexes the teleporter under its current StorageID, moving it when it changed. True when it was moved
+    bool indexTeleporter(class AFGBuildable* teleporter);
+    void unindexTeleporter(class AFGBuildable* teleporter);
+
+    // Other storage teleporters sharing the same StorageID
+    TArray<class AFGBuildable*> getLinkedTeleporters(class AFGBuildable* teleporter);
+
+    // Belt bounds, widened by the distance a ground checker can be from the belt. Cells of one foundation
+    TEfficiencyCheckerSpatialGrid<class AFGBuildableConveyorBelt*> beltGrid{800};
+
+    // Pipe connector locations, for the wall checkers that are attached to a pipe end
+    TEfficiencyCheckerSpatialGrid<class AFGBuildablePipeline*> pipeGrid{100};
+
+    FEfficiencyCheckerGraph graph;
+    TMap<UClass*, EEfficiencyCheckerClassFlags> classFlags;
+
+    // Checkers whose last result went through the buildable. Kept in sync with AEfficiencyCheckerBuilding::connectedBuildables
+    TMap<class AFGBuildable*, TSet<class AEfficiencyCheckerBuilding*>> checkersByBuildable;
+
+    // Queues a refresh of the checker, to be run by Tick within the frame budget. Checkers already queued are not queued again
+    void requestUpdate(class AEfficiencyCheckerBuilding* checker);
+
+    // Drops the queued and the running refresh of the checker
+    void cancelUpdate(class AEfficiencyCheckerBuilding* checker);
+
+    // Queued checkers, taken from pendingUpdatesHead on. Cancelled entries stay behind and are skipped, as only the checkers
+    // on pendingUpdatesSet are still queued
+    TArray<class AEfficiencyCheckerBuilding*> pendingUpdates;
+    int32 pendingUpdatesHead = 0;
+    TSet<class AEfficiencyCheckerBuilding*> pendingUpdatesSet;
+
+    // Refresh being run by Tick, that may be suspended across several ticks
+    TUniquePtr<FEfficiencyCheckerUpdateJob> currentUpdate;
+
+    // One refresh after the other on the game thread
+    void runSequentialUpdates(double deadline);
+
+    // Bumped whenever indexed buildables are built or removed. A suspended refresh started on an older version is
+    // restarted if it went through any of changedBuildables
+    int32 graphVersion = 0;
+
+    // Buildables built or removed while a refresh was suspended, with the ones connected to them
+    TSet<class AFGBuildable*> changedBuildables;
+
+    // Bumps graphVersion, recording the node and its neighbours for the suspended refresh
+    void noteGraphChange(int32 nodeIndex);
+
+    // Rates of every belt and pipe when useFlowField is enabled. Built on the first read, and kept up to date with the
+    // edits recorded on it
+    FEfficiencyCheckerFlowField flowField;
+
+    // Values of the belt or pipe from the flow field, applying the pending edits first. False when they are not resolved there
+    bool getFlowValues(const AActor* buildable, FEfficiencyCheckerFlowValues& out_values, TSet<class AFGBuildable*>& out_connected);
+
+    // Bumped along with graphVersion, but only when belts or conveyor attachments are built or removed
+    int32 conveyorVersion = 0;
+
+    // Conveyor loops, found again on the first read after the conveyors changed
+    FEfficiencyCheckerLoops loops;
+    int32 loopsVersion = INDEX_NONE;
+
+    // Loop the belt or attachment belongs to, when condenseLoops is enabled
+    const FEfficiencyCheckerLoop* getLoop(const AActor* actor);
+
+    // Narrowest cut between the boundary of its loop and the member (see FEfficiencyCheckerLoops::getCut)
+    FEfficiencyCheckerLoopCut getLoopCut(const AActor* member, bool input);
+
+    // Compiled sort rules of the smart splitters, dropped when their rules change
+    TMap<const AActor*, TSharedPtr<const FEfficiencyCheckerSortRules>> sortRules;
+
+    // Sort rules of the smart splitter. They are only kept with autoUpdate, as the rule changes are not hooked without it
+    TSharedPtr<const FEfficiencyCheckerSortRules> getSortRules(class AFGBuildableSplitterSmart* smartSplitter);
+    void invalidateSortRules(const AActor* smartSplitter);
+
+    // Pipe networks, each one collected on its first read and dropped when a buildable joins or leaves it
+    FEfficiencyCheckerPipeNetworks pipeNetworks;
+
+    // Pipe network the fluid integrant belongs to, when aggregatePipeNetworks is enabled
+    TSharedPtr<const FEfficiencyCheckerPipeNetwork> getPipeNetwork(const AActor* actor);
+
+    // Narrowest cut between one side of the boundary of its pipe network and the member (see
+    // FEfficiencyCheckerPipeNetworks::getCut)
+    FEfficiencyCheckerPipeCut getPipeNetworkCut(const AActor* member, bool input);
+
+    // Linear runs of belts, lifts and plain attachments, each one collected on its first read and dropped when any of
+    // its members or their connections change
+    FEfficiencyCheckerChains chains;
+
+    // Chain the belt or attachment belongs to, and its position there, when compressChains is enabled
+    TSharedPtr<const FEfficiencyCheckerChain> getChain(const AActor* actor, int32& out_position);
+
+    // Belt and pipe components, with the version of their last change
+    FEfficiencyCheckerComponents components;
+
+    // Records a change of the buildable, like a recipe or a new connection, on its component. A buildable that can't be
+    // indexed yet but has connections changes every component, as what it connects to is not known
+    void touchComponents(class AFGBuildable* buildable);
+
+    // Whether anything the buildables belong to changed after version (FEfficiencyCheckerComponents::getLastVersion)
+    bool haveComponentsChanged(const TSet<class AFGBuildable*>& buildables, int32 version);
+
+    // Cargo platforms linked by trains, for each cargo platform the traversals went through
+    FEfficiencyCheckerRailroadRoutes railroadRoutes;
+
+    TArray<class AFGBuildableTrainPlatformCargo*> getLinkedCargoPlatforms(class AFGBuildableTrainPlatformCargo* cargoPlatform, const FString& indent);
+
+    // Input sub-walks shared by every traversal when cacheSubWalks is enabled
+    FEfficiencyCheckerSubWalkCache subWalks;
+
+    // Cached sub-walk for the key, if any, and the epoch to store it with when it is walked instead
+    TSharedPtr<const FEfficiencyCheckerSubWalk> findSubWalk(const FEfficiencyCheckerSubWalkKey& key, int32& out_epoch);
+    void addSubWalk(const FEfficiencyCheckerSubWalkKey& key, FEfficiencyCheckerSubWalk&& walk, int32 epoch);
+
+    // Drops the cached sub-walks that went through the buildable. With neighbours, also the ones that went through
+    // anything it is connected to, as they may stop where it was built
+    void invalidateSubWalks(AActor* buildable, bool neighbours = false);
+
+    void addCheckerDependencies(class AEfficiencyCheckerBuilding* checker, const TSet<class AFGBuildable*>& buildables);
+    void removeCheckerDependencies(class AEfficiencyCheckerBuilding* checker, const TSet<class AFGBuildable*>& buildables);
+
+    TSet<class AEfficiencyCheckerBuilding*> getDependentCheckers(class AFGBuildable* buildable);
+
+    // Checkers that can be affected by a newly built buildable: the ones using anything it connects to, and the ones with no connections yet
+    TSet<class AEfficiencyCheckerBuilding*> getCheckersAffectedByNewBuildable(class AFGBuildable* newBuildable);
+
     FActorEndPlaySignature::FDelegate removeEffiencyBuildingDelegate;
     FActorEndPlaySignature::FDelegate removeBeltDelegate;
     FActorEndPlaySignature::FDelegate removePipeDelegate;
     FActorEndPlaySignature::FDelegate removeTeleporterDelegate;
+    FActorEndPlaySignature::FDelegate removeBuildableDelegate;
 
     virtual void addEfficiencyBuilding(class AEfficiencyCheckerBuilding* actor);
     virtual void addBelt(AFGBuildableConveyorBelt* actor);
     virtual void addPipe(AFGBuildablePipeline* actor);
     virtual void addTeleporter(AFGBuildable* actor);
+    virtual void addBuildable(AFGBuildable* actor);
 
     UFUNCTION()
     virtual void removeEfficiencyBuilding(AActor* actor, EEndPlayReason::Type reason);
@@ -113,4 +343,6 @@ public:
     virtual void removePipe(AActor* actor, EEndPlayReason::Type reason);
     UFUNCTION()
     virtual void removeTeleporter(AActor* actor, EEndPlayReason::Type reason);
+    UFUNCTION()
+    virtual void removeBuildable(AActor* actor, EEndPlayReason::Type reason);
 };
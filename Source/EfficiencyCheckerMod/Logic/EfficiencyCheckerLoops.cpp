@@ -0,0 +1,231 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerLoops.h"
+#include "EfficiencyCheckerMaxFlow.h"
+#include "EfficiencyCheckerTarjan.h"
+
+#include "FGBuildableConveyorBase.h"
+#include "FGFactoryConnectionComponent.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+void FEfficiencyCheckerLoops::build(const FEfficiencyCheckerGraph& graph)
+{
+	Empty();
+
+	const auto& nodes = graph.getNodes();
+
+	TArray<int32> roots;
+
+	for (auto it = nodes.CreateConstIterator(); it; ++it)
+	{
+		if (isLoopCarrier(it->classFlags))
+		{
+			roots.Add(it.GetIndex());
+		}
+	}
+
+	// Node indexes of the loop members, to tell the boundary connections apart
+	TMap<int32, int32> loopByNode;
+	TMap<int32, int32> memberByNode;
+
+	findStronglyConnectedComponents(
+		roots,
+		[&graph, &nodes](int32 nodeIndex, TArray<int32>& out_successors)
+		{
+			for (auto connection : nodes[nodeIndex].factoryConnections)
+			{
+				if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT ||
+					connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+				{
+					continue;
+				}
+
+				const auto target = graph.findConnectedNode(connection);
+
+				if (target != INDEX_NONE && isLoopCarrier(nodes[target].classFlags))
+				{
+					out_successors.Add(target);
+				}
+			}
+		},
+		[this, &nodes, &loopByNode, &memberByNode](const TArray<int32>& members)
+		{
+			if (members.Num() < 2)
+			{
+				// A single buildable can't feed itself
+				return;
+			}
+
+			const auto loopIndex = loops.AddDefaulted();
+			auto& loop = loops[loopIndex];
+
+			for (auto member : members)
+			{
+				const auto& node = nodes[member];
+
+				const auto memberIndex = loop.members.Add(node.buildable);
+
+				loop.capacities.Add(
+					EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::ConveyorBase)
+						? static_cast<AFGBuildableConveyorBase*>(node.buildable)->GetSpeed() / 2
+						: FEfficiencyCheckerMaxFlow::unlimited
+					);
+
+				loop.successors.AddDefaulted();
+
+				loopByNode.Add(member, loopIndex);
+				memberByNode.Add(member, memberIndex);
+				loopByActor.Add(node.buildable, loopIndex);
+				memberByActor.Add(node.buildable, memberIndex);
+			}
+		}
+		);
+
+	for (const auto& entry : loopByNode)
+	{
+		auto& loop = loops[entry.Value];
+		const auto memberIndex = memberByNode[entry.Key];
+
+		for (auto connection : nodes[entry.Key].factoryConnections)
+		{
+			if (!connection->IsConnected() || connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+			{
+				continue;
+			}
+
+			const auto target = graph.findConnectedNode(connection);
+
+			const auto otherLoop = loopByNode.Find(target);
+			if (otherLoop && *otherLoop == entry.Value)
+			{
+				if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
+				{
+					loop.successors[memberIndex].Add(memberByNode[target]);
+				}
+
+				continue;
+			}
+
+			if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT)
+			{
+				loop.entering.Add(connection);
+				loop.enteringMembers.Add(memberIndex);
+			}
+			else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
+			{
+				loop.leaving.Add(connection);
+				loop.leavingMembers.Add(memberIndex);
+			}
+		}
+	}
+}
+
+const FEfficiencyCheckerLoop* FEfficiencyCheckerLoops::findLoop(const AActor* actor) const
+{
+	const auto loopIndex = loopByActor.Find(actor);
+
+	return loopIndex ? &loops[*loopIndex] : nullptr;
+}
+
+const FEfficiencyCheckerLoopCut& FEfficiencyCheckerLoops::getCut(const AActor* member, bool input)
+{
+	auto& cuts = input ? inputCuts : outputCuts;
+
+	const auto cached = cuts.Find(member);
+	if (cached)
+	{
+		return *cached;
+	}
+
+	auto& cut = cuts.Add(member);
+
+	const auto loopIndex = loopByActor.Find(member);
+	if (!loopIndex)
+	{
+		return cut;
+	}
+
+	const auto& loop = loops[*loopIndex];
+
+	FEfficiencyCheckerMaxFlow network;
+
+	// Super source when walking input, super sink when walking output
+	const auto terminal = network.addVertex();
+
+	// Each member is split in an input and an output vertex, joined by an edge that carries its own speed. The output
+	// vertex is always the next one
+	const auto firstVertex = network.Num();
+
+	for (auto capacity : loop.capacities)
+	{
+		network.addEdge(network.addVertex(), network.addVertex(), capacity);
+	}
+
+	for (auto i = 0; i < loop.successors.Num(); i++)
+	{
+		for (auto successor : loop.successors[i])
+		{
+			network.addEdge(firstVertex + i * 2 + 1, firstVertex + successor * 2, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+	}
+
+	const auto memberVertex = firstVertex + memberByActor[member] * 2;
+
+	if (input)
+	{
+		for (auto enteringMember : loop.enteringMembers)
+		{
+			network.addEdge(terminal, firstVertex + enteringMember * 2, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+
+		cut.capacity = network.solve(terminal, memberVertex + 1);
+	}
+	else
+	{
+		for (auto leavingMember : loop.leavingMembers)
+		{
+			network.addEdge(firstVertex + leavingMember * 2 + 1, terminal, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+
+		cut.capacity = network.solve(memberVertex, terminal);
+	}
+
+	if (cut.capacity >= FEfficiencyCheckerMaxFlow::unlimited)
+	{
+		return cut;
+	}
+
+	// The saturated members between what the source still reaches and what it doesn't make the cut
+	for (auto i = 0; i < loop.members.Num(); i++)
+	{
+		if (network.isReachable(firstVertex + i * 2) && !network.isReachable(firstVertex + i * 2 + 1))
+		{
+			cut.segments.Add(loop.members[i]);
+			cut.segmentCapacities.Add(loop.capacities[i]);
+		}
+	}
+
+	return cut;
+}
+
+void FEfficiencyCheckerLoops::Empty()
+{
+	loops.Empty();
+	loopByActor.Empty();
+	memberByActor.Empty();
+	inputCuts.Empty();
+	outputCuts.Empty();
+}
+
+bool FEfficiencyCheckerLoops::isLoopCarrier(EEfficiencyCheckerClassFlags classFlags)
+{
+	return EnumHasAnyFlags(classFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment) &&
+		!EnumHasAnyFlags(classFlags, EEfficiencyCheckerClassFlags::Storage | EEfficiencyCheckerClassFlags::DockingStation | EEfficiencyCheckerClassFlags::StorageTeleporter);
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+
+class AActor;
+class AFGBuildable;
+class UFGFactoryConnectionComponent;
+
+// Belts and conveyor attachments that can all reach each other, like overflow and sushi loops
+struct FEfficiencyCheckerLoop
+{
+    TArray<AFGBuildable*> members;
+
+    // Speed of each member in items/minute. Attachments are not limited by themselves
+    TArray<float> capacities;
+
+    // Members each member feeds, by index on members
+    TArray<TArray<int32>> successors;
+
+    // Input connections of the members that are fed from outside the loop, and the index of their member
+    TArray<UFGFactoryConnectionComponent*> entering;
+    TArray<int32> enteringMembers;
+
+    // Output connections of the members that feed something outside the loop, and the index of their member
+    TArray<UFGFactoryConnectionComponent*> leaving;
+    TArray<int32> leavingMembers;
+};
+
+// Narrowest cut of a loop between its boundary and one of its members
+struct FEfficiencyCheckerLoopCut
+{
+    // FLT_MAX when there is a way through the loop with no belt on it
+    float capacity = FLT_MAX;
+
+    // Belts on the cut, and their speed
+    TArray<AActor*> segments;
+    TArray<float> segmentCapacities;
+};
+
+/**
+ * Conveyor loops of the indexed graph, found with one strongly connected components pass, so that the traversals can
+ * take each loop as a single node instead of walking it once per branch.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerLoops
+{
+public:
+    void build(const FEfficiencyCheckerGraph& graph);
+
+    // Loop the actor belongs to, if any
+    const FEfficiencyCheckerLoop* findLoop(const AActor* actor) const;
+
+    // Most that goes through the loop from its entering connections into the member when walking input, or from the
+    // member into its leaving connections when walking output. Solved as a maximum flow on the first read
+    const FEfficiencyCheckerLoopCut& getCut(const AActor* member, bool input);
+
+    inline int32
+    Num() const
+    {
+        return loops.Num();
+    }
+
+    void Empty();
+
+protected:
+    // Belts and plain conveyor attachments. Storages and stations hold their own inventory, and are walked as they are
+    static bool isLoopCarrier(EEfficiencyCheckerClassFlags classFlags);
+
+    TArray<FEfficiencyCheckerLoop> loops;
+    TMap<const AActor*, int32> loopByActor;
+
+    // Index of each actor on the members of its loop
+    TMap<const AActor*, int32> memberByActor;
+
+    TMap<const AActor*, FEfficiencyCheckerLoopCut> inputCuts;
+    TMap<const AActor*, FEfficiencyCheckerLoopCut> outputCuts;
+};
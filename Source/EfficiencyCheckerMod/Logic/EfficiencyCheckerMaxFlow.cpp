@@ -0,0 +1,164 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerMaxFlow.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+int32 FEfficiencyCheckerMaxFlow::addVertex()
+{
+	return adjacency.AddDefaulted();
+}
+
+void FEfficiencyCheckerMaxFlow::addEdge(int32 from, int32 to, float capacity)
+{
+	if (from == to || capacity <= 0)
+	{
+		return;
+	}
+
+	adjacency[from].Add(edges.Num());
+	edges.Add(FEdge{to, capacity});
+
+	adjacency[to].Add(edges.Num());
+	edges.Add(FEdge{from, 0});
+}
+
+float FEfficiencyCheckerMaxFlow::solve(int32 source, int32 sink)
+{
+	if (source == sink || !adjacency.IsValidIndex(source) || !adjacency.IsValidIndex(sink))
+	{
+		return 0;
+	}
+
+	float totalFlow = 0;
+
+	// Edges from the source to the current vertex
+	TArray<int32> path;
+
+	while (buildLevels(source, sink))
+	{
+		nextEdge.Init(0, adjacency.Num());
+		path.Reset();
+
+		auto vertex = source;
+
+		for (;;)
+		{
+			if (vertex == sink)
+			{
+				auto pushed = unlimited;
+
+				for (auto edgeIndex : path)
+				{
+					pushed = FMath::Min(pushed, edges[edgeIndex].residual);
+				}
+
+				if (pushed >= unlimited)
+				{
+					return unlimited;
+				}
+
+				for (auto edgeIndex : path)
+				{
+					edges[edgeIndex].residual -= pushed;
+					edges[edgeIndex ^ 1].residual += pushed;
+				}
+
+				totalFlow += pushed;
+
+				// Back off to the tail of the first saturated edge, and go on from there
+				auto saturated = 0;
+				while (saturated < path.Num() - 1 && edges[path[saturated]].residual > KINDA_SMALL_NUMBER)
+				{
+					saturated++;
+				}
+
+				path.SetNum(saturated, false);
+
+				vertex = path.Num() ? edges[path.Last()].to : source;
+
+				continue;
+			}
+
+			const auto& vertexEdges = adjacency[vertex];
+			auto& next = nextEdge[vertex];
+
+			while (next < vertexEdges.Num())
+			{
+				const auto& edge = edges[vertexEdges[next]];
+
+				if (edge.residual > KINDA_SMALL_NUMBER && levels[edge.to] == levels[vertex] + 1)
+				{
+					break;
+				}
+
+				next++;
+			}
+
+			if (next < vertexEdges.Num())
+			{
+				const auto edgeIndex = vertexEdges[next];
+
+				path.Push(edgeIndex);
+				vertex = edges[edgeIndex].to;
+
+				continue;
+			}
+
+			// Dead end. It is not tried again on this level graph
+			if (vertex == source)
+			{
+				break;
+			}
+
+			levels[vertex] = INDEX_NONE;
+
+			path.Pop(false);
+
+			vertex = path.Num() ? edges[path.Last()].to : source;
+		}
+	}
+
+	return totalFlow;
+}
+
+void FEfficiencyCheckerMaxFlow::Empty()
+{
+	edges.Empty();
+	adjacency.Empty();
+	levels.Empty();
+	nextEdge.Empty();
+}
+
+bool FEfficiencyCheckerMaxFlow::buildLevels(int32 source, int32 sink)
+{
+	levels.Init(INDEX_NONE, adjacency.Num());
+	levels[source] = 0;
+
+	TArray<int32> queue;
+	queue.Add(source);
+
+	for (auto queueIndex = 0; queueIndex < queue.Num(); queueIndex++)
+	{
+		const auto vertex = queue[queueIndex];
+
+		for (auto edgeIndex : adjacency[vertex])
+		{
+			const auto& edge = edges[edgeIndex];
+
+			if (edge.residual > KINDA_SMALL_NUMBER && levels[edge.to] == INDEX_NONE)
+			{
+				levels[edge.to] = levels[vertex] + 1;
+				queue.Add(edge.to);
+			}
+		}
+	}
+
+	return levels[sink] != INDEX_NONE;
+}
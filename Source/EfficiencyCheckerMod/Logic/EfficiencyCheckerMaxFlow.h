@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Capacitated flow network solved with Dinic's algorithm. Level graphs are built breadth first, and blocking flows are
+ * found with an explicit path stack instead of native recursion, as belt lines can be very long.
+ * Capacities are in the same unit as the throughputs (items/minute or m³/minute).
+ */
+class FEfficiencyCheckerMaxFlow
+{
+public:
+    // Capacity of the edges that don't limit anything
+    static constexpr float unlimited = FLT_MAX;
+
+    int32 addVertex();
+
+    void addEdge(int32 from, int32 to, float capacity);
+
+    // Maximum flow from source to sink. unlimited when there is a path with no limited edge
+    float solve(int32 source, int32 sink);
+
+    // After a limited solve, whether the vertex is still reachable from the source on the residual graph. Edges from
+    // reachable to unreachable vertices make a minimum cut
+    inline bool
+    isReachable(int32 vertex) const
+    {
+        return levels.IsValidIndex(vertex) && levels[vertex] != INDEX_NONE;
+    }
+
+    inline int32
+    Num() const
+    {
+        return adjacency.Num();
+    }
+
+    void Empty();
+
+protected:
+    struct FEdge
+    {
+        int32 to = INDEX_NONE;
+        float residual = 0;
+    };
+
+    // Builds the levels of the residual graph. False when the sink can't be reached anymore
+    bool buildLevels(int32 source, int32 sink);
+
+    // Edges are added in pairs, so the reverse of edge e is e ^ 1
+    TArray<FEdge> edges;
+    TArray<TArray<int32>> adjacency;
+
+    TArray<int32> levels;
+    TArray<int32> nextEdge;
+};
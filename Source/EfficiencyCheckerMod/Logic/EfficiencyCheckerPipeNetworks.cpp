@@ -0,0 +1,325 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerPipeNetworks.h"
+#include "EfficiencyCheckerLogic.h"
+#include "EfficiencyCheckerMaxFlow.h"
+
+#include "FGBuildablePipeline.h"
+#include "FGPipeConnectionComponent.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+TSharedPtr<const FEfficiencyCheckerPipeNetwork> FEfficiencyCheckerPipeNetworks::findNetwork
+(
+	const FEfficiencyCheckerGraph& graph,
+	const AActor* actor
+)
+{
+	const auto networkID = networkByActor.Find(actor);
+	if (networkID)
+	{
+		return networks.FindRef(*networkID);
+	}
+
+	const auto nodeIndex = graph.findNode(actor);
+	const auto node = graph.getNode(nodeIndex);
+	if (!node || !EnumHasAnyFlags(node->classFlags, EEfficiencyCheckerClassFlags::FluidIntegrant))
+	{
+		return nullptr;
+	}
+
+	auto network = collectNetwork(graph, nodeIndex);
+	if (!network)
+	{
+		return nullptr;
+	}
+
+	// A stale entry left with the same ID would share its members
+	removeNetwork(network->networkID);
+
+	for (auto i = 0; i < network->members.Num(); i++)
+	{
+		networkByActor.Add(network->members[i], network->networkID);
+		memberByActor.Add(network->members[i], i);
+	}
+
+	networks.Add(network->networkID, network);
+
+	return network;
+}
+
+const FEfficiencyCheckerPipeCut& FEfficiencyCheckerPipeNetworks::getCut
+(
+	const FEfficiencyCheckerGraph& graph,
+	const AActor* member,
+	bool input
+)
+{
+	auto& cuts = input ? inputCuts : outputCuts;
+
+	const auto cached = cuts.Find(member);
+	if (cached)
+	{
+		return *cached;
+	}
+
+	const auto network = findNetwork(graph, member);
+
+	auto& cut = cuts.Add(member);
+
+	if (!network)
+	{
+		return cut;
+	}
+
+	FEfficiencyCheckerMaxFlow flowNetwork;
+
+	// Super source when walking input, super sink when walking output
+	const auto terminal = flowNetwork.addVertex();
+
+	// Each member is split in an input and an output vertex, joined by an edge that carries its own flow limit. The
+	// output vertex is always the next one
+	const auto firstVertex = flowNetwork.Num();
+
+	for (auto capacity : network->capacities)
+	{
+		flowNetwork.addEdge(flowNetwork.addVertex(), flowNetwork.addVertex(), capacity);
+	}
+
+	// Each connection is seen from both of its ends, so it is added both ways
+	for (auto i = 0; i < network->neighbours.Num(); i++)
+	{
+		for (auto neighbour : network->neighbours[i])
+		{
+			flowNetwork.addEdge(firstVertex + i * 2 + 1, firstVertex + neighbour * 2, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+	}
+
+	const auto memberVertex = firstVertex + memberByActor[member] * 2;
+
+	if (input)
+	{
+		for (auto inputMember : network->inputMembers)
+		{
+			flowNetwork.addEdge(terminal, firstVertex + inputMember * 2, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+
+		cut.capacity = flowNetwork.solve(terminal, memberVertex + 1);
+	}
+	else
+	{
+		for (auto outputMember : network->outputMembers)
+		{
+			flowNetwork.addEdge(firstVertex + outputMember * 2 + 1, terminal, FEfficiencyCheckerMaxFlow::unlimited);
+		}
+
+		cut.capacity = flowNetwork.solve(memberVertex, terminal);
+	}
+
+	if (cut.capacity >= FEfficiencyCheckerMaxFlow::unlimited)
+	{
+		return cut;
+	}
+
+	// The saturated pipes between what the source still reaches and what it doesn't make the cut
+	for (auto i = 0; i < network->members.Num(); i++)
+	{
+		if (flowNetwork.isReachable(firstVertex + i * 2) && !flowNetwork.isReachable(firstVertex + i * 2 + 1))
+		{
+			cut.segments.Add(network->members[i]);
+			cut.segmentCapacities.Add(network->capacities[i]);
+		}
+	}
+
+	return cut;
+}
+
+void FEfficiencyCheckerPipeNetworks::invalidateNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex)
+{
+	const auto node = graph.getNode(nodeIndex);
+	if (!node || !node->pipeConnections.Num())
+	{
+		return;
+	}
+
+	const auto networkID = networkByActor.Find(node->buildable);
+	if (networkID)
+	{
+		removeNetwork(*networkID);
+	}
+
+	for (auto connection : node->pipeConnections)
+	{
+		removeNetwork(connection->GetPipeNetworkID());
+
+		const auto otherNode = graph.getNode(graph.findConnectedNode(connection));
+		if (!otherNode)
+		{
+			continue;
+		}
+
+		const auto otherNetworkID = networkByActor.Find(otherNode->buildable);
+		if (otherNetworkID)
+		{
+			removeNetwork(*otherNetworkID);
+		}
+	}
+}
+
+void FEfficiencyCheckerPipeNetworks::Empty()
+{
+	networks.Empty();
+	networkByActor.Empty();
+	memberByActor.Empty();
+	inputCuts.Empty();
+	outputCuts.Empty();
+}
+
+void FEfficiencyCheckerPipeNetworks::removeNetwork(int32 networkID)
+{
+	TSharedPtr<const FEfficiencyCheckerPipeNetwork> network;
+	if (networkID == INDEX_NONE || !networks.RemoveAndCopyValue(networkID, network))
+	{
+		return;
+	}
+
+	for (auto member : network->members)
+	{
+		const auto memberNetworkID = networkByActor.Find(member);
+		if (memberNetworkID && *memberNetworkID == networkID)
+		{
+			networkByActor.Remove(member);
+			memberByActor.Remove(member);
+			inputCuts.Remove(member);
+			outputCuts.Remove(member);
+		}
+	}
+}
+
+TSharedPtr<FEfficiencyCheckerPipeNetwork> FEfficiencyCheckerPipeNetworks::collectNetwork
+(
+	const FEfficiencyCheckerGraph& graph,
+	int32 nodeIndex
+) const
+{
+	auto network = MakeShared<FEfficiencyCheckerPipeNetwork>();
+
+	TSet<int32> seenNodes;
+	TArray<int32> pending;
+
+	// Index on members of each node collected, and the pairs of nodes connected to each other
+	TMap<int32, int32> memberByNode;
+	TArray<TPair<int32, int32>> links;
+
+	seenNodes.Add(nodeIndex);
+	pending.Add(nodeIndex);
+
+	while (pending.Num())
+	{
+		const auto currentIndex = pending.Pop(false);
+		const auto& node = *graph.getNode(currentIndex);
+
+		const auto memberIndex = network->members.Add(node.buildable);
+		memberByNode.Add(currentIndex, memberIndex);
+
+		network->capacities.Add(
+			EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::Pipeline)
+				? AEfficiencyCheckerLogic::getPipeSpeed(static_cast<AFGBuildablePipeline*>(node.buildable))
+				: FLT_MAX
+			);
+
+		if (EnumHasAnyFlags(node.classFlags, EEfficiencyCheckerClassFlags::PipelinePump))
+		{
+			network->pumps.Add(node.buildable);
+		}
+
+		for (auto connection : node.pipeConnections)
+		{
+			if (!connection->IsConnected())
+			{
+				continue;
+			}
+
+			const auto networkID = connection->GetPipeNetworkID();
+
+			if (networkID == INDEX_NONE || network->networkID != INDEX_NONE && network->networkID != networkID)
+			{
+				// The game didn't settle the network yet
+				return nullptr;
+			}
+
+			network->networkID = networkID;
+
+			const auto otherIndex = graph.findConnectedNode(connection);
+			const auto otherNode = graph.getNode(otherIndex);
+
+			if (!otherNode)
+			{
+				// Unknown on the other side
+				return nullptr;
+			}
+
+			if (EnumHasAnyFlags(otherNode->classFlags, EEfficiencyCheckerClassFlags::FluidIntegrant))
+			{
+				links.Emplace(currentIndex, otherIndex);
+
+				if (!seenNodes.Contains(otherIndex))
+				{
+					seenNodes.Add(otherIndex);
+					pending.Add(otherIndex);
+				}
+
+				continue;
+			}
+
+			network->boundary.Add(connection);
+
+			if (connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
+			{
+				network->inputs.Add(connection);
+				network->inputMembers.AddUnique(memberIndex);
+			}
+
+			if (connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER)
+			{
+				network->outputs.Add(connection);
+				network->outputMembers.AddUnique(memberIndex);
+			}
+
+			switch (connection->GetPipeConnection()->GetPipeConnectionType())
+			{
+			case EPipeConnectionType::PCT_PRODUCER:
+				network->producers++;
+				break;
+
+			case EPipeConnectionType::PCT_CONSUMER:
+				network->consumers++;
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	if (network->networkID == INDEX_NONE)
+	{
+		// Nothing connected
+		return nullptr;
+	}
+
+	network->neighbours.SetNum(network->members.Num());
+
+	for (const auto& link : links)
+	{
+		network->neighbours[memberByNode[link.Key]].AddUnique(memberByNode[link.Value]);
+	}
+
+	return network;
+}
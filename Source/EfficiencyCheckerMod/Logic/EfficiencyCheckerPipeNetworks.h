@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+
+class AActor;
+class AFGBuildable;
+class UFGPipeConnectionComponent;
+
+// Narrowest cut of a pipe network between one side of its boundary and one of its members
+struct FEfficiencyCheckerPipeCut
+{
+    // Summed flow limit of the pipes, in m3/minute. FLT_MAX when there is a way through the network with no pipe on it
+    float capacity = FLT_MAX;
+
+    // Pipes on the cut, and their flow limit
+    TArray<AActor*> segments;
+    TArray<float> segmentCapacities;
+};
+
+// Pipes and other fluid integrants sharing a pipe network of the game
+struct FEfficiencyCheckerPipeNetwork
+{
+    int32 networkID = INDEX_NONE;
+
+    TArray<AFGBuildable*> members;
+
+    // Flow limit of each member in m3/minute. Unlimited for anything that is not a pipe
+    TArray<float> capacities;
+
+    // Members each member is connected to, by index on members. Fluids go both ways
+    TArray<TArray<int32>> neighbours;
+
+    TArray<AFGBuildable*> pumps;
+
+    // Connections of the members to the producers, consumers and anything else outside the network
+    TArray<UFGPipeConnectionComponent*> boundary;
+
+    // Boundary connections that can be fed from outside, walked as input, and the ones that can feed outside, walked
+    // as output
+    TArray<UFGPipeConnectionComponent*> inputs;
+    TArray<UFGPipeConnectionComponent*> outputs;
+
+    // Index of the members holding the input and the output connections
+    TArray<int32> inputMembers;
+    TArray<int32> outputMembers;
+
+    // How many of the boundary connections lead to a producer or a consumer connection
+    int32 producers = 0;
+    int32 consumers = 0;
+};
+
+/**
+ * Pipe networks of the indexed graph, keyed by the network ID the game gives them, so that the traversals can take a
+ * whole network as a single node instead of walking it pipe by pipe.
+ *
+ * A network is collected on the first read, from the pipe connections of the graph, and dropped when a buildable
+ * joins or leaves it. Networks whose members don't all share the same ID yet, or that reach something that is not
+ * indexed, are not kept, and are walked as they are.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerPipeNetworks
+{
+public:
+    // Network the fluid integrant belongs to, if it can be collected
+    TSharedPtr<const FEfficiencyCheckerPipeNetwork> findNetwork(const FEfficiencyCheckerGraph& graph, const AActor* actor);
+
+    // Most that goes through the network from its input connections into the member when walking input, or from the
+    // member into its output connections when walking output. Solved as a maximum flow on the first read
+    const FEfficiencyCheckerPipeCut& getCut(const FEfficiencyCheckerGraph& graph, const AActor* member, bool input);
+
+    // Drops the networks of the node and of what it connects to, as it is joining or leaving them
+    void invalidateNode(const FEfficiencyCheckerGraph& graph, int32 nodeIndex);
+
+    inline int32
+    Num() const
+    {
+        return networks.Num();
+    }
+
+    void Empty();
+
+protected:
+    void removeNetwork(int32 networkID);
+
+    // Collects the network from the node. Null when it can't be taken as a whole
+    TSharedPtr<FEfficiencyCheckerPipeNetwork> collectNetwork(const FEfficiencyCheckerGraph& graph, int32 nodeIndex) const;
+
+    TMap<int32, TSharedPtr<const FEfficiencyCheckerPipeNetwork>> networks;
+    TMap<const AActor*, int32> networkByActor;
+
+    // Index of each actor on the members of its network
+    TMap<const AActor*, int32> memberByActor;
+
+    TMap<const AActor*, FEfficiencyCheckerPipeCut> inputCuts;
+    TMap<const AActor*, FEfficiencyCheckerPipeCut> outputCuts;
+};
@@ -0,0 +1,325 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerRailroadRoutes.h"
+#include "EfficiencyCheckerLogic.h"
+#include "EfficiencyCheckerModModule.h"
+
+#include "FGBuildableRailroadStation.h"
+#include "FGBuildableTrainPlatformCargo.h"
+#include "FGRailroadSubsystem.h"
+#include "FGRailroadTimeTable.h"
+#include "FGTrain.h"
+#include "FGTrainStationIdentifier.h"
+
+#include "SML/util/Logging.h"
+
+#include "Util/Optimize.h"
+
+#include <set>
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+TArray<AFGBuildableTrainPlatformCargo*> FEfficiencyCheckerRailroadRoutes::getLinkedCargoPlatforms
+(
+	AFGBuildableTrainPlatformCargo* cargoPlatform,
+	const FString& indent
+)
+{
+	const auto trackId = cargoPlatform->GetTrackGraphID();
+	const auto timetables = getTimetablesFingerprint(cargoPlatform->GetWorld(), trackId);
+
+	auto route = routes.Find(cargoPlatform);
+	if (route && route->trackId == trackId && route->timetables == timetables)
+	{
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			SML::Logging::info(
+				*AEfficiencyCheckerLogic::getTimeStamp(),
+				*indent,
+				TEXT("Cached route with "),
+				route->linkedCargoPlatforms.Num(),
+				TEXT(" linked cargo platforms")
+				);
+		}
+
+		return route->linkedCargoPlatforms;
+	}
+
+	route = &routes.FindOrAdd(cargoPlatform);
+	route->trackId = trackId;
+	route->timetables = timetables;
+	route->linkedCargoPlatforms = findLinkedCargoPlatforms(cargoPlatform, indent);
+
+	return route->linkedCargoPlatforms;
+}
+
+void FEfficiencyCheckerRailroadRoutes::invalidatePlatforms()
+{
+	routes.Empty();
+}
+
+bool FEfficiencyCheckerRailroadRoutes::invalidateChangedTimetables(UWorld* world)
+{
+	auto changed = false;
+
+	for (auto it = routes.CreateIterator(); it; ++it)
+	{
+		if (getTimetablesFingerprint(world, it->Value.trackId) != it->Value.timetables)
+		{
+			it.RemoveCurrent();
+
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+void FEfficiencyCheckerRailroadRoutes::Empty()
+{
+	routes.Empty();
+	timetablesByTrack.Empty();
+}
+
+uint32 FEfficiencyCheckerRailroadRoutes::getTimetablesFingerprint(UWorld* world, int32 trackId)
+{
+	auto& trackTimetables = timetablesByTrack.FindOrAdd(trackId);
+	if (trackTimetables.frame == GFrameCounter)
+	{
+		return trackTimetables.fingerprint;
+	}
+
+	uint32 fingerprint = GetTypeHash(trackId);
+
+	TArray<AFGTrain*> trains;
+	AFGRailroadSubsystem::Get(world)->GetTrains(trackId, trains);
+
+	TArray<FTimeTableStop> stops;
+
+	for (auto train : trains)
+	{
+		fingerprint = HashCombine(fingerprint, GetTypeHash(train));
+
+		if (!train->HasTimeTable())
+		{
+			continue;
+		}
+
+		stops.Reset();
+		train->GetTimeTable()->GetStops(stops);
+
+		fingerprint = HashCombine(fingerprint, GetTypeHash(stops.Num()));
+
+		for (const auto& stop : stops)
+		{
+			fingerprint = HashCombine(fingerprint, GetTypeHash(stop.Station));
+			fingerprint = HashCombine(fingerprint, GetTypeHash(stop.Station ? stop.Station->GetStation() : nullptr));
+		}
+	}
+
+	trackTimetables.frame = GFrameCounter;
+	trackTimetables.fingerprint = fingerprint;
+
+	return fingerprint;
+}
+
+TArray<AFGBuildableTrainPlatformCargo*> FEfficiencyCheckerRailroadRoutes::findLinkedCargoPlatforms
+(
+	AFGBuildableTrainPlatformCargo* cargoPlatform,
+	const FString& indent
+)
+{
+	TArray<AFGBuildableTrainPlatformCargo*> linkedCargoPlatforms;
+
+	auto trackId = cargoPlatform->GetTrackGraphID();
+
+	auto railroadSubsystem = AFGRailroadSubsystem::Get(cargoPlatform->GetWorld());
+
+	// Determine offsets from all the connected stations
+	std::set<int> stationOffsets;
+	TSet<AFGBuildableRailroadStation*> destinationStations;
+
+	for (auto i = 0; i <= 1; i++)
+	{
+		auto offsetDistance = 1;
+
+		for (auto connectedPlatform = cargoPlatform->GetConnectedPlatformInDirectionOf(i);
+		     connectedPlatform;
+		     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
+		     ++offsetDistance)
+		{
+			if (FEfficiencyCheckerModModule::dumpConnections)
+			{
+				SML::Logging::info(
+					*AEfficiencyCheckerLogic::getTimeStamp(),
+					*indent,
+					*connectedPlatform->GetName(),
+					TEXT(" direction = "),
+					i,
+					TEXT(" / orientation reversed = "),
+					connectedPlatform->IsOrientationReversed() ? TEXT("true") : TEXT("false")
+					);
+			}
+
+			auto station = Cast<AFGBuildableRailroadStation>(connectedPlatform);
+			if (station)
+			{
+				destinationStations.Add(station);
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(
+						*AEfficiencyCheckerLogic::getTimeStamp(),
+						*indent,
+						TEXT("    Station = "),
+						*station->GetStationIdentifier()->GetStationName().ToString()
+						);
+				}
+
+				if (i == 0 && connectedPlatform->IsOrientationReversed() ||
+					i == 1 && !connectedPlatform->IsOrientationReversed())
+				{
+					stationOffsets.insert(offsetDistance);
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("        offset distance = "), offsetDistance);
+					}
+				}
+				else
+				{
+					stationOffsets.insert(-offsetDistance);
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("        offset distance = "), -offsetDistance);
+					}
+				}
+			}
+
+			if (FEfficiencyCheckerModModule::dumpConnections)
+			{
+				auto cargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
+				if (cargo)
+				{
+					SML::Logging::info(
+						*AEfficiencyCheckerLogic::getTimeStamp(),
+						*indent,
+						TEXT("    Load mode = "),
+						cargo->GetIsInLoadMode() ? TEXT("true") : TEXT("false")
+						);
+				}
+			}
+		}
+	}
+
+	TArray<AFGTrain*> trains;
+	railroadSubsystem->GetTrains(trackId, trains);
+
+	for (auto train : trains)
+	{
+		if (!train->HasTimeTable())
+		{
+			continue;
+		}
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			if (!train->GetTrainName().IsEmpty())
+			{
+				SML::Logging::info(
+					*AEfficiencyCheckerLogic::getTimeStamp(),
+					*indent,
+					TEXT("Train = "),
+					*train->GetTrainName().ToString()
+					);
+			}
+			else
+			{
+				SML::Logging::info(
+					*AEfficiencyCheckerLogic::getTimeStamp(),
+					*indent,
+					TEXT("Anonymous Train")
+					);
+			}
+		}
+
+		// Get train stations
+		auto timeTable = train->GetTimeTable();
+
+		TArray<FTimeTableStop> stops;
+		timeTable->GetStops(stops);
+
+		bool stopAtStations = false;
+
+		for (auto stop : stops)
+		{
+			if (!stop.Station || !stop.Station->GetStation() || !destinationStations.Contains(stop.Station->GetStation()))
+			{
+				continue;
+			}
+
+			stopAtStations = true;
+
+			break;
+		}
+
+		if (!stopAtStations)
+		{
+			continue;
+		}
+
+		for (auto stop : stops)
+		{
+			if (!stop.Station || !stop.Station->GetStation())
+			{
+				continue;
+			}
+
+			if (FEfficiencyCheckerModModule::dumpConnections)
+			{
+				SML::Logging::info(
+					*AEfficiencyCheckerLogic::getTimeStamp(),
+					*indent,
+					TEXT("    Stop = "),
+					*stop.Station->GetStationName().ToString()
+					);
+			}
+
+			for (auto i = 0; i <= 1; i++)
+			{
+				auto offsetDistance = 1;
+
+				for (auto connectedPlatform = stop.Station->GetStation()->GetConnectedPlatformInDirectionOf(i);
+				     connectedPlatform;
+				     connectedPlatform = connectedPlatform->GetConnectedPlatformInDirectionOf(i),
+				     ++offsetDistance)
+				{
+					auto stopCargo = Cast<AFGBuildableTrainPlatformCargo>(connectedPlatform);
+					if (!stopCargo || stopCargo == cargoPlatform)
+					{
+						// Not a cargo or the same as the current one. Skip
+						continue;
+					}
+
+					auto adjustedOffsetDistance = i == 0 && !stop.Station->GetStation()->IsOrientationReversed()
+					                              || i == 1 && stop.Station->GetStation()->IsOrientationReversed()
+						                              ? offsetDistance
+						                              : -offsetDistance;
+
+					if (stationOffsets.find(adjustedOffsetDistance) == stationOffsets.end())
+					{
+						// Not on a valid offset. Skip
+						continue;
+					}
+
+					linkedCargoPlatforms.AddUnique(stopCargo);
+				}
+			}
+		}
+	}
+
+	return linkedCargoPlatforms;
+}
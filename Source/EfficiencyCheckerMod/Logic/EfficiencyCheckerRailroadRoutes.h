@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+class AFGBuildableTrainPlatformCargo;
+class UWorld;
+
+/**
+ * Cargo platforms linked by timetabled trains, found once per cargo platform and kept until something they depend on
+ * changes.
+ *
+ * There is nothing to tell when trains or timetables change, so each route keeps a fingerprint of the trains of its
+ * track and their stops, which is taken again at most once per frame for each track. Platforms and stations built or
+ * removed drop every route.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerRailroadRoutes
+{
+public:
+    // Other cargo platforms that trains stopping at the cargo station load from or unload to, on the matching offsets
+    TArray<AFGBuildableTrainPlatformCargo*> getLinkedCargoPlatforms(AFGBuildableTrainPlatformCargo* cargoPlatform, const FString& indent);
+
+    // For platforms and stations built or removed
+    void invalidatePlatforms();
+
+    // Takes the fingerprints of the tracks with routes again, dropping the routes whose trains or stops changed. True
+    // when any was dropped
+    bool invalidateChangedTimetables(UWorld* world);
+
+    inline int32
+    Num() const
+    {
+        return routes.Num();
+    }
+
+    void Empty();
+
+protected:
+    struct FRoute
+    {
+        int32 trackId = INDEX_NONE;
+        uint32 timetables = 0;
+
+        TArray<AFGBuildableTrainPlatformCargo*> linkedCargoPlatforms;
+    };
+
+    struct FTrackTimetables
+    {
+        uint64 frame = 0;
+        uint32 fingerprint = 0;
+    };
+
+    // Hash of the trains on the track and of their stops
+    uint32 getTimetablesFingerprint(UWorld* world, int32 trackId);
+
+    static TArray<AFGBuildableTrainPlatformCargo*> findLinkedCargoPlatforms(AFGBuildableTrainPlatformCargo* cargoPlatform, const FString& indent);
+
+    TMap<AFGBuildableTrainPlatformCargo*, FRoute> routes;
+    TMap<int32, FTrackTimetables> timetablesByTrack;
+};
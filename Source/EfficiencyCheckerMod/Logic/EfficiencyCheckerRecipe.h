@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "FGItemDescriptor.h"
+
+// Ingredient or product of a recipe, with its index and form resolved
+struct FEfficiencyCheckerRecipeItem
+{
+    TSubclassOf<UFGItemDescriptor> item;
+    int32 itemIndex = INDEX_NONE;
+
+    // Per cycle. Fluids are in liters
+    int32 amount = 0;
+
+    EResourceForm form = EResourceForm::RF_INVALID;
+
+    inline bool
+    isFluid() const
+    {
+        return form == EResourceForm::RF_LIQUID || form == EResourceForm::RF_GAS;
+    }
+};
+
+/**
+ * What a recipe takes and gives on each cycle (see AEfficiencyCheckerLogic::getRecipe).
+ * The cycle time depends on the manufacturer and on its clock, so the rates are
+ * amount * (60.0 / CalcProductionCycleTimeForPotential(potential)) as they always were, without copying the recipe arrays.
+ */
+struct FEfficiencyCheckerRecipe
+{
+    TArray<FEfficiencyCheckerRecipeItem> ingredients;
+    TArray<FEfficiencyCheckerRecipeItem> products;
+};
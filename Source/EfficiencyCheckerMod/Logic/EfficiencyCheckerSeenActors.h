@@ -0,0 +1,170 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+
+class AActor;
+
+/**
+ * Actors seen by an output walk, with the items each one was seen with.
+ *
+ * The entries are kept densely, in the order they were added, and found through an open addressing table of indexes.
+ * Reset only bumps the generation of the table, so a pooled instance is reused across walks without clearing or
+ * allocating again.
+ */
+class FEfficiencyCheckerSeenActors
+{
+public:
+    FORCEINLINE int32
+    Num() const
+    {
+        return actors.Num();
+    }
+
+    FORCEINLINE bool
+    Contains(const AActor* actor) const
+    {
+        return findIndex(actor) != INDEX_NONE;
+    }
+
+    FORCEINLINE const FEfficiencyCheckerItemSet*
+    Find(const AActor* actor) const
+    {
+        const auto index = findIndex(actor);
+
+        return index != INDEX_NONE ? &items[index] : nullptr;
+    }
+
+    // Items of the actor, adding it with an empty set when it was not seen yet
+    FEfficiencyCheckerItemSet&
+    FindOrAdd(AActor* actor)
+    {
+        // Kept at most half full
+        if ((actors.Num() + 1) * 2 > buckets.Num())
+        {
+            grow();
+        }
+
+        const auto mask = buckets.Num() - 1;
+
+        for (auto bucketIndex = hashActor(actor) & mask;; bucketIndex = (bucketIndex + 1) & mask)
+        {
+            auto& bucket = buckets[bucketIndex];
+
+            if (bucket.generation != generation)
+            {
+                bucket.generation = generation;
+                bucket.index = actors.Add(actor);
+
+                return items[items.AddDefaulted()];
+            }
+
+            if (actors[bucket.index] == actor)
+            {
+                return items[bucket.index];
+            }
+        }
+    }
+
+    void
+    Reset()
+    {
+        actors.Reset();
+        items.Reset();
+
+        if (++generation == 0)
+        {
+            // Wrapped around. Buckets from the first generations would look current again
+            for (auto& bucket : buckets)
+            {
+                bucket.generation = 0;
+            }
+
+            generation = 1;
+        }
+    }
+
+    // Seen actors, in the order they were added
+    FORCEINLINE const TArray<AActor*>&
+    getActors() const
+    {
+        return actors;
+    }
+
+private:
+    struct FBucket
+    {
+        uint32 generation = 0;
+        int32 index = INDEX_NONE;
+    };
+
+    FORCEINLINE static uint32
+    hashActor(const AActor* actor)
+    {
+        // Actors are aligned, so the low bits of the address are mixed with the high ones before masking
+        auto key = static_cast<uint64>(reinterpret_cast<UPTRINT>(actor));
+
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+
+        return static_cast<uint32>(key);
+    }
+
+    FORCEINLINE int32
+    findIndex(const AActor* actor) const
+    {
+        if (!actors.Num())
+        {
+            return INDEX_NONE;
+        }
+
+        const auto mask = buckets.Num() - 1;
+
+        for (auto bucketIndex = hashActor(actor) & mask;; bucketIndex = (bucketIndex + 1) & mask)
+        {
+            const auto& bucket = buckets[bucketIndex];
+
+            if (bucket.generation != generation)
+            {
+                return INDEX_NONE;
+            }
+
+            if (actors[bucket.index] == actor)
+            {
+                return bucket.index;
+            }
+        }
+    }
+
+    void
+    grow()
+    {
+        buckets.Reset();
+        buckets.SetNum(FMath::Max<int32>(64, FMath::RoundUpToPowerOfTwo((actors.Num() + 1) * 4)));
+
+        generation = 1;
+
+        const auto mask = buckets.Num() - 1;
+
+        for (auto index = 0; index < actors.Num(); index++)
+        {
+            auto bucketIndex = hashActor(actors[index]) & mask;
+
+            while (buckets[bucketIndex].generation == generation)
+            {
+                bucketIndex = (bucketIndex + 1) & mask;
+            }
+
+            buckets[bucketIndex].generation = generation;
+            buckets[bucketIndex].index = index;
+        }
+    }
+
+    TArray<AActor*> actors;
+    TArray<FEfficiencyCheckerItemSet> items;
+
+    // Power of two sized. A bucket is only in use when it has the current generation
+    TArray<FBucket> buckets;
+    uint32 generation = 1;
+};
@@ -0,0 +1,146 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerSortRules.h"
+#include "EfficiencyCheckerLogic.h"
+
+#include "FGBuildableSplitterSmart.h"
+#include "FGFactoryConnectionComponent.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+TSharedPtr<FEfficiencyCheckerSortRules> FEfficiencyCheckerSortRules::compile
+(
+	AEfficiencyCheckerLogic* logic,
+	AFGBuildableSplitterSmart* smartSplitter
+)
+{
+	auto sortRules = MakeShared<FEfficiencyCheckerSortRules>();
+
+	TArray<UFGFactoryConnectionComponent*> unindexedConnections;
+
+	for (auto connection : AEfficiencyCheckerLogic::getFactoryConnections(smartSplitter, unindexedConnections))
+	{
+		if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR ||
+			connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
+		{
+			continue;
+		}
+
+		const auto outputIndex = connection->GetName()[connection->GetName().Len() - 1] - '1';
+
+		sortRules->outputConnections.Emplace(connection, outputIndex);
+		sortRules->outputCount = FMath::Max(sortRules->outputCount, outputIndex + 1);
+	}
+
+	for (int x = 0; x < smartSplitter->GetNumSortRules(); ++x)
+	{
+		const auto rule = smartSplitter->GetSortRuleAt(x);
+		if (rule.OutputIndex < 0)
+		{
+			continue;
+		}
+
+		auto output = sortRules->outputs.FindByPredicate(
+			[&rule](const FOutputRules& outputRules)
+			{
+				return outputRules.outputIndex == rule.OutputIndex;
+			}
+			);
+
+		if (!output)
+		{
+			output = &sortRules->outputs.AddDefaulted_GetRef();
+			output->outputIndex = rule.OutputIndex;
+		}
+
+		output->items.Add(logic->getItemIndex(rule.ItemClass));
+
+		sortRules->outputCount = FMath::Max(sortRules->outputCount, rule.OutputIndex + 1);
+	}
+
+	sortRules->outputs.Sort(
+		[](const FOutputRules& x, const FOutputRules& y)
+		{
+			return x.outputIndex < y.outputIndex;
+		}
+		);
+
+	for (auto& output : sortRules->outputs)
+	{
+		output.none = logic->noneItemMask.Intersects(output.items);
+		output.any = !output.none && (logic->wildCardItemMask.Intersects(output.items) || logic->overflowItemMask.Intersects(output.items));
+	}
+
+	return sortRules;
+}
+
+int32 FEfficiencyCheckerSortRules::getOutputIndex(const UFGConnectionComponent* connection) const
+{
+	for (const auto& outputConnection : outputConnections)
+	{
+		if (outputConnection.Key == connection)
+		{
+			return outputConnection.Value;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+bool FEfficiencyCheckerSortRules::hasRules(int32 outputIndex) const
+{
+	for (const auto& output : outputs)
+	{
+		if (output.outputIndex == outputIndex)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const FEfficiencyCheckerItemSet& FEfficiencyCheckerSortRules::getItems(const TArray<FEfficiencyCheckerItemSet>& itemsByOutput, int32 outputIndex)
+{
+	static const FEfficiencyCheckerItemSet noItems;
+
+	return itemsByOutput.IsValidIndex(outputIndex) ? itemsByOutput[outputIndex] : noItems;
+}
+
+void FEfficiencyCheckerSortRules::resolve
+(
+	const FEfficiencyCheckerItemSet& items,
+	const FEfficiencyCheckerItemSet& anyUndefinedItemMask,
+	TArray<FEfficiencyCheckerItemSet>& out_itemsByOutput
+) const
+{
+	out_itemsByOutput.Reset();
+	out_itemsByOutput.SetNum(outputCount);
+
+	FEfficiencyCheckerItemSet definedItems;
+
+	for (const auto& output : outputs)
+	{
+		auto& outputItems = out_itemsByOutput[output.outputIndex];
+
+		outputItems = output.none ? FEfficiencyCheckerItemSet() : output.any ? items : output.items;
+
+		definedItems.Append(outputItems);
+	}
+
+	for (const auto& output : outputs)
+	{
+		auto& outputItems = out_itemsByOutput[output.outputIndex];
+
+		if (anyUndefinedItemMask.Intersects(outputItems))
+		{
+			outputItems = outputItems.Union(items.Difference(definedItems));
+		}
+	}
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+
+class AEfficiencyCheckerLogic;
+class AFGBuildableSplitterSmart;
+class UFGConnectionComponent;
+class UFGFactoryConnectionComponent;
+
+/**
+ * Sort rules of a smart splitter, compiled into an item set per output with the special items turned into flags, so
+ * that the traversals don't read the rules on every visit (see AEfficiencyCheckerLogic::getSortRules).
+ */
+struct FEfficiencyCheckerSortRules
+{
+    struct FOutputRules
+    {
+        int32 outputIndex = INDEX_NONE;
+
+        // Items of the rules, as they are
+        FEfficiencyCheckerItemSet items;
+
+        // Has the none item. Nothing goes there
+        bool none = false;
+
+        // Has the wildcard or the overflow item. Anything that comes in goes there
+        bool any = false;
+    };
+
+    // Outputs that have rules, by output index
+    TArray<FOutputRules> outputs;
+
+    // Output index of each output conveyor connection, from its name
+    TArray<TPair<UFGFactoryConnectionComponent*, int32>> outputConnections;
+
+    // Outputs of the splitter, and of the rules. Sizes the arrays filled by resolve
+    int32 outputCount = 0;
+
+    static TSharedPtr<FEfficiencyCheckerSortRules> compile(AEfficiencyCheckerLogic* logic, AFGBuildableSplitterSmart* smartSplitter);
+
+    // INDEX_NONE when the connection is not an output conveyor connection
+    int32 getOutputIndex(const UFGConnectionComponent* connection) const;
+
+    bool hasRules(int32 outputIndex) const;
+
+    // Items the rules of each output let through, for the items that come in. The any undefined item adds what no other
+    // output takes. Explicit items are kept as they are, so callers intersect them with the items that come in if needed
+    void resolve(const FEfficiencyCheckerItemSet& items, const FEfficiencyCheckerItemSet& anyUndefinedItemMask, TArray<FEfficiencyCheckerItemSet>& out_itemsByOutput) const;
+
+    // Items resolved for the output. None for an unknown output
+    static const FEfficiencyCheckerItemSet& getItems(const TArray<FEfficiencyCheckerItemSet>& itemsByOutput, int32 outputIndex);
+};
@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid of axis aligned bounds, hashed by cell coordinates.
+ * An element is registered on every cell its bounds overlap, so a query only looks at the elements near the queried box.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+template <typename ElementType>
+class TEfficiencyCheckerSpatialGrid
+{
+public:
+    explicit TEfficiencyCheckerSpatialGrid(float in_cellSize)
+        : cellSize(in_cellSize)
+    {
+    }
+
+    // Registers the element on all cells overlapped by the bounds. Can be called more than once for the same element
+    void Add(ElementType element, const FBox& bounds)
+    {
+        const auto minCell = getCell(bounds.Min);
+        const auto maxCell = getCell(bounds.Max);
+
+        auto& elementCells = cellsByElement.FindOrAdd(element);
+
+        for (auto x = minCell.X; x <= maxCell.X; x++)
+        {
+            for (auto y = minCell.Y; y <= maxCell.Y; y++)
+            {
+                for (auto z = minCell.Z; z <= maxCell.Z; z++)
+                {
+                    const FIntVector cell(x, y, z);
+
+                    auto& cellElements = cells.FindOrAdd(cell);
+                    if (cellElements.Contains(element))
+                    {
+                        continue;
+                    }
+
+                    cellElements.Add(element);
+                    elementCells.Add(cell);
+                }
+            }
+        }
+    }
+
+    void Remove(ElementType element)
+    {
+        TArray<FIntVector> elementCells;
+        if (!cellsByElement.RemoveAndCopyValue(element, elementCells))
+        {
+            return;
+        }
+
+        for (const auto& cell : elementCells)
+        {
+            auto cellElements = cells.Find(cell);
+            if (!cellElements)
+            {
+                continue;
+            }
+
+            cellElements->RemoveSingleSwap(element);
+
+            if (!cellElements->Num())
+            {
+                cells.Remove(cell);
+            }
+        }
+    }
+
+    // Elements registered on any cell overlapped by the box. Each element is returned once
+    void Query(const FBox& box, TArray<ElementType>& out_elements) const
+    {
+        const auto minCell = getCell(box.Min);
+        const auto maxCell = getCell(box.Max);
+
+        for (auto x = minCell.X; x <= maxCell.X; x++)
+        {
+            for (auto y = minCell.Y; y <= maxCell.Y; y++)
+            {
+                for (auto z = minCell.Z; z <= maxCell.Z; z++)
+                {
+                    const auto cellElements = cells.Find(FIntVector(x, y, z));
+                    if (!cellElements)
+                    {
+                        continue;
+                    }
+
+                    for (auto element : *cellElements)
+                    {
+                        out_elements.AddUnique(element);
+                    }
+                }
+            }
+        }
+    }
+
+    inline int32
+    Num() const
+    {
+        return cellsByElement.Num();
+    }
+
+    void Empty()
+    {
+        cells.Empty();
+        cellsByElement.Empty();
+    }
+
+protected:
+    inline FIntVector
+    getCell(const FVector& location) const
+    {
+        return FIntVector(
+            FMath::FloorToInt(location.X / cellSize),
+            FMath::FloorToInt(location.Y / cellSize),
+            FMath::FloorToInt(location.Z / cellSize)
+            );
+    }
+
+    float cellSize;
+
+    TMap<FIntVector, TArray<ElementType>> cells;
+    TMap<ElementType, TArray<FIntVector>> cellsByElement;
+};
@@ -0,0 +1,89 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerSubWalkCache.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+TSharedPtr<const FEfficiencyCheckerSubWalk> FEfficiencyCheckerSubWalkCache::find(const FEfficiencyCheckerSubWalkKey& key) const
+{
+	const auto entryId = entryByKey.Find(key);
+
+	return entryId ? entries[*entryId].walk : nullptr;
+}
+
+void FEfficiencyCheckerSubWalkCache::add(const FEfficiencyCheckerSubWalkKey& key, FEfficiencyCheckerSubWalk&& walk, int32 in_epoch)
+{
+	if (in_epoch != epoch)
+	{
+		return;
+	}
+
+	const auto previousId = entryByKey.Find(key);
+	if (previousId)
+	{
+		removeEntry(*previousId);
+	}
+
+	if (storedActors + walk.visited.Num() > maxStoredActors)
+	{
+		Empty();
+	}
+
+	const auto entryId = nextEntry++;
+
+	for (auto actor : walk.visited)
+	{
+		entriesByActor.FindOrAdd(actor).Add(entryId);
+	}
+
+	storedActors += walk.visited.Num();
+
+	auto& entry = entries.Add(entryId);
+	entry.key = key;
+	entry.walk = MakeShared<FEfficiencyCheckerSubWalk>(MoveTemp(walk));
+
+	entryByKey.Add(key, entryId);
+}
+
+void FEfficiencyCheckerSubWalkCache::invalidate(const AActor* actor)
+{
+	epoch++;
+
+	TArray<int32> entryIds;
+	if (!entriesByActor.RemoveAndCopyValue(actor, entryIds))
+	{
+		return;
+	}
+
+	for (auto entryId : entryIds)
+	{
+		removeEntry(entryId);
+	}
+}
+
+void FEfficiencyCheckerSubWalkCache::Empty()
+{
+	entries.Empty();
+	entryByKey.Empty();
+	entriesByActor.Empty();
+	storedActors = 0;
+}
+
+void FEfficiencyCheckerSubWalkCache::removeEntry(int32 entryId)
+{
+	FEntry entry;
+	if (!entries.RemoveAndCopyValue(entryId, entry))
+	{
+		return;
+	}
+
+	entryByKey.Remove(entry.key);
+
+	storedActors -= entry.walk->visited.Num();
+}
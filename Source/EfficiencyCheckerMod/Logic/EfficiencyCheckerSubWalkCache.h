@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "FGItemDescriptor.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+
+class AActor;
+class AFGBuildable;
+class UFGConnectionComponent;
+
+// Everything an input sub-walk depends on, besides the buildables it goes through. The limit it starts with is left out,
+// and applied when it is replayed
+struct FEfficiencyCheckerSubWalkKey
+{
+    UFGConnectionComponent* connector = nullptr;
+    FEfficiencyCheckerItemSet restrictItems;
+
+    // Items injected before the sub-walk started, that the discounting walks inside it look for
+    FEfficiencyCheckerItemSet injectedItems;
+
+    EResourceForm resourceForm = EResourceForm::RF_INVALID;
+    bool customInjectedInput = false;
+
+    inline bool
+    operator==(const FEfficiencyCheckerSubWalkKey& other) const
+    {
+        return connector == other.connector &&
+            resourceForm == other.resourceForm &&
+            customInjectedInput == other.customInjectedInput &&
+            restrictItems == other.restrictItems &&
+            injectedItems == other.injectedItems;
+    }
+
+    inline friend uint32
+    GetTypeHash(const FEfficiencyCheckerSubWalkKey& key)
+    {
+        auto hash = HashCombine(GetTypeHash(key.connector), GetTypeHash(key.restrictItems));
+        hash = HashCombine(hash, GetTypeHash(key.injectedItems));
+
+        return HashCombine(hash, GetTypeHash(static_cast<uint8>(key.resourceForm) | (key.customInjectedInput ? 0x100 : 0)));
+    }
+};
+
+// What a finished input sub-walk added to the walk that started it
+struct FEfficiencyCheckerSubWalk
+{
+    float injectedInput = 0;
+
+    // Lowest limit the sub-walk reached by itself, replayed as the lower of it and the limit of the caller. FLT_MAX when
+    // it never went below startLimit, the limit it was walked with, as it is then only known to be at least that
+    float limitedThroughput = FLT_MAX;
+    float startLimit = 0;
+
+    // Segments that set limitedThroughput, other than the ones it started with, and their capacities
+    TArray<AActor*> limitedBy;
+    TArray<float> limitedByCapacities;
+
+    FEfficiencyCheckerItemSet injectedItems;
+
+    // Every actor entered, including by the discounting walks. The sub-walk can only be reused where none of them was seen yet
+    TArray<AActor*> visited;
+
+    // Actors added to the seen actors of the caller, with the actor each one was entered from
+    TArray<AActor*> seen;
+    TArray<AActor*> parents;
+
+    TArray<AFGBuildable*> connected;
+};
+
+/**
+ * Results of input sub-walks shared by every traversal, so that checkers on the same belt chain or on branches of one
+ * manifold don't walk the common upstream again.
+ *
+ * There is no topology epoch dropping everything at once. Entries are dropped one by one when a buildable they went
+ * through changes, so that building elsewhere keeps them. The epoch only tells a walk that ran across a change.
+ * Not thread safe by itself. Callers are expected to hold AEfficiencyCheckerLogic::eclCritical.
+ */
+class FEfficiencyCheckerSubWalkCache
+{
+public:
+    TSharedPtr<const FEfficiencyCheckerSubWalk> find(const FEfficiencyCheckerSubWalkKey& key) const;
+
+    // Stored only when nothing was invalidated since epoch, so that a walk that ran across a change is not kept. Takes
+    // the place of an entry with the same key, that could not be replayed
+    void add(const FEfficiencyCheckerSubWalkKey& key, FEfficiencyCheckerSubWalk&& walk, int32 epoch);
+
+    // Drops every entry that went through the actor
+    void invalidate(const AActor* actor);
+
+    // Bumped on every invalidation
+    inline int32
+    getEpoch() const
+    {
+        return epoch;
+    }
+
+    inline int32
+    Num() const
+    {
+        return entries.Num();
+    }
+
+    void Empty();
+
+protected:
+    void removeEntry(int32 entryId);
+
+    // Whole cache is dropped past this many stored actors, as nested sub-walks repeat the upstream they share
+    static constexpr int32 maxStoredActors = 1 << 20;
+
+    struct FEntry
+    {
+        FEfficiencyCheckerSubWalkKey key;
+        TSharedPtr<const FEfficiencyCheckerSubWalk> walk;
+    };
+
+    TMap<int32, FEntry> entries;
+    TMap<FEfficiencyCheckerSubWalkKey, int32> entryByKey;
+
+    // Entries each actor was visited by. Ids of dropped entries are left behind, and skipped
+    TMap<const AActor*, TArray<int32>> entriesByActor;
+
+    int32 nextEntry = 0;
+    int32 storedActors = 0;
+    int32 epoch = 0;
+};
@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Strongly connected components of a directed graph, by Tarjan's algorithm with an explicit call stack, so that long
+ * belt lines can't overflow the native one.
+ *
+ * Vertices are identified by int32 and only the ones reachable from the roots are visited. getSuccessors(vertex, out)
+ * appends the successors of the vertex to out, and onComponent(members) is called once per component, in reverse
+ * topological order: a component is reported before any component that reaches it.
+ */
+template <typename GetSuccessorsType, typename OnComponentType>
+void findStronglyConnectedComponents(const TArray<int32>& roots, GetSuccessorsType&& getSuccessors, OnComponentType&& onComponent)
+{
+    struct FCall
+    {
+        int32 vertex = INDEX_NONE;
+
+        // Range of the vertex successors on the successors stack
+        int32 firstSuccessor = 0;
+        int32 nextSuccessor = 0;
+        int32 endSuccessor = 0;
+    };
+
+    TMap<int32, int32> visitIndex;
+    TMap<int32, int32> lowLink;
+    TSet<int32> onStack;
+
+    TArray<int32> stack;
+    TArray<int32> successors;
+    TArray<int32> members;
+    TArray<FCall> calls;
+    int32 counter = 0;
+
+    const auto visit = [&](int32 vertex)
+    {
+        visitIndex.Add(vertex, counter);
+        lowLink.Add(vertex, counter);
+        ++counter;
+
+        stack.Push(vertex);
+        onStack.Add(vertex);
+
+        FCall call;
+        call.vertex = vertex;
+        call.firstSuccessor = call.nextSuccessor = successors.Num();
+
+        getSuccessors(vertex, successors);
+
+        call.endSuccessor = successors.Num();
+
+        calls.Add(call);
+    };
+
+    for (auto root : roots)
+    {
+        if (visitIndex.Contains(root))
+        {
+            continue;
+        }
+
+        visit(root);
+
+        while (calls.Num())
+        {
+            const auto vertex = calls.Last().vertex;
+
+            if (calls.Last().nextSuccessor < calls.Last().endSuccessor)
+            {
+                const auto target = successors[calls.Last().nextSuccessor++];
+
+                if (!visitIndex.Contains(target))
+                {
+                    visit(target);
+                }
+                else if (onStack.Contains(target))
+                {
+                    lowLink[vertex] = FMath::Min(lowLink[vertex], visitIndex[target]);
+                }
+
+                continue;
+            }
+
+            successors.SetNum(calls.Last().firstSuccessor, false);
+            calls.Pop(false);
+
+            if (calls.Num())
+            {
+                const auto parent = calls.Last().vertex;
+                lowLink[parent] = FMath::Min(lowLink[parent], lowLink[vertex]);
+            }
+
+            if (lowLink[vertex] != visitIndex[vertex])
+            {
+                continue;
+            }
+
+            members.Reset();
+
+            int32 member;
+            do
+            {
+                member = stack.Pop(false);
+                onStack.Remove(member);
+
+                members.Add(member);
+            }
+            while (member != vertex);
+
+            onComponent(static_cast<const TArray<int32>&>(members));
+        }
+    }
+}
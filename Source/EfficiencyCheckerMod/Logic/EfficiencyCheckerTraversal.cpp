@@ -0,0 +1,3257 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerTraversal.h"
+#include "EfficiencyCheckerLogic.h"
+#include "EfficiencyCheckerMaxFlow.h"
+#include "EfficiencyCheckerModModule.h"
+
+#include "FGBuildableConveyorAttachment.h"
+#include "FGBuildableConveyorBase.h"
+#include "FGBuildableDockingStation.h"
+#include "FGBuildableFactory.h"
+#include "FGBuildableGeneratorNuclear.h"
+#include "FGBuildableManufacturer.h"
+#include "FGBuildablePipeline.h"
+#include "FGBuildablePipelinePump.h"
+#include "FGBuildableResourceExtractor.h"
+#include "FGBuildableSplitterSmart.h"
+#include "FGBuildableStorage.h"
+#include "FGBuildableTrainPlatformCargo.h"
+#include "FGConnectionComponent.h"
+#include "FGFactoryConnectionComponent.h"
+#include "FGItemDescriptor.h"
+#include "FGPipeConnectionComponent.h"
+
+#include "SML/util/Logging.h"
+#include "SML/util/ReflectionHelper.h"
+
+#include "Algo/Reverse.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+// What these buildables add changes with their inventory, the train timetables or the pump flow limit, with nothing to
+// tell, so sub-walks going through them are not cached
+static const auto uncachedClassFlags = EEfficiencyCheckerClassFlags::Storage | EEfficiencyCheckerClassFlags::TrainPlatformCargo |
+	EEfficiencyCheckerClassFlags::DockingStation | EEfficiencyCheckerClassFlags::StorageTeleporter | EEfficiencyCheckerClassFlags::PipelinePump;
+
+FEfficiencyCheckerTraversal::FEfficiencyCheckerTraversal
+(
+	EResourceForm in_resourceForm,
+	TSet<AFGBuildable*>& in_connected,
+	AFGBuildableSubsystem* in_buildableSubsystem
+)
+	: resourceForm(in_resourceForm),
+	  connected(in_connected),
+	  buildableSubsystem(in_buildableSubsystem),
+	  logic(AEfficiencyCheckerLogic::singleton)
+{
+}
+
+void FEfficiencyCheckerTraversal::collectInput
+(
+	bool customInjectedInput,
+	UFGConnectionComponent* connector,
+	float& out_injectedInput,
+	float& out_limitedThroughput,
+	TSet<AActor*>& seenActors,
+	FEfficiencyCheckerItemSet& out_injectedItems,
+	const FEfficiencyCheckerItemSet& restrictItems
+)
+{
+	beginInput(customInjectedInput, connector, out_injectedInput, out_limitedThroughput, seenActors, out_injectedItems, restrictItems);
+
+	resume();
+
+	finishInput(out_injectedInput, out_limitedThroughput, seenActors, out_injectedItems);
+}
+
+void FEfficiencyCheckerTraversal::collectOutput
+(
+	UFGConnectionComponent* connector,
+	float& out_requiredOutput,
+	float& out_limitedThroughput,
+	FEfficiencyCheckerSeenActors& seenActors,
+	const FEfficiencyCheckerItemSet& injectedItems
+)
+{
+	beginOutput(connector, out_requiredOutput, out_limitedThroughput, seenActors, injectedItems);
+
+	resume();
+
+	finishOutput(out_requiredOutput, out_limitedThroughput, seenActors);
+}
+
+void FEfficiencyCheckerTraversal::beginInput
+(
+	bool customInjectedInput,
+	UFGConnectionComponent* connector,
+	float injectedInput,
+	float limitedThroughput,
+	const TSet<AActor*>& seenActors,
+	const FEfficiencyCheckerItemSet& injectedItems,
+	const FEfficiencyCheckerItemSet& restrictItems
+)
+{
+	visitedNodes = 0;
+	aborted = false;
+	suspended = false;
+
+	rootConnector = connector;
+	rootInitialLimit = limitedThroughput;
+
+	maxFlow.step = EMaxFlowStep::None;
+	maxFlow.kind = EFrameKind::Input;
+
+	parents.Reset();
+	segmentCapacities.Reset();
+
+	recordings.Reset();
+	enteredLog.Reset();
+	connectedLog.Reset();
+	entryOrder.Reset();
+
+	rootSeenSlot = allocateInputSeen();
+	inputSeen[rootSeenSlot] = seenActors;
+
+	rootItemsSlot = allocateItemSet(injectedItems);
+	rootAmountSlot = allocateAmount(injectedInput);
+	rootLimitSlot = allocateAmount(limitedThroughput);
+
+	const auto frameIndex = pushFrame(EFrameKind::Input, connector, restrictItems, 0);
+
+	auto& frame = frames[frameIndex];
+	frame.customInjectedInput = customInjectedInput;
+	frame.mainWalk = true;
+	frame.seenSlot = rootSeenSlot;
+	frame.injectedItemsSlot = rootItemsSlot;
+	frame.amountSlot = rootAmountSlot;
+	frame.limitSlot = rootLimitSlot;
+}
+
+void FEfficiencyCheckerTraversal::finishInput
+(
+	float& out_injectedInput,
+	float& out_limitedThroughput,
+	TSet<AActor*>& out_seenActors,
+	FEfficiencyCheckerItemSet& out_injectedItems
+)
+{
+	out_seenActors = MoveTemp(inputSeen[rootSeenSlot]);
+	out_injectedItems = itemSets[rootItemsSlot];
+	out_injectedInput = amounts[rootAmountSlot];
+	out_limitedThroughput = amounts[rootLimitSlot];
+
+	if (maxFlow.step == EMaxFlowStep::Done)
+	{
+		applyMaxFlow(out_limitedThroughput);
+	}
+
+	collectBottlenecks();
+
+	resetPools();
+}
+
+void FEfficiencyCheckerTraversal::beginOutput
+(
+	UFGConnectionComponent* connector,
+	float requiredOutput,
+	float limitedThroughput,
+	const FEfficiencyCheckerSeenActors& seenActors,
+	const FEfficiencyCheckerItemSet& injectedItems
+)
+{
+	visitedNodes = 0;
+	aborted = false;
+	suspended = false;
+
+	rootConnector = connector;
+	rootInitialLimit = limitedThroughput;
+
+	maxFlow.step = EMaxFlowStep::None;
+	maxFlow.kind = EFrameKind::Output;
+
+	parents.Reset();
+	segmentCapacities.Reset();
+
+	recordings.Reset();
+	enteredLog.Reset();
+	connectedLog.Reset();
+	entryOrder.Reset();
+
+	rootSeenSlot = allocateOutputSeen();
+	outputSeen[rootSeenSlot] = seenActors;
+
+	rootItemsSlot = INDEX_NONE;
+	rootAmountSlot = allocateAmount(requiredOutput);
+	rootLimitSlot = allocateAmount(limitedThroughput);
+
+	const auto frameIndex = pushFrame(EFrameKind::Output, connector, injectedItems, 0);
+
+	auto& frame = frames[frameIndex];
+	frame.mainWalk = true;
+	frame.seenSlot = rootSeenSlot;
+	frame.amountSlot = rootAmountSlot;
+	frame.limitSlot = rootLimitSlot;
+}
+
+void FEfficiencyCheckerTraversal::finishOutput
+(
+	float& out_requiredOutput,
+	float& out_limitedThroughput,
+	FEfficiencyCheckerSeenActors& out_seenActors
+)
+{
+	out_seenActors = MoveTemp(outputSeen[rootSeenSlot]);
+	out_requiredOutput = amounts[rootAmountSlot];
+	out_limitedThroughput = amounts[rootLimitSlot];
+
+	if (maxFlow.step == EMaxFlowStep::Done)
+	{
+		applyMaxFlow(out_limitedThroughput);
+	}
+
+	collectBottlenecks();
+
+	resetPools();
+}
+
+bool FEfficiencyCheckerTraversal::resume(int32 in_sliceNodes, double in_sliceDeadline)
+{
+	sliceNodes = in_sliceNodes;
+	sliceDeadline = in_sliceDeadline;
+	sliceVisitedNodes = 0;
+	suspended = false;
+
+	run();
+
+	if (!suspended && !aborted && FEfficiencyCheckerModModule::solveMaxFlow)
+	{
+		// Counted against the same slice as the walk
+		buildMaxFlow();
+	}
+
+	return !suspended;
+}
+
+void FEfficiencyCheckerTraversal::run()
+{
+	while (frameNum > 0 && !aborted && !suspended)
+	{
+		const auto frameIndex = frameNum - 1;
+
+		if (frames[frameIndex].expansion != EExpansion::None)
+		{
+			// Returning from a child
+			resumeFrame(frameIndex);
+
+			continue;
+		}
+
+		if (frames[frameIndex].kind == EFrameKind::Input)
+		{
+			visitInput(frameIndex);
+		}
+		else
+		{
+			visitOutput(frameIndex);
+		}
+
+		if (!aborted && !suspended && frames[frameIndex].expansion == EExpansion::None)
+		{
+			// Finished without branching
+			popFrame();
+		}
+	}
+
+	if (!suspended)
+	{
+		frameNum = 0;
+	}
+}
+
+void FEfficiencyCheckerTraversal::resetPools()
+{
+	amounts.Reset();
+	limitSegments.Reset();
+	itemSets.Reset();
+	inputSeenNum = 0;
+	outputSeenNum = 0;
+
+	rootSeenSlot = INDEX_NONE;
+	rootItemsSlot = INDEX_NONE;
+	rootAmountSlot = INDEX_NONE;
+	rootLimitSlot = INDEX_NONE;
+}
+
+void FEfficiencyCheckerTraversal::collectBottlenecks()
+{
+	lastBottlenecks.Reset();
+
+	for (auto segment : limitSegments[rootLimitSlot])
+	{
+		auto& bottleneck = lastBottlenecks.AddDefaulted_GetRef();
+		bottleneck.buildable = Cast<AFGBuildable>(segment);
+		bottleneck.limit = segmentCapacities.FindRef(segment);
+
+		for (auto step = segment; step && bottleneck.path.Num() <= parents.Num(); step = parents.FindRef(step))
+		{
+			bottleneck.path.Add(Cast<AFGBuildable>(step));
+		}
+
+		Algo::Reverse(bottleneck.path);
+	}
+}
+
+int32 FEfficiencyCheckerTraversal::pushFrame(EFrameKind kind, UFGConnectionComponent* connector, FEfficiencyCheckerItemSet items, int32 level)
+{
+	if (frameNum == frames.Num())
+	{
+		frames.AddDefaulted();
+	}
+
+	const auto frameIndex = frameNum++;
+
+	auto& frame = frames[frameIndex];
+
+	frame.kind = kind;
+	frame.connector = connector;
+	frame.items = items;
+	frame.customInjectedInput = false;
+	frame.level = level;
+	frame.mainWalk = false;
+	frame.previous = nullptr;
+
+	frame.seenSlot = INDEX_NONE;
+	frame.injectedItemsSlot = INDEX_NONE;
+	frame.amountSlot = INDEX_NONE;
+	frame.limitSlot = INDEX_NONE;
+
+	frame.expansion = EExpansion::None;
+	frame.owner = nullptr;
+	frame.buildable = nullptr;
+	frame.pipeline = false;
+	frame.dockingStation = false;
+
+	frame.children.Reset();
+	frame.nextChild = 0;
+	frame.childRunning = false;
+
+	frame.firstConnection = true;
+	frame.limitedThroughput = 0;
+	frame.limitedBy.Reset();
+
+	frame.childAmountSlot = INDEX_NONE;
+	frame.childLimitSlot = INDEX_NONE;
+	frame.childRecorded = false;
+
+	return frameIndex;
+}
+
+void FEfficiencyCheckerTraversal::popFrame()
+{
+	--frameNum;
+}
+
+bool FEfficiencyCheckerTraversal::isSliceSpent() const
+{
+	// The clock is only read every few nodes, as entering a node is much cheaper than reading it
+	return sliceVisitedNodes > 0 &&
+		(sliceNodes > 0 && sliceVisitedNodes >= sliceNodes ||
+			sliceDeadline > 0 && sliceVisitedNodes % 64 == 0 && FPlatformTime::Seconds() >= sliceDeadline);
+}
+
+bool FEfficiencyCheckerTraversal::enterNode(const FFrame& frame, AActor* owner)
+{
+	if (isSliceSpent())
+	{
+		// The frame is left on its current connector, so it is visited again from this node when resumed
+		suspended = true;
+
+		return false;
+	}
+
+	++sliceVisitedNodes;
+
+	if (++visitedNodes > FEfficiencyCheckerModModule::traversalNodeBudget)
+	{
+		SML::Logging::error(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			TEXT(" "),
+			frame.kind == EFrameKind::Input ? TEXT("collectInput") : TEXT("collectOutput"),
+			TEXT(": node budget exhausted at level "),
+			frame.level,
+			TEXT("; "),
+			*owner->GetName(),
+			TEXT(" / "),
+			*GetPathNameSafe(owner->GetClass())
+			);
+
+		overflow = true;
+		aborted = true;
+
+		return false;
+	}
+
+	return true;
+}
+
+void FEfficiencyCheckerTraversal::expand(FFrame& frame, EExpansion expansion, AActor* owner, AFGBuildable* buildable)
+{
+	frame.expansion = expansion;
+	frame.owner = owner;
+	frame.buildable = buildable;
+
+	frame.nextChild = 0;
+	frame.childRunning = false;
+	frame.firstConnection = true;
+	frame.limitedThroughput = 0;
+	frame.limitedBy.Reset();
+}
+
+void FEfficiencyCheckerTraversal::enterActor(FFrame& frame, AActor* actor, EEfficiencyCheckerClassFlags actorFlags)
+{
+	if (frame.mainWalk && !parents.Contains(actor))
+	{
+		parents.Add(actor, frame.previous);
+	}
+
+	if (recordings.Num())
+	{
+		if (EnumHasAnyFlags(actorFlags, uncachedClassFlags))
+		{
+			recordings.Last().cacheable = false;
+		}
+
+		logEntered(actor, frame.previous, frame.kind == EFrameKind::Input ? frame.seenSlot : INDEX_NONE);
+	}
+
+	frame.previous = actor;
+}
+
+void FEfficiencyCheckerTraversal::markConnected(AFGBuildable* buildable)
+{
+	bool alreadyConnected = false;
+	connected.Add(buildable, &alreadyConnected);
+
+	if (!alreadyConnected && recordings.Num())
+	{
+		connectedLog.Add(buildable);
+	}
+}
+
+void FEfficiencyCheckerTraversal::noteSeen(AActor* actor)
+{
+	if (!recordings.Num())
+	{
+		return;
+	}
+
+	const auto order = entryOrder.Find(actor);
+
+	auto& earliestSeen = recordings.Last().earliestSeen;
+	earliestSeen = FMath::Min(earliestSeen, order ? *order : MIN_int32);
+}
+
+void FEfficiencyCheckerTraversal::logEntered(AActor* actor, AActor* from, int32 inputSeenSlot)
+{
+	const auto order = enteredLog.Num();
+
+	auto& entered = enteredLog.AddDefaulted_GetRef();
+	entered.actor = actor;
+	entered.from = from;
+	entered.inputSeenSlot = inputSeenSlot;
+
+	if (!entryOrder.Contains(actor))
+	{
+		entryOrder.Add(actor, order);
+	}
+}
+
+bool FEfficiencyCheckerTraversal::replaySubWalk(FFrame& frame, const FEfficiencyCheckerSubWalk& walk)
+{
+	// Only known to be at least its start limit, which is below the one of this child
+	if (walk.limitedThroughput >= walk.startLimit && amounts[frame.childLimitSlot] > walk.startLimit)
+	{
+		return false;
+	}
+
+	auto& seenActors = inputSeen[frame.seenSlot];
+
+	for (auto actor : walk.visited)
+	{
+		if (seenActors.Contains(actor))
+		{
+			return false;
+		}
+	}
+
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level + 1),
+			TEXT("Reusing the cached walk of "),
+			walk.visited.Num(),
+			TEXT(" buildables, injecting "),
+			walk.injectedInput,
+			TEXT(" limited at "),
+			walk.limitedThroughput
+			);
+	}
+
+	amounts[frame.amountSlot] += walk.injectedInput;
+	itemSets[frame.injectedItemsSlot] = walk.injectedItems;
+
+	applyLimit(frame.childLimitSlot, walk.limitedThroughput, walk.limitedBy);
+
+	for (auto i = 0; i < walk.limitedBy.Num(); i++)
+	{
+		segmentCapacities.Add(walk.limitedBy[i], walk.limitedByCapacities[i]);
+	}
+
+	for (auto i = 0; i < walk.seen.Num(); i++)
+	{
+		const auto actor = walk.seen[i];
+
+		seenActors.Add(actor);
+
+		if (frame.mainWalk && !parents.Contains(actor))
+		{
+			parents.Add(actor, walk.parents[i]);
+		}
+	}
+
+	for (auto buildable : walk.connected)
+	{
+		markConnected(buildable);
+	}
+
+	// An enclosing recording goes through everything the cached one did
+	if (recordings.Num())
+	{
+		TSet<AActor*> seen(walk.seen);
+
+		for (auto i = 0; i < walk.seen.Num(); i++)
+		{
+			logEntered(walk.seen[i], walk.parents[i], frame.seenSlot);
+		}
+
+		for (auto actor : walk.visited)
+		{
+			if (!seen.Contains(actor))
+			{
+				logEntered(actor, nullptr, INDEX_NONE);
+			}
+		}
+	}
+
+	return true;
+}
+
+void FEfficiencyCheckerTraversal::storeSubWalk(FFrame& frame)
+{
+	frame.childRecorded = false;
+
+	auto recording = recordings.Pop(false);
+
+	if (recordings.Num())
+	{
+		// What the child depends on, the enclosing recording depends on too
+		auto& enclosing = recordings.Last();
+		enclosing.earliestSeen = FMath::Min(enclosing.earliestSeen, recording.earliestSeen);
+		enclosing.cacheable &= recording.cacheable;
+	}
+
+	if (recording.cacheable && recording.earliestSeen >= recording.enteredMark && recording.enteredMark < enteredLog.Num())
+	{
+		FEfficiencyCheckerSubWalk walk;
+
+		walk.injectedInput = amounts[frame.amountSlot] - recording.injectedInput;
+		walk.startLimit = recording.startLimit;
+
+		if (amounts[frame.childLimitSlot] < recording.startLimit)
+		{
+			walk.limitedThroughput = amounts[frame.childLimitSlot];
+		}
+		walk.injectedItems = itemSets[frame.injectedItemsSlot];
+
+		// The segments the child started with are the ones of this frame
+		const auto& initialSegments = limitSegments[frame.limitSlot];
+
+		for (auto segment : limitSegments[frame.childLimitSlot])
+		{
+			if (!initialSegments.Contains(segment))
+			{
+				walk.limitedBy.Add(segment);
+				walk.limitedByCapacities.Add(segmentCapacities.FindRef(segment));
+			}
+		}
+
+		TSet<AActor*> visited;
+		TSet<AActor*> seen;
+
+		for (auto i = recording.enteredMark; i < enteredLog.Num(); i++)
+		{
+			const auto& entered = enteredLog[i];
+
+			bool alreadyVisited = false;
+			visited.Add(entered.actor, &alreadyVisited);
+
+			if (!alreadyVisited)
+			{
+				walk.visited.Add(entered.actor);
+			}
+
+			if (entered.inputSeenSlot != frame.seenSlot)
+			{
+				continue;
+			}
+
+			bool alreadySeen = false;
+			seen.Add(entered.actor, &alreadySeen);
+
+			if (!alreadySeen)
+			{
+				walk.seen.Add(entered.actor);
+				walk.parents.Add(entered.from);
+			}
+		}
+
+		walk.connected.Append(connectedLog.GetData() + recording.connectedMark, connectedLog.Num() - recording.connectedMark);
+
+		logic->addSubWalk(recording.key, MoveTemp(walk), recording.epoch);
+	}
+
+	if (!recordings.Num())
+	{
+		// Orders only have to be kept while something is recorded
+		enteredLog.Reset();
+		connectedLog.Reset();
+		entryOrder.Reset();
+	}
+}
+
+void FEfficiencyCheckerTraversal::applyLimit(int32 limitSlot, float limit, AActor* segment)
+{
+	auto& currentLimit = amounts[limitSlot];
+
+	// Along a straight run, a tie keeps the segment closest to the start, so a long line of equal belts reports only one
+	if (limit < currentLimit - KINDA_SMALL_NUMBER)
+	{
+		currentLimit = limit;
+
+		auto& segments = limitSegments[limitSlot];
+		segments.Reset();
+		segments.Add(segment);
+
+		segmentCapacities.Add(segment, limit);
+	}
+}
+
+void FEfficiencyCheckerTraversal::applyLimit(int32 limitSlot, float limit, const TArray<AActor*>& segments)
+{
+	auto& currentLimit = amounts[limitSlot];
+
+	if (limit < currentLimit - KINDA_SMALL_NUMBER)
+	{
+		currentLimit = limit;
+		limitSegments[limitSlot] = segments;
+	}
+	else if (limit <= currentLimit + KINDA_SMALL_NUMBER)
+	{
+		currentLimit = FMath::Min(currentLimit, limit);
+
+		for (auto segment : segments)
+		{
+			limitSegments[limitSlot].AddUnique(segment);
+		}
+	}
+}
+
+bool FEfficiencyCheckerTraversal::expandLoop(FFrame& frame, AActor* owner)
+{
+	const auto loop = logic->getLoop(owner);
+	if (!loop)
+	{
+		return false;
+	}
+
+	for (auto member : loop->members)
+	{
+		if (frame.kind == EFrameKind::Input)
+		{
+			inputSeen[frame.seenSlot].Add(member);
+		}
+		else
+		{
+			AEfficiencyCheckerLogic::addAllItemsToActor(outputSeen[frame.seenSlot], member, frame.items);
+		}
+
+		markConnected(member);
+
+		// The members are reached through the node the walk came in by
+		if (frame.mainWalk && member != owner && !parents.Contains(member))
+		{
+			parents.Add(member, owner);
+		}
+
+		if (recordings.Num() && member != owner)
+		{
+			logEntered(member, owner, frame.kind == EFrameKind::Input ? frame.seenSlot : INDEX_NONE);
+		}
+	}
+
+	// Whatever goes through the loop crosses its narrowest cut on the way between the boundary and the owner
+	const auto cut = logic->getLoopCut(owner, frame.kind == EFrameKind::Input);
+
+	if (cut.segments.Num())
+	{
+		applyLimit(frame.limitSlot, cut.capacity, cut.segments);
+
+		for (auto i = 0; i < cut.segments.Num(); i++)
+		{
+			segmentCapacities.Add(cut.segments[i], cut.segmentCapacities[i]);
+		}
+	}
+
+	const auto& out_limitedThroughput = amounts[frame.limitSlot];
+
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level),
+			*owner->GetName(),
+			TEXT(" is part of a loop of "),
+			loop->members.Num(),
+			TEXT(" buildables, limited at "),
+			out_limitedThroughput,
+			TEXT(" items/minute")
+			);
+	}
+
+	// Walking input, the loop is fed by its entering connections, and what leaves through the other exits is discounted.
+	// Walking output, it is the other way around
+	const auto& sources = frame.kind == EFrameKind::Input ? loop->entering : loop->leaving;
+	const auto& exits = frame.kind == EFrameKind::Input ? loop->leaving : loop->entering;
+
+	if (!sources.Num())
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level),
+			*owner->GetName(),
+			frame.kind == EFrameKind::Input ? TEXT(" is on a loop with no input") : TEXT(" is on a loop with no output")
+			);
+
+		return true;
+	}
+
+	// Leaving connections of smart splitters only let through what their rules send there
+	const auto leavingItems = [this, &frame](UFGFactoryConnectionComponent* connection, FEfficiencyCheckerItemSet& out_items)
+	{
+		const auto smartSplitter = Cast<AFGBuildableSplitterSmart>(connection->GetOwner());
+		TSharedPtr<const FEfficiencyCheckerSortRules> sortRules;
+		if (smartSplitter)
+		{
+			sortRules = logic->getSortRules(smartSplitter);
+		}
+
+		if (!sortRules)
+		{
+			return false;
+		}
+
+		TArray<FEfficiencyCheckerItemSet> itemsByOutput;
+		sortRules->resolve(frame.items, logic->anyUndefinedItemMask, itemsByOutput);
+
+		out_items = FEfficiencyCheckerSortRules::getItems(itemsByOutput, sortRules->getOutputIndex(connection));
+
+		return true;
+	};
+
+	FEfficiencyCheckerItemSet filteredItems;
+
+	for (auto connection : sources)
+	{
+		if (frame.kind == EFrameKind::Output && leavingItems(connection, filteredItems))
+		{
+			addChild(frame, connection->GetConnection(), false, filteredItems);
+		}
+		else
+		{
+			addChild(frame, connection->GetConnection(), false, frame.items);
+		}
+	}
+
+	// When the walk started inside the loop, there is no exit it came through, and nothing is discounted
+	const auto arrival = Cast<UFGFactoryConnectionComponent>(frame.connector);
+
+	if (exits.Contains(arrival))
+	{
+		for (auto connection : exits)
+		{
+			if (connection == arrival)
+			{
+				continue;
+			}
+
+			if (frame.kind == EFrameKind::Input && leavingItems(connection, filteredItems))
+			{
+				addChild(frame, connection->GetConnection(), true, filteredItems, true);
+			}
+			else
+			{
+				addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+			}
+		}
+	}
+
+	expand(frame, EExpansion::Loop, owner, Cast<AFGBuildable>(owner));
+
+	return true;
+}
+
+bool FEfficiencyCheckerTraversal::followChain(FFrame& frame, AActor* owner)
+{
+	int32 position = INDEX_NONE;
+
+	const auto chain = logic->getChain(owner, position);
+	if (!chain)
+	{
+		return false;
+	}
+
+	const auto input = frame.kind == EFrameKind::Input;
+
+	// Walking input goes upstream, towards the first member. Walking output goes downstream
+	const auto step = input ? -1 : 1;
+	const auto end = input ? -1 : chain->members.Num();
+
+	auto& out_limitedThroughput = amounts[frame.limitSlot];
+
+	AActor* slowestBelt = nullptr;
+	float capacity = FLT_MAX;
+
+	auto walked = 0;
+
+	for (auto i = position; i != end; i += step)
+	{
+		const auto member = chain->members[i];
+
+		// The owner was already entered
+		if (i != position)
+		{
+			if (input)
+			{
+				if (inputSeen[frame.seenSlot].Contains(member))
+				{
+					noteSeen(member);
+
+					frame.connector = nullptr;
+
+					break;
+				}
+			}
+			else
+			{
+				const auto& seenActors = outputSeen[frame.seenSlot];
+
+				if (recordings.Num() && AEfficiencyCheckerLogic::containsActor(seenActors, member))
+				{
+					noteSeen(member);
+				}
+
+				if (frame.items.IsEmpty()
+					    ? AEfficiencyCheckerLogic::containsActor(seenActors, member)
+					    : AEfficiencyCheckerLogic::actorContainsAllItems(seenActors, member, frame.items))
+				{
+					frame.connector = nullptr;
+
+					break;
+				}
+			}
+
+			// Members count against the node budget and the slice like any other node
+			if (!enterNode(frame, member))
+			{
+				// Suspended, the walk resumes from this member. Aborted, it goes no further
+				frame.connector = suspended ? (input ? chain->outputs[i] : chain->inputs[i]) : nullptr;
+
+				break;
+			}
+
+			enterActor(frame, member, chain->classFlags[i]);
+
+			if (input)
+			{
+				inputSeen[frame.seenSlot].Add(member);
+			}
+		}
+
+		if (!input)
+		{
+			AEfficiencyCheckerLogic::addAllItemsToActor(outputSeen[frame.seenSlot], member, frame.items);
+		}
+
+		markConnected(member);
+
+		// Along the walk, a tie keeps the belt reached first
+		if (chain->capacities[i] < capacity)
+		{
+			capacity = chain->capacities[i];
+			slowestBelt = member;
+		}
+
+		walked++;
+
+		if (i + step == end)
+		{
+			frame.connector = (input ? chain->input : chain->output)->GetConnection();
+		}
+	}
+
+	if (slowestBelt)
+	{
+		applyLimit(frame.limitSlot, capacity, slowestBelt);
+	}
+
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level),
+			*owner->GetName(),
+			TEXT(" followed through "),
+			walked,
+			TEXT(" of the "),
+			chain->members.Num(),
+			TEXT(" buildables of its chain, limited at "),
+			out_limitedThroughput,
+			TEXT(" items/minute")
+			);
+	}
+
+	return true;
+}
+
+bool FEfficiencyCheckerTraversal::expandPipeNetwork(FFrame& frame, AActor* owner)
+{
+	const auto network = logic->getPipeNetwork(owner);
+	if (!network || network->pumps.Num())
+	{
+		// Pumps set a direction, and are walked as they are
+		return false;
+	}
+
+	// Only the owner was seen when the walk started on it
+	const auto firstActor = frame.kind == EFrameKind::Input ? inputSeen[frame.seenSlot].Num() == 1 : outputSeen[frame.seenSlot].Num() == 1;
+
+	for (auto member : network->members)
+	{
+		if (frame.kind == EFrameKind::Input)
+		{
+			inputSeen[frame.seenSlot].Add(member);
+		}
+		else
+		{
+			AEfficiencyCheckerLogic::addAllItemsToActor(outputSeen[frame.seenSlot], member, frame.items);
+		}
+
+		markConnected(member);
+
+		if (frame.mainWalk && member != owner && !parents.Contains(member))
+		{
+			parents.Add(member, owner);
+		}
+
+		if (recordings.Num() && member != owner)
+		{
+			logEntered(member, owner, frame.kind == EFrameKind::Input ? frame.seenSlot : INDEX_NONE);
+		}
+	}
+
+	// Whatever crosses the network goes through its narrowest cut between the pipe under the walk and the side of the
+	// boundary it is walked to
+	const auto cut = logic->getPipeNetworkCut(owner, frame.kind == EFrameKind::Input);
+
+	if (cut.segments.Num())
+	{
+		applyLimit(frame.limitSlot, cut.capacity, cut.segments);
+
+		for (auto i = 0; i < cut.segments.Num(); i++)
+		{
+			segmentCapacities.Add(cut.segments[i], cut.segmentCapacities[i]);
+		}
+	}
+
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level),
+			*owner->GetName(),
+			TEXT(" is part of pipe network "),
+			network->networkID,
+			TEXT(" with "),
+			network->members.Num(),
+			TEXT(" buildables, "),
+			network->producers,
+			TEXT(" producers and "),
+			network->consumers,
+			TEXT(" consumers, limited at "),
+			amounts[frame.limitSlot],
+			TEXT(" m³/minute")
+			);
+	}
+
+	// The connection the walk came in by is left out, unless the walk started here
+	for (auto connection : frame.kind == EFrameKind::Input ? network->inputs : network->outputs)
+	{
+		if (connection == frame.connector && !firstActor)
+		{
+			continue;
+		}
+
+		addChild(frame, connection->GetConnection(), false, frame.items);
+	}
+
+	expand(frame, EExpansion::Fluid, owner, Cast<AFGBuildable>(owner));
+
+	// Children limit the network the way they limit a pipe
+	frame.pipeline = true;
+
+	return true;
+}
+
+void FEfficiencyCheckerTraversal::addChild
+(
+	FFrame& frame,
+	UFGConnectionComponent* connection,
+	bool discount,
+	const FEfficiencyCheckerItemSet& items,
+	bool restrictToItems
+)
+{
+	auto& child = frame.children.AddDefaulted_GetRef();
+
+	child.connection = connection;
+	child.discount = discount;
+	child.restrictToItems = restrictToItems;
+	child.items = items;
+}
+
+void FEfficiencyCheckerTraversal::resumeFrame(int32 frameIndex)
+{
+	auto& frame = frames[frameIndex];
+
+	if (frame.childRunning)
+	{
+		collectChild(frame);
+	}
+
+	if (frame.nextChild < frame.children.Num())
+	{
+		launchChild(frameIndex);
+
+		return;
+	}
+
+	finishExpansion(frame);
+
+	popFrame();
+}
+
+void FEfficiencyCheckerTraversal::launchChild(int32 frameIndex)
+{
+	auto& frame = frames[frameIndex];
+
+	const auto& child = frame.children[frame.nextChild++];
+
+	frame.childRunning = true;
+
+	frame.amountsMark = amounts.Num();
+	frame.itemSetsMark = itemSets.Num();
+	frame.inputSeenMark = inputSeenNum;
+	frame.outputSeenMark = outputSeenNum;
+
+	const auto connection = child.connection;
+	const auto level = frame.level + 1;
+
+	// Everything the child needs is copied before pushing it, as it can move the frames around
+	if (!child.discount)
+	{
+		// Same direction. Shares the accumulators and the seen actors with this frame
+		const auto items = child.items;
+
+		frame.childAmountSlot = INDEX_NONE;
+		frame.childLimitSlot = allocateAmount(amounts[frame.limitSlot]);
+
+		limitSegments[frame.childLimitSlot] = limitSegments[frame.limitSlot];
+
+		if (frame.kind == EFrameKind::Input && FEfficiencyCheckerModModule::cacheSubWalks)
+		{
+			FRecording recording;
+
+			auto& key = recording.key;
+			key.connector = connection;
+			key.restrictItems = items;
+			key.injectedItems = itemSets[frame.injectedItemsSlot];
+			key.resourceForm = resourceForm;
+			key.customInjectedInput = frame.customInjectedInput;
+
+			recording.startLimit = amounts[frame.childLimitSlot];
+
+			const auto cached = logic->findSubWalk(key, recording.epoch);
+
+			if (cached && replaySubWalk(frame, *cached))
+			{
+				// Collected when the frame is resumed, as if the child had been walked
+				return;
+			}
+
+			recording.enteredMark = enteredLog.Num();
+			recording.connectedMark = connectedLog.Num();
+			recording.injectedInput = amounts[frame.amountSlot];
+
+			recordings.Add(MoveTemp(recording));
+
+			frame.childRecorded = true;
+		}
+
+		const auto mainWalk = frame.mainWalk;
+		const auto previous = frame.owner;
+
+		const auto kind = frame.kind;
+		const auto customInjectedInput = frame.customInjectedInput;
+		const auto seenSlot = frame.seenSlot;
+		const auto injectedItemsSlot = frame.injectedItemsSlot;
+		const auto amountSlot = frame.amountSlot;
+		const auto limitSlot = frame.childLimitSlot;
+
+		auto& childFrame = frames[pushFrame(kind, connection, items, level)];
+
+		childFrame.customInjectedInput = customInjectedInput;
+		childFrame.mainWalk = mainWalk;
+		childFrame.previous = previous;
+		childFrame.seenSlot = seenSlot;
+		childFrame.injectedItemsSlot = injectedItemsSlot;
+		childFrame.amountSlot = amountSlot;
+		childFrame.limitSlot = limitSlot;
+	}
+	else if (frame.kind == EFrameKind::Input)
+	{
+		// Walk the other outputs, with a copy of the seen actors, to discount what goes elsewhere
+		const auto seenSlot = allocateOutputSeen();
+
+		auto& seenActorsCopy = outputSeen[seenSlot];
+
+		const auto& injectedItems = itemSets[frame.injectedItemsSlot];
+
+		for (auto actor : inputSeen[frame.seenSlot])
+		{
+			seenActorsCopy.FindOrAdd(actor) = injectedItems;
+		}
+
+		auto tempInjectedItems = injectedItems;
+
+		if (child.restrictToItems)
+		{
+			tempInjectedItems = tempInjectedItems.Intersect(child.items);
+		}
+
+		frame.childAmountSlot = allocateAmount(0);
+		frame.childLimitSlot = allocateAmount(0);
+
+		const auto amountSlot = frame.childAmountSlot;
+		const auto limitSlot = frame.childLimitSlot;
+
+		auto& childFrame = frames[pushFrame(EFrameKind::Output, connection, tempInjectedItems, level)];
+
+		childFrame.seenSlot = seenSlot;
+		childFrame.amountSlot = amountSlot;
+		childFrame.limitSlot = limitSlot;
+	}
+	else
+	{
+		// Walk the other inputs, with a copy of the seen actors, to discount what comes from elsewhere
+		const auto seenSlot = allocateInputSeen();
+
+		auto& seenActorsCopy = inputSeen[seenSlot];
+
+		const auto& seenActors = outputSeen[frame.seenSlot].getActors();
+
+		seenActorsCopy.Reserve(seenActors.Num());
+
+		for (auto actor : seenActors)
+		{
+			seenActorsCopy.Add(actor);
+		}
+
+		const auto tempInjectedItems = frame.items;
+
+		frame.childAmountSlot = allocateAmount(0);
+		frame.childLimitSlot = allocateAmount(0);
+
+		const auto injectedItemsSlot = allocateItemSet(tempInjectedItems);
+		const auto amountSlot = frame.childAmountSlot;
+		const auto limitSlot = frame.childLimitSlot;
+
+		auto& childFrame = frames[pushFrame(EFrameKind::Input, connection, tempInjectedItems, level)];
+
+		childFrame.customInjectedInput = false;
+		childFrame.seenSlot = seenSlot;
+		childFrame.injectedItemsSlot = injectedItemsSlot;
+		childFrame.amountSlot = amountSlot;
+		childFrame.limitSlot = limitSlot;
+	}
+}
+
+void FEfficiencyCheckerTraversal::collectChild(FFrame& frame)
+{
+	frame.childRunning = false;
+
+	if (frame.childRecorded)
+	{
+		// Before the child result is folded into this frame
+		storeSubWalk(frame);
+	}
+
+	const auto& child = frame.children[frame.nextChild - 1];
+
+	if (child.discount)
+	{
+		const auto discounted = amounts[frame.childAmountSlot];
+
+		if (discounted > 0)
+		{
+			if (FEfficiencyCheckerModModule::dumpConnections)
+			{
+				SML::Logging::info(
+					*AEfficiencyCheckerLogic::getTimeStamp(),
+					*getIndent(frame.level),
+					TEXT("Discounting "),
+					discounted,
+					resourceForm == EResourceForm::RF_SOLID ? TEXT(" items/minute") : TEXT(" m³/minute")
+					);
+			}
+
+			if (frame.kind == EFrameKind::Output || !frame.customInjectedInput)
+			{
+				amounts[frame.amountSlot] -= discounted;
+			}
+		}
+	}
+	else
+	{
+		const auto previousLimit = amounts[frame.childLimitSlot];
+
+		const auto& previousSegments = limitSegments[frame.childLimitSlot];
+
+		if (frame.expansion == EExpansion::Fluid && frame.pipeline)
+		{
+			applyLimit(frame.limitSlot, previousLimit, previousSegments);
+		}
+		else if (frame.firstConnection)
+		{
+			frame.limitedThroughput = previousLimit;
+			frame.limitedBy = previousSegments;
+			frame.firstConnection = false;
+		}
+		else
+		{
+			// Each branch limits its share of the sum
+			frame.limitedThroughput += previousLimit;
+
+			for (auto segment : previousSegments)
+			{
+				frame.limitedBy.AddUnique(segment);
+			}
+		}
+	}
+
+	// Release what was handed to the child
+	amounts.SetNum(frame.amountsMark, false);
+	limitSegments.SetNum(frame.amountsMark, false);
+	itemSets.SetNum(frame.itemSetsMark, false);
+	inputSeenNum = frame.inputSeenMark;
+	outputSeenNum = frame.outputSeenMark;
+
+	frame.childAmountSlot = INDEX_NONE;
+	frame.childLimitSlot = INDEX_NONE;
+}
+
+void FEfficiencyCheckerTraversal::finishExpansion(FFrame& frame)
+{
+	auto& out_limitedThroughput = amounts[frame.limitSlot];
+
+	switch (frame.expansion)
+	{
+	case EExpansion::Solid:
+		applyLimit(frame.limitSlot, frame.limitedThroughput, frame.limitedBy);
+
+		if (frame.kind == EFrameKind::Input && frame.dockingStation /*|| cargoPlatform*/)
+		{
+			amounts[frame.amountSlot] += out_limitedThroughput;
+		}
+
+		break;
+
+	case EExpansion::Fluid:
+		if (!frame.pipeline && !frame.firstConnection)
+		{
+			applyLimit(frame.limitSlot, frame.limitedThroughput, frame.limitedBy);
+		}
+
+		break;
+
+	case EExpansion::FluidCargo:
+	case EExpansion::Loop:
+		applyLimit(frame.limitSlot, frame.limitedThroughput, frame.limitedBy);
+
+		break;
+
+	default:
+		break;
+	}
+
+	if (FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			*getIndent(frame.level),
+			*frame.owner->GetName(),
+			TEXT(" limited at "),
+			out_limitedThroughput,
+			resourceForm == EResourceForm::RF_SOLID ? TEXT(" items/minute") : TEXT(" m³/minute")
+			);
+	}
+
+	markConnected(frame.buildable);
+}
+
+int32 FEfficiencyCheckerTraversal::allocateAmount(float value)
+{
+	limitSegments.AddDefaulted();
+
+	return amounts.Add(value);
+}
+
+int32 FEfficiencyCheckerTraversal::allocateItemSet(FEfficiencyCheckerItemSet value)
+{
+	return itemSets.Add(value);
+}
+
+int32 FEfficiencyCheckerTraversal::allocateInputSeen()
+{
+	if (inputSeenNum == inputSeen.Num())
+	{
+		inputSeen.AddDefaulted();
+	}
+	else
+	{
+		// Keep the allocation of the pooled set
+		inputSeen[inputSeenNum].Reset();
+	}
+
+	return inputSeenNum++;
+}
+
+int32 FEfficiencyCheckerTraversal::allocateOutputSeen()
+{
+	if (outputSeenNum == outputSeen.Num())
+	{
+		outputSeen.AddDefaulted();
+	}
+	else
+	{
+		// Keep the allocation of the pooled table
+		outputSeen[outputSeenNum].Reset();
+	}
+
+	return outputSeenNum++;
+}
+
+void FEfficiencyCheckerTraversal::applyMaxFlow(float& out_limitedThroughput)
+{
+	out_limitedThroughput = FMath::Min(rootInitialLimit, maxFlow.value);
+
+	// The segments found along the walk are replaced by the saturated buildables of the minimum cut. When the limit the
+	// walk started with is lower, nothing on the network sets it
+	limitSegments[rootLimitSlot] = maxFlow.value < rootInitialLimit ? maxFlow.cut : TArray<AActor*>();
+
+	for (auto i = 0; i < maxFlow.cut.Num(); i++)
+	{
+		segmentCapacities.Add(maxFlow.cut[i], maxFlow.cutCapacities[i]);
+	}
+}
+
+void FEfficiencyCheckerTraversal::buildMaxFlow()
+{
+	// The graph is read under a single lock per slice, instead of once per lookup
+	FScopeLock ScopeLock(&logic->eclCritical);
+
+	const auto startTime = FPlatformTime::Seconds();
+
+	if (maxFlow.step == EMaxFlowStep::None)
+	{
+		startMaxFlow();
+	}
+
+	while (maxFlow.step != EMaxFlowStep::Done)
+	{
+		// The solve can't be split, so it starts a slice of its own
+		if (isSliceSpent() ||
+			maxFlow.step == EMaxFlowStep::Solve && sliceVisitedNodes > 0 && (sliceNodes > 0 || sliceDeadline > 0))
+		{
+			// Picked up from the same buildable when resumed
+			suspended = true;
+
+			break;
+		}
+
+		++sliceVisitedNodes;
+
+		switch (maxFlow.step)
+		{
+		case EMaxFlowStep::Vertices:
+			addMaxFlowVertices();
+			break;
+
+		case EMaxFlowStep::Edges:
+			addMaxFlowEdges();
+			break;
+
+		case EMaxFlowStep::Solve:
+			solveMaxFlow();
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	maxFlow.elapsed += FPlatformTime::Seconds() - startTime;
+
+	if (maxFlow.step == EMaxFlowStep::Done && FEfficiencyCheckerModModule::dumpConnections)
+	{
+		SML::Logging::info(
+			*AEfficiencyCheckerLogic::getTimeStamp(),
+			maxFlow.kind == EFrameKind::Input ? TEXT(" collectInput") : TEXT(" collectOutput"),
+			TEXT(": max flow of "),
+			maxFlow.value,
+			TEXT(" over "),
+			maxFlow.buildables.Num(),
+			TEXT(" buildables in "),
+			maxFlow.elapsed * 1000,
+			TEXT(" ms")
+			);
+	}
+}
+
+void FEfficiencyCheckerTraversal::startMaxFlow()
+{
+	maxFlow.actors = maxFlow.kind == EFrameKind::Input ? inputSeen[rootSeenSlot].Array() : outputSeen[rootSeenSlot].getActors();
+	maxFlow.next = 0;
+
+	maxFlow.network.Empty();
+	maxFlow.buildables.Reset();
+	maxFlow.capacities.Reset();
+	maxFlow.vertexByActor.Reset();
+
+	maxFlow.value = FEfficiencyCheckerMaxFlow::unlimited;
+	maxFlow.cut.Reset();
+	maxFlow.cutCapacities.Reset();
+	maxFlow.elapsed = 0;
+
+	const auto rootNode = logic->getNode(logic->graph.findConnectionNode(rootConnector));
+	if (!rootNode)
+	{
+		maxFlow.step = EMaxFlowStep::Done;
+
+		return;
+	}
+
+	maxFlow.rootActor = rootNode->buildable;
+
+	// Super source when walking input, super sink when walking output
+	maxFlow.terminal = maxFlow.network.addVertex();
+
+	maxFlow.step = EMaxFlowStep::Vertices;
+}
+
+void FEfficiencyCheckerTraversal::addMaxFlowVertices()
+{
+	if (maxFlow.next == maxFlow.actors.Num())
+	{
+		// Nothing limits a walk that doesn't go through where it started
+		maxFlow.step = maxFlow.vertexByActor.Contains(maxFlow.rootActor) ? EMaxFlowStep::Edges : EMaxFlowStep::Done;
+		maxFlow.next = 0;
+
+		return;
+	}
+
+	const auto node = logic->getNode(logic->graph.findNode(maxFlow.actors[maxFlow.next++]));
+	if (!node || maxFlow.vertexByActor.Contains(node->buildable))
+	{
+		return;
+	}
+
+	auto capacity = FEfficiencyCheckerMaxFlow::unlimited;
+
+	const auto conveyor = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorBase>(node->buildable, node->classFlags, EEfficiencyCheckerClassFlags::ConveyorBase);
+	const auto pipeline = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipeline>(node->buildable, node->classFlags, EEfficiencyCheckerClassFlags::Pipeline);
+	const auto pipePump = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipelinePump>(node->buildable, node->classFlags, EEfficiencyCheckerClassFlags::PipelinePump);
+
+	if (conveyor)
+	{
+		capacity = conveyor->GetSpeed() / 2;
+	}
+	else if (pipeline)
+	{
+		capacity = AEfficiencyCheckerLogic::getPipeSpeed(pipeline);
+	}
+	else if (pipePump)
+	{
+		capacity = AEfficiencyCheckerLogic::getPumpFlowLimit(pipePump);
+	}
+
+	// Each buildable is split in an input and an output vertex, joined by an edge that carries its own capacity. The
+	// output vertex is always the next one
+	const auto inVertex = maxFlow.network.addVertex();
+	maxFlow.network.addEdge(inVertex, maxFlow.network.addVertex(), capacity);
+
+	maxFlow.vertexByActor.Add(node->buildable, inVertex);
+	maxFlow.buildables.Add(node->buildable);
+	maxFlow.capacities.Add(capacity);
+}
+
+void FEfficiencyCheckerTraversal::addMaxFlowEdges()
+{
+	if (maxFlow.next == maxFlow.buildables.Num())
+	{
+		maxFlow.step = EMaxFlowStep::Solve;
+
+		return;
+	}
+
+	const auto buildable = maxFlow.buildables[maxFlow.next++];
+
+	const auto node = logic->getNode(logic->graph.findNode(buildable));
+	if (!node)
+	{
+		return;
+	}
+
+	const auto outVertex = maxFlow.vertexByActor[buildable] + 1;
+
+	if (resourceForm == EResourceForm::RF_SOLID)
+	{
+		for (auto connection : node->factoryConnections)
+		{
+			if (!connection->IsConnected() ||
+				connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT ||
+				connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+			{
+				continue;
+			}
+
+			const auto target = maxFlow.vertexByActor.Find(connection->GetConnection()->GetOwner());
+			if (target)
+			{
+				maxFlow.network.addEdge(outVertex, *target, FEfficiencyCheckerMaxFlow::unlimited);
+			}
+		}
+	}
+	else
+	{
+		for (auto connection : node->pipeConnections)
+		{
+			if (!connection->IsConnected())
+			{
+				continue;
+			}
+
+			const auto otherConnection = connection->GetPipeConnection();
+
+			// Fluid goes out through anything but a consumer, into anything but a producer
+			if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER ||
+				otherConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
+			{
+				continue;
+			}
+
+			const auto target = maxFlow.vertexByActor.Find(otherConnection->GetOwner());
+			if (target)
+			{
+				maxFlow.network.addEdge(outVertex, *target, FEfficiencyCheckerMaxFlow::unlimited);
+			}
+		}
+	}
+
+	const auto terminalFlags = EEfficiencyCheckerClassFlags::Manufacturer |
+		EEfficiencyCheckerClassFlags::ResourceExtractor |
+		EEfficiencyCheckerClassFlags::Storage |
+		EEfficiencyCheckerClassFlags::TrainPlatformCargo |
+		EEfficiencyCheckerClassFlags::DockingStation |
+		EEfficiencyCheckerClassFlags::StorageTeleporter |
+		EEfficiencyCheckerClassFlags::GeneratorFuel |
+		EEfficiencyCheckerClassFlags::GeneratorNuclear |
+		EEfficiencyCheckerClassFlags::SimpleProducer;
+
+	const auto carrierFlags = EEfficiencyCheckerClassFlags::ConveyorBase |
+		EEfficiencyCheckerClassFlags::ConveyorAttachment |
+		EEfficiencyCheckerClassFlags::FluidIntegrant;
+
+	if (buildable == maxFlow.rootActor ||
+		EnumHasAnyFlags(node->classFlags, carrierFlags) && !EnumHasAnyFlags(node->classFlags, terminalFlags))
+	{
+		return;
+	}
+
+	// Producers and consumers are not limited by themselves here. Their rates are accounted by the walk
+	if (maxFlow.kind == EFrameKind::Input)
+	{
+		maxFlow.network.addEdge(maxFlow.terminal, outVertex - 1, FEfficiencyCheckerMaxFlow::unlimited);
+	}
+	else
+	{
+		maxFlow.network.addEdge(outVertex, maxFlow.terminal, FEfficiencyCheckerMaxFlow::unlimited);
+	}
+}
+
+void FEfficiencyCheckerTraversal::solveMaxFlow()
+{
+	const auto rootVertex = maxFlow.vertexByActor[maxFlow.rootActor];
+
+	maxFlow.value = maxFlow.kind == EFrameKind::Input
+		                ? maxFlow.network.solve(maxFlow.terminal, rootVertex + 1)
+		                : maxFlow.network.solve(rootVertex, maxFlow.terminal);
+
+	if (maxFlow.value < FEfficiencyCheckerMaxFlow::unlimited)
+	{
+		// The saturated buildables between what the source still reaches and what it doesn't make the cut
+		for (auto i = 0; i < maxFlow.buildables.Num(); i++)
+		{
+			const auto inVertex = maxFlow.vertexByActor[maxFlow.buildables[i]];
+
+			if (maxFlow.network.isReachable(inVertex) && !maxFlow.network.isReachable(inVertex + 1))
+			{
+				maxFlow.cut.Add(maxFlow.buildables[i]);
+				maxFlow.cutCapacities.Add(maxFlow.capacities[i]);
+			}
+		}
+	}
+
+	maxFlow.step = EMaxFlowStep::Done;
+}
+
+FString FEfficiencyCheckerTraversal::getIndent(int32 level)
+{
+	if (!FEfficiencyCheckerModModule::dumpConnections)
+	{
+		return FString();
+	}
+
+	return FString::ChrN((level + 1) * 4, TEXT(' '));
+}
+
+TArray<AFGBuildableTrainPlatformCargo*> FEfficiencyCheckerTraversal::getLinkedCargoPlatforms
+(
+	AFGBuildableTrainPlatformCargo* cargoPlatform,
+	const FString& indent
+) const
+{
+	return logic->getLinkedCargoPlatforms(cargoPlatform, indent);
+}
+
+TArray<AFGBuildable*> FEfficiencyCheckerTraversal::getLinkedTeleporters(AFGBuildableFactory* storageTeleporter) const
+{
+	return logic->getLinkedTeleporters(storageTeleporter);
+}
+
+void FEfficiencyCheckerTraversal::visitInput(int32 frameIndex)
+{
+	auto& frame = frames[frameIndex];
+
+	auto& connector = frame.connector;
+	auto& restrictItems = frame.items;
+	const auto customInjectedInput = frame.customInjectedInput;
+
+	auto& seenActors = inputSeen[frame.seenSlot];
+	auto& out_injectedItems = itemSets[frame.injectedItemsSlot];
+	auto& out_injectedInput = amounts[frame.amountSlot];
+	auto& out_limitedThroughput = amounts[frame.limitSlot];
+
+	const auto indent = getIndent(frame.level);
+
+	for (;;)
+	{
+		if (!connector)
+		{
+			return;
+		}
+
+		const auto node = logic->getNode(logic->findConnectionNode(connector));
+
+		auto owner = node ? node->buildable : connector->GetOwner();
+
+		if (!owner)
+		{
+			return;
+		}
+
+		if (seenActors.Contains(owner))
+		{
+			noteSeen(owner);
+
+			return;
+		}
+
+		const auto ownerFlags = node ? node->classFlags : logic->getClassFlags(owner->GetClass());
+
+		if (!enterNode(frame, owner))
+		{
+			return;
+		}
+
+		enterActor(frame, owner, ownerFlags);
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			SML::Logging::info(
+				*AEfficiencyCheckerLogic::getTimeStamp(),
+				*indent,
+				TEXT("collectInput at level "),
+				frame.level,
+				TEXT(": "),
+				*owner->GetName(),
+				TEXT(" / "),
+				*GetPathNameSafe(owner->GetClass())
+				);
+		}
+
+		seenActors.Add(owner);
+
+		if (resourceForm == EResourceForm::RF_SOLID &&
+			EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment) &&
+			expandLoop(frame, owner))
+		{
+			return;
+		}
+
+		if (resourceForm == EResourceForm::RF_SOLID &&
+			EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment) &&
+			followChain(frame, owner))
+		{
+			continue;
+		}
+
+		{
+			const auto manufacturer = AEfficiencyCheckerLogic::castOwner<AFGBuildableManufacturer>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Manufacturer);
+			if (manufacturer)
+			{
+				const auto recipeClass = manufacturer->GetCurrentRecipe();
+				const auto recipe = logic->getRecipe(recipeClass);
+
+				if (recipe)
+				{
+					for (const auto& item : recipe->products)
+					{
+						const auto itemForm = item.form;
+
+						if (itemForm == EResourceForm::RF_SOLID && resourceForm != EResourceForm::RF_SOLID ||
+							(itemForm == EResourceForm::RF_LIQUID || itemForm == EResourceForm::RF_GAS) &&
+							resourceForm != EResourceForm::RF_LIQUID && resourceForm != EResourceForm::RF_GAS ||
+							!restrictItems.Contains(item.itemIndex))
+						{
+							continue;
+						}
+
+						out_injectedItems.Add(item.itemIndex);
+
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Item amount = "), item.amount);
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Current potential = "), manufacturer->GetCurrentPotential());
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Pending potential = "), manufacturer->GetPendingPotential());
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								TEXT("Production cycle time = "),
+								manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential())
+								);
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Recipe duration = "), UFGRecipe::GetManufacturingDuration(recipeClass));
+						}
+
+						float itemAmountPerMinute = item.amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
+
+						if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+						{
+							itemAmountPerMinute /= 1000;
+						}
+
+						// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
+						// {
+						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
+						//     {
+						//         itemAmountPerMinute *= 1.5;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
+						//     {
+						//         itemAmountPerMinute *= 2;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("Mk4_C")))
+						//     {
+						//         itemAmountPerMinute *= 2.5;
+						//     }
+						// }
+						// else if (fullClassName.StartsWith(TEXT("/Game/FarmingMod/Buildable")))
+						// {
+						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
+						//     {
+						//         itemAmountPerMinute *= 2;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
+						//     {
+						//         itemAmountPerMinute *= 3;
+						//     }
+						// }
+
+
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								*manufacturer->GetName(),
+								TEXT(" produces "),
+								itemAmountPerMinute,
+								TEXT(" "),
+								*UFGItemDescriptor::GetItemName(item.item).ToString(),
+								TEXT("/minute")
+								);
+						}
+
+						if (!customInjectedInput)
+						{
+							out_injectedInput += itemAmountPerMinute;
+						}
+
+						break;
+					}
+				}
+
+				markConnected(manufacturer);
+
+				return;
+			}
+		}
+
+		{
+			const auto extractor = AEfficiencyCheckerLogic::castOwner<AFGBuildableResourceExtractor>(owner, ownerFlags, EEfficiencyCheckerClassFlags::ResourceExtractor);
+			if (extractor)
+			{
+				TSubclassOf<UFGItemDescriptor> item;
+
+				if (!item)
+				{
+					const auto resource = extractor->GetExtractableResource();
+					if (resource)
+					{
+						const auto resourceObj = resource.GetObject();
+
+						item = IFGExtractableResourceInterface::Execute_GetResourceClass(resourceObj);
+
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								TEXT("Extraction Speed Multiplier = "),
+								IFGExtractableResourceInterface::Execute_GetExtractionSpeedMultiplier(resourceObj)
+								);
+						}
+					}
+					else
+					{
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Extractable resource is null"));
+						}
+					}
+				}
+
+				if (!item)
+				{
+					item = extractor->GetOutputInventory()->GetAllowedItemOnIndex(0);
+				}
+
+				if (!item || !restrictItems.Contains(logic->getItemIndex(item)))
+				{
+					return;
+				}
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Resource name = "), *UFGItemDescriptor::GetItemName(item).ToString());
+				}
+
+				out_injectedItems.Add(logic->getItemIndex(item));
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Current potential = "), extractor->GetCurrentPotential());
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Pending potential = "), extractor->GetPendingPotential());
+					SML::Logging::info(
+						*AEfficiencyCheckerLogic::getTimeStamp(),
+						*indent,
+						TEXT("Production cycle time = "),
+						extractor->CalcProductionCycleTimeForPotential(extractor->GetPendingPotential())
+						);
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Items per cycle converted = "), extractor->GetNumExtractedItemsPerCycleConverted());
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Items per cycle = "), extractor->GetNumExtractedItemsPerCycle());
+				}
+
+				float itemAmountPerMinute = extractor->GetNumExtractedItemsPerCycle() * (60.0 / extractor->CalcProductionCycleTimeForPotential(extractor->GetPendingPotential()));
+
+				if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+				{
+					itemAmountPerMinute /= 1000;
+				}
+
+				if (EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::MinerMk4))
+				{
+					itemAmountPerMinute = 2000;
+				}
+
+				// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
+				// {
+				//     if (fullClassName.EndsWith(TEXT("MK2_C")))
+				//     {
+				//         itemAmountPerMinute *= 1.5;
+				//     }
+				//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
+				//     {
+				//         itemAmountPerMinute *= 2;
+				//     }
+				//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
+				//     {
+				//         itemAmountPerMinute *= 2.5;
+				//     }
+				// }
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(
+						*AEfficiencyCheckerLogic::getTimeStamp(),
+						*indent,
+						*extractor->GetName(),
+						TEXT(" extracts "),
+						itemAmountPerMinute,
+						TEXT(" "),
+						*UFGItemDescriptor::GetItemName(item).ToString(),
+						TEXT("/minute")
+						);
+				}
+
+				if (!customInjectedInput)
+				{
+					out_injectedInput += itemAmountPerMinute;
+				}
+
+				markConnected(extractor);
+
+				return;
+			}
+		}
+
+		if (resourceForm == EResourceForm::RF_SOLID)
+		{
+			const auto conveyor = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorBase>(owner, ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase);
+			if (conveyor)
+			{
+				markConnected(conveyor);
+
+				connector = conveyor->GetConnection0()->GetConnection();
+
+				applyLimit(frame.limitSlot, conveyor->GetSpeed() / 2, conveyor);
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *conveyor->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
+				}
+
+				continue;
+			}
+
+			AFGBuildableStorage* storageContainer = nullptr;
+			AFGBuildableTrainPlatformCargo* cargoPlatform = nullptr;
+			AFGBuildableConveyorAttachment* conveyorAttachment = nullptr;
+			AFGBuildableDockingStation* dockingStation = nullptr;
+			AFGBuildableFactory* storageTeleporter = nullptr;
+
+			AFGBuildableFactory* buildable = conveyorAttachment = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorAttachment>(owner, ownerFlags, EEfficiencyCheckerClassFlags::ConveyorAttachment);
+			if (!buildable)
+			{
+				buildable = storageContainer = AEfficiencyCheckerLogic::castOwner<AFGBuildableStorage>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Storage);
+			}
+
+			if (!buildable)
+			{
+				cargoPlatform = AEfficiencyCheckerLogic::castOwner<AFGBuildableTrainPlatformCargo>(owner, ownerFlags, EEfficiencyCheckerClassFlags::TrainPlatformCargo);
+				if (cargoPlatform)
+				{
+					buildable = cargoPlatform;
+
+					TArray<FInventoryStack> stacks;
+
+					cargoPlatform->GetInventory()->GetInventoryStacks(stacks);
+
+					for (auto stack : stacks)
+					{
+						if (!restrictItems.Contains(logic->getItemIndex(stack.Item.ItemClass)))
+						{
+							continue;
+						}
+
+						out_injectedItems.Add(logic->getItemIndex(stack.Item.ItemClass));
+					}
+				}
+			}
+
+			if (!buildable)
+			{
+				dockingStation = AEfficiencyCheckerLogic::castOwner<AFGBuildableDockingStation>(owner, ownerFlags, EEfficiencyCheckerClassFlags::DockingStation);
+				if (dockingStation)
+				{
+					buildable = dockingStation;
+
+					TArray<FInventoryStack> stacks;
+
+					dockingStation->GetInventory()->GetInventoryStacks(stacks);
+
+					for (auto stack : stacks)
+					{
+						if (!restrictItems.Contains(logic->getItemIndex(stack.Item.ItemClass)))
+						{
+							continue;
+						}
+
+						out_injectedItems.Add(logic->getItemIndex(stack.Item.ItemClass));
+					}
+				}
+			}
+
+			if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
+				!buildable && EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::StorageTeleporter))
+			{
+				buildable = storageTeleporter = AEfficiencyCheckerLogic::castOwner<AFGBuildableFactory>(owner, ownerFlags, EEfficiencyCheckerClassFlags::StorageTeleporter);
+			}
+
+			if (buildable)
+			{
+				TArray<UFGFactoryConnectionComponent*> unindexedComponents;
+				TArray<UFGFactoryConnectionComponent*> linkedComponents;
+
+				const auto& ownComponents = AEfficiencyCheckerLogic::getFactoryConnections(buildable, unindexedComponents);
+
+				// Only copied when linked platforms or teleporters add theirs
+				const auto linked = cargoPlatform || storageTeleporter;
+				if (linked)
+				{
+					linkedComponents = ownComponents;
+				}
+
+				if (cargoPlatform)
+				{
+					for (auto stopCargo : getLinkedCargoPlatforms(cargoPlatform, indent))
+					{
+						seenActors.Add(stopCargo);
+
+						linkedComponents.Append(
+							AEfficiencyCheckerLogic::getFactoryConnections(stopCargo, unindexedComponents).FilterByPredicate(
+								[&linkedComponents, stopCargo](UFGFactoryConnectionComponent* connection)
+								{
+									return !linkedComponents.Contains(connection) &&
+										(stopCargo->GetIsInLoadMode() || connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT);
+								}
+								)
+							);
+					}
+				}
+
+				if (storageTeleporter)
+				{
+					for (auto testTeleporter : getLinkedTeleporters(storageTeleporter))
+					{
+						seenActors.Add(testTeleporter);
+
+						auto factory = Cast<AFGBuildableFactory>(testTeleporter);
+						if (factory)
+						{
+							linkedComponents.Append(
+								AEfficiencyCheckerLogic::getFactoryConnections(factory, unindexedComponents).FilterByPredicate(
+									[&linkedComponents](UFGFactoryConnectionComponent* connection)
+									{
+										return !linkedComponents.Contains(connection); // Not in use already
+									}
+									)
+								);
+						}
+					}
+				}
+
+				const auto& components = linked ? linkedComponents : ownComponents;
+
+				int currentOutputIndex = -1;
+				TArray<FEfficiencyCheckerItemSet> restrictedItemsByOutput;
+
+				// Filter items
+				auto smartSplitter = AEfficiencyCheckerLogic::castOwner<AFGBuildableSplitterSmart>(owner, ownerFlags, EEfficiencyCheckerClassFlags::SplitterSmart);
+				TSharedPtr<const FEfficiencyCheckerSortRules> sortRules;
+				if (smartSplitter)
+				{
+					sortRules = logic->getSortRules(smartSplitter);
+				}
+
+				if (sortRules)
+				{
+					currentOutputIndex = sortRules->getOutputIndex(connector);
+
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						for (int x = 0; x < smartSplitter->GetNumSortRules(); ++x)
+						{
+							auto rule = smartSplitter->GetSortRuleAt(x);
+
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								TEXT("Rule "),
+								x,
+								TEXT(" / output index = "),
+								rule.OutputIndex,
+								TEXT(" / item = "),
+								*UFGItemDescriptor::GetItemName(rule.ItemClass).ToString(),
+								TEXT(" / class = "),
+								*GetPathNameSafe(rule.ItemClass)
+								);
+						}
+					}
+
+					// Already restricted. Restrict further
+					sortRules->resolve(restrictItems, logic->anyUndefinedItemMask, restrictedItemsByOutput);
+
+					if (sortRules->hasRules(currentOutputIndex) && !restrictedItemsByOutput[currentOutputIndex].Num())
+					{
+						// Can't go further. Return
+						return;
+					}
+				}
+
+				TArray<UFGFactoryConnectionComponent*> connectedInputs, connectedOutputs;
+				for (auto connection : components)
+				{
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT)
+					{
+						connectedInputs.Add(connection);
+					}
+					else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
+					{
+						connectedOutputs.Add(connection);
+					}
+				}
+
+				if (connectedInputs.Num() == 1 && connectedOutputs.Num() == 1)
+				{
+					markConnected(buildable);
+
+					connector = connectedInputs[0]->GetConnection();
+
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
+					}
+
+					if (sortRules)
+					{
+						restrictItems = FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, sortRules->getOutputIndex(connectedOutputs[0]));
+					}
+
+					continue;
+				}
+
+				if (connectedInputs.Num() == 0)
+				{
+					// Nothing is being inputed. Bail
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" has no input"));
+
+					markConnected(buildable);
+
+					return;
+				}
+
+				const auto childRestrictItems = currentOutputIndex < 0 ? restrictItems : FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, currentOutputIndex);
+
+				for (auto connection : components)
+				{
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() != EFactoryConnectionDirection::FCD_INPUT)
+					{
+						continue;
+					}
+
+					if (dockingStation && connection->GetName().Equals(TEXT("Input0"), ESearchCase::IgnoreCase))
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), false, childRestrictItems);
+				}
+
+				for (auto connection : components)
+				{
+					if (connection == connector)
+					{
+						continue;
+					}
+
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
+					{
+						continue;
+					}
+
+					if (currentOutputIndex >= 0)
+					{
+						const auto outputIndex = sortRules->getOutputIndex(connection);
+
+						addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, outputIndex), true);
+					}
+					else
+					{
+						addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+					}
+				}
+
+				expand(frame, EExpansion::Solid, owner, buildable);
+
+				frame.dockingStation = dockingStation != nullptr;
+
+				return;
+			}
+		}
+
+		if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+		{
+			auto pipeline = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipeline>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Pipeline);
+
+			auto fluidIntegrant = EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::FluidIntegrant) ? Cast<IFGFluidIntegrantInterface>(owner) : nullptr;
+			if (fluidIntegrant)
+			{
+				if (expandPipeNetwork(frame, owner))
+				{
+					return;
+				}
+
+				auto buildable = Cast<AFGBuildable>(owner);
+
+				TArray<UFGPipeConnectionComponent*> unindexedComponents;
+				const auto& components = AEfficiencyCheckerLogic::getPipeConnections(owner, unindexedComponents);
+
+				if (pipeline)
+				{
+					applyLimit(frame.limitSlot, AEfficiencyCheckerLogic::getPipeSpeed(pipeline), pipeline);
+				}
+
+				auto otherConnections = seenActors.Num() == 1
+					                        ? components
+					                        : components.FilterByPredicate(
+						                        [connector](UFGPipeConnectionComponent* pipeConnection)
+						                        {
+							                        return
+								                        pipeConnection != connector && pipeConnection->IsConnected();
+						                        }
+						                        );
+
+				auto pipePump = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipelinePump>(owner, ownerFlags, EEfficiencyCheckerClassFlags::PipelinePump);
+				auto pipeConnection = Cast<UFGPipeConnectionComponent>(connector);
+
+				if (pipePump && pipePump->GetUserFlowLimit() > 0 && components.Num() == 2 && components[0]->IsConnected() && components[1]->IsConnected())
+				{
+					applyLimit(frame.limitSlot, AEfficiencyCheckerLogic::getPumpFlowLimit(pipePump), pipePump);
+				}
+
+				if (otherConnections.Num() == 0)
+				{
+					// No more connections. Bail
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *owner->GetName(), TEXT(" has no other connection"));
+
+					markConnected(buildable);
+
+					return;
+				}
+
+				if (otherConnections.Num() == 1 &&
+					(otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER &&
+						otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER ||
+						pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER &&
+						otherConnections[0]->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER))
+				{
+					markConnected(buildable);
+
+					connector = otherConnections[0]->GetConnection();
+
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
+					}
+
+					continue;
+				}
+
+				bool firstActor = seenActors.Num() == 1;
+
+				for (auto connection : components)
+				{
+					if (connection == connector && !firstActor)
+					{
+						continue;
+					}
+
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), false, restrictItems);
+				}
+
+				if (pipePump && pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
+				{
+					for (auto connection : components)
+					{
+						if (connection == connector)
+						{
+							continue;
+						}
+
+						if (!connection->IsConnected() || connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER)
+						{
+							continue;
+						}
+
+						addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+					}
+				}
+
+				expand(frame, EExpansion::Fluid, owner, buildable);
+
+				frame.pipeline = pipeline != nullptr;
+
+				return;
+			}
+
+			auto cargoPlatform = AEfficiencyCheckerLogic::castOwner<AFGBuildableTrainPlatformCargo>(owner, ownerFlags, EEfficiencyCheckerClassFlags::TrainPlatformCargo);
+			if (cargoPlatform)
+			{
+				// Copied, as the linked platforms add theirs
+				TArray<UFGPipeConnectionComponent*> unindexedConnections;
+				auto pipeConnections = AEfficiencyCheckerLogic::getPipeConnections(cargoPlatform, unindexedConnections);
+
+				for (auto stopCargo : getLinkedCargoPlatforms(cargoPlatform, indent))
+				{
+					seenActors.Add(stopCargo);
+
+					const auto& cargoPipeConnections = AEfficiencyCheckerLogic::getPipeConnections(stopCargo, unindexedConnections);
+
+					pipeConnections.Append(
+						cargoPipeConnections.FilterByPredicate(
+							[&pipeConnections, stopCargo](UFGPipeConnectionComponent* connection)
+							{
+								if (pipeConnections.Contains(connection))
+								{
+									// Already in use
+									return false;
+								}
+
+								if (stopCargo->GetIsInLoadMode())
+								{
+									// Loading
+									return true;
+								}
+
+								if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
+								{
+									// Is not a consumer connection
+									return true;
+								}
+
+								return false;
+							}
+							)
+						);
+				}
+
+				for (auto connection : pipeConnections)
+				{
+					if (!connection->IsConnected() ||
+						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER ||
+						connection == connector)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), false, restrictItems);
+				}
+
+				for (auto connection : pipeConnections)
+				{
+					if (connection == connector ||
+						!connection->IsConnected() ||
+						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+				}
+
+				expand(frame, EExpansion::FluidCargo, owner, cargoPlatform);
+
+				// Kept when no consumer connection is followed
+				frame.limitedThroughput = out_limitedThroughput;
+				frame.limitedBy = limitSegments[frame.limitSlot];
+
+				return;
+			}
+		}
+
+		{
+			const auto nuclearGenerator = AEfficiencyCheckerLogic::castOwner<AFGBuildableGeneratorNuclear>(owner, ownerFlags, EEfficiencyCheckerClassFlags::GeneratorNuclear);
+			if (nuclearGenerator)
+			{
+				out_injectedItems.Append(logic->nuclearWasteItemMask);
+
+				markConnected(nuclearGenerator);
+
+				out_injectedInput += 0.2;
+
+				return;
+			}
+		}
+
+		if (EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::SimpleProducer))
+		{
+			TSubclassOf<UFGItemDescriptor> itemType = FReflectionHelper::GetObjectPropertyValue<UClass>(owner, TEXT("mItemType"));
+			auto timeToProduceItem = FReflectionHelper::GetPropertyValue<UFloatProperty>(owner, TEXT("mTimeToProduceItem"));
+
+			if (timeToProduceItem && itemType)
+			{
+				out_injectedItems.Add(logic->getItemIndex(itemType));
+
+				out_injectedInput += 60 / timeToProduceItem;
+			}
+
+			markConnected(Cast<AFGBuildable>(owner));
+
+			return;
+		}
+
+		// out_limitedThroughput = 0;
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			AEfficiencyCheckerLogic::dumpUnknownClass(indent, owner);
+		}
+
+		return;
+	}
+}
+
+void FEfficiencyCheckerTraversal::visitOutput(int32 frameIndex)
+{
+	auto& frame = frames[frameIndex];
+
+	auto& connector = frame.connector;
+	auto& injectedItems = frame.items;
+
+	auto& seenActors = outputSeen[frame.seenSlot];
+	auto& out_requiredOutput = amounts[frame.amountSlot];
+	auto& out_limitedThroughput = amounts[frame.limitSlot];
+
+	const auto indent = getIndent(frame.level);
+
+	for (;;)
+	{
+		if (!connector)
+		{
+			return;
+		}
+
+		const auto node = logic->getNode(logic->findConnectionNode(connector));
+
+		auto owner = node ? node->buildable : connector->GetOwner();
+
+		if (!owner)
+		{
+			return;
+		}
+
+		const auto ownerFlags = node ? node->classFlags : logic->getClassFlags(owner->GetClass());
+
+		if (recordings.Num() && AEfficiencyCheckerLogic::containsActor(seenActors, owner))
+		{
+			// Even when not all items were seen there, the ones that were change what is followed
+			noteSeen(owner);
+		}
+
+		if (!injectedItems.IsEmpty())
+		{
+			if (AEfficiencyCheckerLogic::actorContainsAllItems(seenActors, owner, injectedItems))
+			{
+				return;
+			}
+		}
+		else
+		{
+			if (AEfficiencyCheckerLogic::containsActor(seenActors, owner))
+			{
+				return;
+			}
+		}
+
+		if (!enterNode(frame, owner))
+		{
+			return;
+		}
+
+		enterActor(frame, owner, ownerFlags);
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			SML::Logging::info(
+				*AEfficiencyCheckerLogic::getTimeStamp(),
+				*indent,
+				TEXT("collectOutput at level "),
+				frame.level,
+				TEXT(": "),
+				*owner->GetName(),
+				TEXT(" / "),
+				*GetPathNameSafe(owner->GetClass())
+				);
+		}
+
+		if (resourceForm == EResourceForm::RF_SOLID &&
+			EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment) &&
+			expandLoop(frame, owner))
+		{
+			return;
+		}
+
+		if (resourceForm == EResourceForm::RF_SOLID &&
+			EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase | EEfficiencyCheckerClassFlags::ConveyorAttachment) &&
+			followChain(frame, owner))
+		{
+			continue;
+		}
+
+		{
+			const auto manufacturer = AEfficiencyCheckerLogic::castOwner<AFGBuildableManufacturer>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Manufacturer);
+			if (manufacturer)
+			{
+				const auto recipeClass = manufacturer->GetCurrentRecipe();
+				const auto recipe = logic->getRecipe(recipeClass);
+
+				if (recipe)
+				{
+					for (const auto& item : recipe->ingredients)
+					{
+						const auto itemForm = item.form;
+
+						if (itemForm == EResourceForm::RF_SOLID && resourceForm != EResourceForm::RF_SOLID ||
+							(itemForm == EResourceForm::RF_LIQUID || itemForm == EResourceForm::RF_GAS) &&
+							resourceForm != EResourceForm::RF_LIQUID && resourceForm != EResourceForm::RF_GAS)
+						{
+							continue;
+						}
+
+						const auto itemIndex = item.itemIndex;
+
+						if (!injectedItems.Contains(itemIndex) || AEfficiencyCheckerLogic::actorContainsItem(seenActors, manufacturer, itemIndex))
+						{
+							continue;
+						}
+
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Item amount = "), item.amount);
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Current potential = "), manufacturer->GetCurrentPotential());
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Pending potential = "), manufacturer->GetPendingPotential());
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								TEXT("Production cycle time = "),
+								manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential())
+								);
+							SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Recipe duration = "), UFGRecipe::GetManufacturingDuration(recipeClass));
+						}
+
+						float itemAmountPerMinute = item.amount * (60.0 / manufacturer->CalcProductionCycleTimeForPotential(manufacturer->GetPendingPotential()));
+
+						if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+						{
+							itemAmountPerMinute /= 1000;
+						}
+
+						// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
+						// {
+						//     if (fullClassName.EndsWith(TEXT("MK2_C")))
+						//     {
+						//         itemAmountPerMinute *= 1.5;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
+						//     {
+						//         itemAmountPerMinute *= 2;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
+						//     {
+						//         itemAmountPerMinute *= 2.5;
+						//     }
+						// }
+						// else if (fullClassName.StartsWith(TEXT("/Game/FarmingMod/Buildable")))
+						// {
+						//     if (fullClassName.EndsWith(TEXT("Mk2_C")))
+						//     {
+						//         itemAmountPerMinute *= 2;
+						//     }
+						//     else if (fullClassName.EndsWith(TEXT("Mk3_C")))
+						//     {
+						//         itemAmountPerMinute *= 3;
+						//     }
+						// }
+
+						if (FEfficiencyCheckerModModule::dumpConnections)
+						{
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								*manufacturer->GetName(),
+								TEXT(" consumes "),
+								itemAmountPerMinute,
+								TEXT(" "),
+								*UFGItemDescriptor::GetItemName(item.item).ToString(),
+								TEXT("/minute")
+								);
+						}
+
+						out_requiredOutput += itemAmountPerMinute;
+
+						seenActors.FindOrAdd(manufacturer).Add(itemIndex);
+					}
+				}
+
+				markConnected(manufacturer);
+
+				return;
+			}
+		}
+
+		if (resourceForm == EResourceForm::RF_SOLID)
+		{
+			const auto conveyor = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorBase>(owner, ownerFlags, EEfficiencyCheckerClassFlags::ConveyorBase);
+			if (conveyor)
+			{
+				AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, conveyor, injectedItems);
+
+				markConnected(conveyor);
+
+				connector = conveyor->GetConnection1()->GetConnection();
+
+				applyLimit(frame.limitSlot, conveyor->GetSpeed() / 2, conveyor);
+
+				if (FEfficiencyCheckerModModule::dumpConnections)
+				{
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *conveyor->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
+				}
+
+				continue;
+			}
+
+			AFGBuildableStorage* storageContainer = nullptr;
+			AFGBuildableTrainPlatformCargo* cargoPlatform = nullptr;
+			AFGBuildableConveyorAttachment* conveyorAttachment = nullptr;
+			AFGBuildableDockingStation* dockingStation = nullptr;
+			AFGBuildableFactory* storageTeleporter = nullptr;
+
+			AFGBuildableFactory* buildable = AEfficiencyCheckerLogic::castOwner<AFGBuildableConveyorAttachment>(owner, ownerFlags, EEfficiencyCheckerClassFlags::ConveyorAttachment);
+			if (!buildable)
+			{
+				buildable = storageContainer = AEfficiencyCheckerLogic::castOwner<AFGBuildableStorage>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Storage);
+			}
+
+			if (!buildable)
+			{
+				buildable = cargoPlatform = AEfficiencyCheckerLogic::castOwner<AFGBuildableTrainPlatformCargo>(owner, ownerFlags, EEfficiencyCheckerClassFlags::TrainPlatformCargo);
+			}
+
+			if (!buildable)
+			{
+				buildable = dockingStation = AEfficiencyCheckerLogic::castOwner<AFGBuildableDockingStation>(owner, ownerFlags, EEfficiencyCheckerClassFlags::DockingStation);
+			}
+
+			if (!FEfficiencyCheckerModModule::ignoreStorageTeleporter &&
+				!buildable && EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::StorageTeleporter))
+			{
+				buildable = storageTeleporter = AEfficiencyCheckerLogic::castOwner<AFGBuildableFactory>(owner, ownerFlags, EEfficiencyCheckerClassFlags::StorageTeleporter);
+			}
+
+			if (buildable)
+			{
+				AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, buildable, injectedItems);
+
+				TArray<UFGFactoryConnectionComponent*> unindexedComponents;
+				TArray<UFGFactoryConnectionComponent*> linkedComponents;
+
+				const auto& ownComponents = AEfficiencyCheckerLogic::getFactoryConnections(buildable, unindexedComponents);
+
+				// Only copied when linked platforms or teleporters add theirs
+				const auto linked = cargoPlatform || storageTeleporter;
+				if (linked)
+				{
+					linkedComponents = ownComponents;
+				}
+
+				if (cargoPlatform)
+				{
+					for (auto stopCargo : getLinkedCargoPlatforms(cargoPlatform, indent))
+					{
+						AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, stopCargo, injectedItems);
+
+						linkedComponents.Append(
+							AEfficiencyCheckerLogic::getFactoryConnections(stopCargo, unindexedComponents).FilterByPredicate(
+								[&linkedComponents, stopCargo](UFGFactoryConnectionComponent* connection)
+								{
+									return !linkedComponents.Contains(connection) && // Not in use already
+										!stopCargo->GetIsInLoadMode() && // Unload mode
+										connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT; // Is output connection
+								}
+								)
+							);
+					}
+				}
+
+				if (storageTeleporter)
+				{
+					for (auto testTeleporter : getLinkedTeleporters(storageTeleporter))
+					{
+						AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, testTeleporter, injectedItems);
+
+						auto factory = Cast<AFGBuildableFactory>(testTeleporter);
+						if (factory)
+						{
+							linkedComponents.Append(
+								AEfficiencyCheckerLogic::getFactoryConnections(factory, unindexedComponents).FilterByPredicate(
+									[&linkedComponents](UFGFactoryConnectionComponent* connection)
+									{
+										return !linkedComponents.Contains(connection) && // Not in use already
+											connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT; // Is output connection
+									}
+									)
+								);
+						}
+					}
+				}
+
+				const auto& components = linked ? linkedComponents : ownComponents;
+
+				TArray<FEfficiencyCheckerItemSet> restrictedItemsByOutput;
+
+				// Filter items
+				auto smartSplitter = AEfficiencyCheckerLogic::castOwner<AFGBuildableSplitterSmart>(owner, ownerFlags, EEfficiencyCheckerClassFlags::SplitterSmart);
+				TSharedPtr<const FEfficiencyCheckerSortRules> sortRules;
+				if (smartSplitter)
+				{
+					sortRules = logic->getSortRules(smartSplitter);
+				}
+
+				if (sortRules)
+				{
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						for (int x = 0; x < smartSplitter->GetNumSortRules(); ++x)
+						{
+							auto rule = smartSplitter->GetSortRuleAt(x);
+
+							SML::Logging::info(
+								*AEfficiencyCheckerLogic::getTimeStamp(),
+								*indent,
+								TEXT("Rule "),
+								x,
+								TEXT(" / output index = "),
+								rule.OutputIndex,
+								TEXT(" / item = "),
+								*UFGItemDescriptor::GetItemName(rule.ItemClass).ToString(),
+								TEXT(" / class = "),
+								*GetPathNameSafe(rule.ItemClass)
+								);
+						}
+					}
+
+					sortRules->resolve(injectedItems, logic->anyUndefinedItemMask, restrictedItemsByOutput);
+
+					for (auto& outputItems : restrictedItemsByOutput)
+					{
+						outputItems = outputItems.Intersect(injectedItems);
+					}
+				}
+
+				TArray<UFGFactoryConnectionComponent*> connectedInputs, connectedOutputs;
+				for (auto connection : components)
+				{
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() == EFactoryConnectionDirection::FCD_INPUT)
+					{
+						connectedInputs.Add(connection);
+					}
+					else if (connection->GetDirection() == EFactoryConnectionDirection::FCD_OUTPUT)
+					{
+						connectedOutputs.Add(connection);
+					}
+				}
+
+				if (connectedInputs.Num() == 1 && connectedOutputs.Num() == 1)
+				{
+					markConnected(buildable);
+
+					connector = connectedOutputs[0]->GetConnection();
+
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
+					}
+
+					if (sortRules)
+					{
+						injectedItems = FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, sortRules->getOutputIndex(connectedOutputs[0]));
+					}
+
+					continue;
+				}
+
+				if (connectedOutputs.Num() == 0)
+				{
+					// Nothing is being outputed. Bail
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" has no input"));
+
+					markConnected(buildable);
+
+					return;
+				}
+
+				if (dockingStation && connector->GetName().Equals(TEXT("Input0"), ESearchCase::IgnoreCase))
+				{
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" limited at "), out_limitedThroughput, TEXT(" items/minute"));
+					}
+
+					markConnected(buildable);
+
+					return;
+				}
+
+				for (auto connection : components)
+				{
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetConnector() != EFactoryConnectionConnector::FCC_CONVEYOR)
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() != EFactoryConnectionDirection::FCD_OUTPUT)
+					{
+						continue;
+					}
+
+					if (sortRules)
+					{
+						const auto outputIndex = sortRules->getOutputIndex(connection);
+
+						addChild(frame, connection->GetConnection(), false, FEfficiencyCheckerSortRules::getItems(restrictedItemsByOutput, outputIndex));
+					}
+					else
+					{
+						addChild(frame, connection->GetConnection(), false, injectedItems);
+					}
+				}
+
+				for (auto connection : components)
+				{
+					if (connection == connector)
+					{
+						continue;
+					}
+
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetDirection() != EFactoryConnectionDirection::FCD_INPUT)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+				}
+
+				expand(frame, EExpansion::Solid, owner, buildable);
+
+				return;
+			}
+		}
+
+		if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+		{
+			auto pipeline = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipeline>(owner, ownerFlags, EEfficiencyCheckerClassFlags::Pipeline);
+
+			auto fluidIntegrant = EnumHasAnyFlags(ownerFlags, EEfficiencyCheckerClassFlags::FluidIntegrant) ? Cast<IFGFluidIntegrantInterface>(owner) : nullptr;
+			if (fluidIntegrant)
+			{
+				auto buildable = Cast<AFGBuildable>(owner);
+
+				AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, buildable, injectedItems);
+
+				if (expandPipeNetwork(frame, owner))
+				{
+					return;
+				}
+
+				TArray<UFGPipeConnectionComponent*> unindexedComponents;
+				const auto& components = AEfficiencyCheckerLogic::getPipeConnections(owner, unindexedComponents);
+
+				if (pipeline)
+				{
+					applyLimit(frame.limitSlot, AEfficiencyCheckerLogic::getPipeSpeed(pipeline), pipeline);
+				}
+
+				auto otherConnections = seenActors.Num() == 1
+					                        ? components
+					                        : components.FilterByPredicate(
+						                        [connector](UFGPipeConnectionComponent* pipeConnection)
+						                        {
+							                        return pipeConnection != connector && pipeConnection->IsConnected();
+						                        }
+						                        );
+
+				auto pipePump = AEfficiencyCheckerLogic::castOwner<AFGBuildablePipelinePump>(owner, ownerFlags, EEfficiencyCheckerClassFlags::PipelinePump);
+				auto pipeConnection = Cast<UFGPipeConnectionComponent>(connector);
+
+				if (pipePump && pipePump->GetUserFlowLimit() > 0 && components.Num() == 2 && components[0]->IsConnected() && components[1]->IsConnected())
+				{
+					applyLimit(frame.limitSlot, AEfficiencyCheckerLogic::getPumpFlowLimit(pipePump), pipePump);
+				}
+
+				if (otherConnections.Num() == 0)
+				{
+					// No more connections. Bail
+					SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *owner->GetName(), TEXT(" has no other connection"));
+
+					markConnected(buildable);
+
+					return;
+				}
+
+				if (otherConnections.Num() == 1 &&
+					(otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_CONSUMER &&
+						otherConnections[0]->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER ||
+						pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER &&
+						otherConnections[0]->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER))
+				{
+					markConnected(buildable);
+
+					connector = otherConnections[0]->GetConnection();
+
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, *buildable->GetName(), TEXT(" skipped"));
+					}
+
+					continue;
+				}
+
+				bool firstActor = seenActors.Num() == 1;
+
+				for (auto connection : (firstActor ? components : otherConnections))
+				{
+					if (connection == connector && !firstActor)
+					{
+						continue;
+					}
+
+					if (!connection->IsConnected())
+					{
+						continue;
+					}
+
+					if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), false, injectedItems);
+				}
+
+				if (pipePump && pipeConnection->GetPipeConnectionType() == EPipeConnectionType::PCT_CONSUMER)
+				{
+					for (auto connection : components)
+					{
+						if (connection == connector)
+						{
+							continue;
+						}
+
+						if (!connection->IsConnected() || connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
+						{
+							continue;
+						}
+
+						addChild(frame, connection->GetConnection(), true, FEfficiencyCheckerItemSet());
+					}
+				}
+
+				expand(frame, EExpansion::Fluid, owner, buildable);
+
+				frame.pipeline = pipeline != nullptr;
+
+				return;
+			}
+
+			auto cargoPlatform = AEfficiencyCheckerLogic::castOwner<AFGBuildableTrainPlatformCargo>(owner, ownerFlags, EEfficiencyCheckerClassFlags::TrainPlatformCargo);
+			if (cargoPlatform)
+			{
+				AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, cargoPlatform, injectedItems);
+
+				// Copied, as the linked platforms add theirs
+				TArray<UFGPipeConnectionComponent*> unindexedConnections;
+				auto pipeConnections = AEfficiencyCheckerLogic::getPipeConnections(cargoPlatform, unindexedConnections);
+
+				for (auto stopCargo : getLinkedCargoPlatforms(cargoPlatform, indent))
+				{
+					AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, stopCargo, injectedItems);
+
+					const auto& cargoPipeConnections = AEfficiencyCheckerLogic::getPipeConnections(stopCargo, unindexedConnections);
+
+					pipeConnections.Append(
+						cargoPipeConnections.FilterByPredicate(
+							[&pipeConnections, stopCargo](UFGPipeConnectionComponent* connection)
+							{
+								if (pipeConnections.Contains(connection))
+								{
+									// Already in use
+									return false;
+								}
+
+								if (stopCargo->GetIsInLoadMode())
+								{
+									// Loading
+									return false;
+								}
+
+								if (connection->GetPipeConnectionType() == EPipeConnectionType::PCT_PRODUCER)
+								{
+									// It is a producer connection
+									return true;
+								}
+
+								return false;
+							}
+							)
+						);
+				}
+
+				for (auto connection : pipeConnections)
+				{
+					if (!connection->IsConnected() ||
+						connection->GetPipeConnectionType() != EPipeConnectionType::PCT_PRODUCER)
+					{
+						continue;
+					}
+
+					addChild(frame, connection->GetConnection(), false, injectedItems);
+				}
+
+				expand(frame, EExpansion::FluidCargo, owner, cargoPlatform);
+
+				return;
+			}
+		}
+
+		{
+			const auto generator = AEfficiencyCheckerLogic::castOwner<AFGBuildableGeneratorFuel>(owner, ownerFlags, EEfficiencyCheckerClassFlags::GeneratorFuel);
+			if (generator)
+			{
+				const auto supplementalItemIndex = logic->getItemIndex(generator->GetSupplementalResourceClass());
+
+				if (injectedItems.Contains(supplementalItemIndex) && !AEfficiencyCheckerLogic::actorContainsItem(seenActors, generator, supplementalItemIndex))
+				{
+					if (FEfficiencyCheckerModModule::dumpConnections)
+					{
+						SML::Logging::info(
+							*AEfficiencyCheckerLogic::getTimeStamp(),
+							*indent,
+							TEXT("Supplemental item = "),
+							*UFGItemDescriptor::GetItemName(generator->GetSupplementalResourceClass()).ToString()
+							);
+						SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Supplemental amount = "), generator->GetSupplementalConsumptionRateMaximum());
+					}
+
+					out_requiredOutput += generator->GetSupplementalConsumptionRateMaximum() * (
+						(UFGItemDescriptor::GetForm(generator->GetSupplementalResourceClass()) == EResourceForm::RF_LIQUID ||
+							UFGItemDescriptor::GetForm(generator->GetSupplementalResourceClass()) == EResourceForm::RF_GAS)
+							? 60
+							: 1);
+
+					seenActors.FindOrAdd(generator).Add(supplementalItemIndex);
+				}
+				else
+				{
+					for (auto itemIndex : injectedItems)
+					{
+						const auto item = logic->getItemDescriptor(itemIndex);
+
+						if (generator->IsValidFuel(item) && !AEfficiencyCheckerLogic::actorContainsItem(seenActors, generator, itemIndex))
+						{
+							if (FEfficiencyCheckerModModule::dumpConnections)
+							{
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Energy item = "), *UFGItemDescriptor::GetItemName(item).ToString());
+							}
+
+							float energy = logic->getItemEnergyValue(itemIndex);
+
+							// if (UFGItemDescriptor::GetForm(out_injectedItem) == EResourceForm::RF_LIQUID)
+							// {
+							//     energy *= 1000;
+							// }
+
+							if (FEfficiencyCheckerModModule::dumpConnections)
+							{
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Energy = "), energy);
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Current potential = "), generator->GetCurrentPotential());
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Pending potential = "), generator->GetPendingPotential());
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Power production capacity = "), generator->GetPowerProductionCapacity());
+								SML::Logging::info(*AEfficiencyCheckerLogic::getTimeStamp(), *indent, TEXT("Default power production capacity = "), generator->GetDefaultPowerProductionCapacity());
+							}
+
+							float itemAmountPerMinute = 60 / (energy / generator->GetPowerProductionCapacity());
+
+							if (resourceForm == EResourceForm::RF_LIQUID || resourceForm == EResourceForm::RF_GAS)
+							{
+								itemAmountPerMinute /= 1000;
+							}
+
+							// if (fullClassName.StartsWith(TEXT("/Game/MK22k20/Buildable")))
+							// {
+							//     if (fullClassName.EndsWith(TEXT("MK2_C")))
+							//     {
+							//         itemAmountPerMinute *= 1.5;
+							//     }
+							//     else if (fullClassName.EndsWith(TEXT("MK3_C")))
+							//     {
+							//         itemAmountPerMinute *= 2;
+							//     }
+							//     else if (fullClassName.EndsWith(TEXT("MK4_C")))
+							//     {
+							//         itemAmountPerMinute *= 2.5;
+							//     }
+							// }
+
+							if (FEfficiencyCheckerModModule::dumpConnections)
+							{
+								SML::Logging::info(
+									*AEfficiencyCheckerLogic::getTimeStamp(),
+									*indent,
+									*generator->GetName(),
+									TEXT(" consumes "),
+									itemAmountPerMinute,
+									TEXT(" "),
+									*UFGItemDescriptor::GetItemName(item).ToString(),
+									TEXT("/minute")
+									);
+							}
+
+							seenActors.FindOrAdd(generator).Add(itemIndex);
+							out_requiredOutput += itemAmountPerMinute;
+
+							break;
+						}
+					}
+				}
+
+				markConnected(generator);
+
+				return;
+			}
+		}
+
+		AEfficiencyCheckerLogic::addAllItemsToActor(seenActors, owner, injectedItems);
+
+		// out_limitedThroughput = 0;
+
+		if (FEfficiencyCheckerModModule::dumpConnections)
+		{
+			AEfficiencyCheckerLogic::dumpUnknownClass(indent, owner);
+		}
+
+		return;
+	}
+}
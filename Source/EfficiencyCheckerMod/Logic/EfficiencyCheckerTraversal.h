@@ -0,0 +1,423 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "EfficiencyCheckerBuilding.h"
+#include "FGItemDescriptor.h"
+#include "Logic/EfficiencyCheckerGraph.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+#include "Logic/EfficiencyCheckerMaxFlow.h"
+#include "Logic/EfficiencyCheckerSeenActors.h"
+#include "Logic/EfficiencyCheckerSubWalkCache.h"
+
+class AActor;
+class AEfficiencyCheckerLogic;
+class AFGBuildable;
+class AFGBuildableFactory;
+class AFGBuildableSubsystem;
+class AFGBuildableTrainPlatformCargo;
+class UFGConnectionComponent;
+
+/**
+ * Walks the production graph with an explicit stack instead of native recursion.
+ *
+ * Each frame is one pending collectInput/collectOutput call. Straight runs (belts, pass-through attachments and pipes)
+ * are followed inside the same frame. Nodes with several branches are expanded into a list of children, which are run
+ * one at a time, and their results are folded into the frame when each one finishes.
+ *
+ * Accumulators and seen sets are kept on pooled slots and referenced by index, so that children can share them with
+ * their parent the same way the recursive version shared references.
+ *
+ * As the whole walk state lives in the traversal, a walk can also be started with beginInput/beginOutput, run in
+ * slices with resume, and read back with finishInput/finishOutput once it is complete.
+ *
+ * With cacheSubWalks, each input child that runs the same direction as its parent is recorded, and stored in
+ * AEfficiencyCheckerLogic::subWalks when its result did not depend on what its caller had already seen. Later children
+ * with the same key are replayed from there instead of being walked again.
+ */
+class FEfficiencyCheckerTraversal
+{
+public:
+    FEfficiencyCheckerTraversal(EResourceForm in_resourceForm, TSet<AFGBuildable*>& in_connected, AFGBuildableSubsystem* in_buildableSubsystem);
+
+    void collectInput
+    (
+        bool customInjectedInput,
+        UFGConnectionComponent* connector,
+        float& out_injectedInput,
+        float& out_limitedThroughput,
+        TSet<AActor*>& seenActors,
+        FEfficiencyCheckerItemSet& out_injectedItems,
+        const FEfficiencyCheckerItemSet& restrictItems
+    );
+
+    void collectOutput
+    (
+        UFGConnectionComponent* connector,
+        float& out_requiredOutput,
+        float& out_limitedThroughput,
+        FEfficiencyCheckerSeenActors& seenActors,
+        const FEfficiencyCheckerItemSet& injectedItems
+    );
+
+    void beginInput
+    (
+        bool customInjectedInput,
+        UFGConnectionComponent* connector,
+        float injectedInput,
+        float limitedThroughput,
+        const TSet<AActor*>& seenActors,
+        const FEfficiencyCheckerItemSet& injectedItems,
+        const FEfficiencyCheckerItemSet& restrictItems
+    );
+
+    void finishInput
+    (
+        float& out_injectedInput,
+        float& out_limitedThroughput,
+        TSet<AActor*>& out_seenActors,
+        FEfficiencyCheckerItemSet& out_injectedItems
+    );
+
+    void beginOutput
+    (
+        UFGConnectionComponent* connector,
+        float requiredOutput,
+        float limitedThroughput,
+        const FEfficiencyCheckerSeenActors& seenActors,
+        const FEfficiencyCheckerItemSet& injectedItems
+    );
+
+    void finishOutput
+    (
+        float& out_requiredOutput,
+        float& out_limitedThroughput,
+        FEfficiencyCheckerSeenActors& out_seenActors
+    );
+
+    // Walks until the traversal is complete, or until sliceNodes nodes were entered or sliceDeadline (FPlatformTime::Seconds)
+    // has passed. Zero limits are unbounded. At least one node is entered per call. With solveMaxFlow, the network built
+    // for the solver once the walk is done counts against the same slices. True when the traversal is complete
+    bool resume(int32 sliceNodes = 0, double sliceDeadline = 0);
+
+    inline bool
+    hasOverflow() const
+    {
+        return overflow;
+    }
+
+    inline int32
+    getVisitedNodes() const
+    {
+        return visitedNodes;
+    }
+
+    // Segments that set the limited throughput of the last finished walk, with the way to each of them from its start
+    inline const TArray<FEfficiencyCheckerBottleneck>&
+    getBottlenecks() const
+    {
+        return lastBottlenecks;
+    }
+
+protected:
+    enum class EFrameKind : uint8
+    {
+        Input,
+        Output
+    };
+
+    enum class EExpansion : uint8
+    {
+        None,
+        Solid,
+        Fluid,
+        FluidCargo,
+        Loop
+    };
+
+    enum class EMaxFlowStep : uint8
+    {
+        None,
+        Vertices,
+        Edges,
+        Solve,
+        Done
+    };
+
+    struct FChild
+    {
+        // Connection on the other side, where the child starts
+        UFGConnectionComponent* connection = nullptr;
+
+        // Walks the opposite direction, to discount what is taken by other branches
+        bool discount = false;
+
+        // For discount children of an input frame, restricts the injected items to these
+        bool restrictToItems = false;
+
+        FEfficiencyCheckerItemSet items;
+    };
+
+    struct FFrame
+    {
+        EFrameKind kind = EFrameKind::Input;
+
+        UFGConnectionComponent* connector = nullptr;
+
+        // restrictItems of an input frame, injectedItems of an output frame
+        FEfficiencyCheckerItemSet items;
+
+        bool customInjectedInput = false;
+
+        int32 level = 0;
+
+        // Walks the same direction as the root frame, so the actors it enters are on the way from the start
+        bool mainWalk = false;
+
+        // Last actor entered by this frame, or the one that expanded it
+        AActor* previous = nullptr;
+
+        // Slots shared with the caller
+        int32 seenSlot = INDEX_NONE;
+        int32 injectedItemsSlot = INDEX_NONE;
+        int32 amountSlot = INDEX_NONE;
+        int32 limitSlot = INDEX_NONE;
+
+        // Expansion state
+        EExpansion expansion = EExpansion::None;
+        AActor* owner = nullptr;
+        AFGBuildable* buildable = nullptr;
+        bool pipeline = false;
+        bool dockingStation = false;
+
+        TArray<FChild> children;
+        int32 nextChild = 0;
+        bool childRunning = false;
+
+        bool firstConnection = true;
+        float limitedThroughput = 0;
+
+        // Segments that set limitedThroughput
+        TArray<AActor*> limitedBy;
+
+        // Slots handed to the running child
+        int32 childAmountSlot = INDEX_NONE;
+        int32 childLimitSlot = INDEX_NONE;
+
+        // The running child has a recording on top of the recordings stack
+        bool childRecorded = false;
+
+        // Pool sizes before the running child slots were allocated
+        int32 amountsMark = 0;
+        int32 itemSetsMark = 0;
+        int32 inputSeenMark = 0;
+        int32 outputSeenMark = 0;
+    };
+
+    // Input sub-walk being recorded, to be stored in the sub-walk cache when its child finishes
+    struct FRecording
+    {
+        FEfficiencyCheckerSubWalkKey key;
+        int32 epoch = 0;
+
+        // Log sizes, injected input and limit when the child started
+        int32 enteredMark = 0;
+        int32 connectedMark = 0;
+        float injectedInput = 0;
+        float startLimit = 0;
+
+        // Earliest entry on the log of the actors found already seen. Anything before enteredMark was seen by the caller
+        int32 earliestSeen = MAX_int32;
+
+        // Cleared when it entered a buildable whose contribution can change with nothing to tell
+        bool cacheable = true;
+    };
+
+    // Network of the finished walk for the max flow solver, built one buildable at a time so that it can be spread over
+    // slices like the walk itself
+    struct FMaxFlowBuild
+    {
+        EMaxFlowStep step = EMaxFlowStep::None;
+        EFrameKind kind = EFrameKind::Input;
+
+        // Actors seen by the walk, and the next one to add a vertex for, or the next buildable to add the edges of
+        TArray<AActor*> actors;
+        int32 next = 0;
+
+        FEfficiencyCheckerMaxFlow network;
+        int32 terminal = INDEX_NONE;
+        AActor* rootActor = nullptr;
+
+        // Buildables on the network, their capacity and their input vertex
+        TArray<AActor*> buildables;
+        TArray<float> capacities;
+        TMap<AActor*, int32> vertexByActor;
+
+        float value = FEfficiencyCheckerMaxFlow::unlimited;
+
+        // Saturated buildables of the minimum cut, and their capacity
+        TArray<AActor*> cut;
+        TArray<float> cutCapacities;
+
+        // Seconds spent over all the slices, for the connection dump
+        double elapsed = 0;
+    };
+
+    struct FEnteredActor
+    {
+        AActor* actor = nullptr;
+        AActor* from = nullptr;
+
+        // Input seen slot it was added to. INDEX_NONE for output frames
+        int32 inputSeenSlot = INDEX_NONE;
+    };
+
+    void run();
+
+    // Drops the pooled slots of a finished walk
+    void resetPools();
+
+    // Fills lastBottlenecks from the root limit slot, before the pools are dropped
+    void collectBottlenecks();
+
+    // Items are taken by value, as they may come from a frame that is moved when the stack grows
+    int32 pushFrame(EFrameKind kind, UFGConnectionComponent* connector, FEfficiencyCheckerItemSet items, int32 level);
+    void popFrame();
+
+    void visitInput(int32 frameIndex);
+    void visitOutput(int32 frameIndex);
+
+    // True when sliceNodes nodes were entered or sliceDeadline has passed in this slice
+    bool isSliceSpent() const;
+
+    // Accounts one more node. False when the node budget is exhausted and the traversal was aborted, or when the slice
+    // is spent and the traversal was suspended before entering the node
+    bool enterNode(const FFrame& frame, AActor* owner);
+
+    // Records the actor as entered by the frame, and where it was entered from
+    void enterActor(FFrame& frame, AActor* actor, EEfficiencyCheckerClassFlags actorFlags);
+
+    // Adds the buildable to the connected set, logging it for the open recordings
+    void markConnected(AFGBuildable* buildable);
+
+    // Called when the actor was found already seen, so that the open recording knows what it depends on
+    void noteSeen(AActor* actor);
+
+    void logEntered(AActor* actor, AActor* from, int32 inputSeenSlot);
+
+    // Applies a cached sub-walk in place of the child about to be launched. False when any actor it went through was
+    // already seen here, and it has to be walked
+    bool replaySubWalk(FFrame& frame, const FEfficiencyCheckerSubWalk& walk);
+
+    // Closes the recording of the child that just finished, storing it when it can be reused
+    void storeSubWalk(FFrame& frame);
+
+    // Lowers the limit on the slot to the capacity of the segment. Tied segments coming from different branches are all kept
+    void applyLimit(int32 limitSlot, float limit, AActor* segment);
+    void applyLimit(int32 limitSlot, float limit, const TArray<AActor*>& segments);
+
+    void expand(FFrame& frame, EExpansion expansion, AActor* owner, AFGBuildable* buildable);
+
+    // Takes the whole conveyor loop of the owner as a single node: its members are marked as seen at once, and only the
+    // connections crossing the loop boundary are walked. False when the owner is not part of a loop
+    bool expandLoop(FFrame& frame, AActor* owner);
+
+    // Takes the whole pipe network of the owner as a single node, limited by its narrowest cut: its members are
+    // marked as seen at once, and only the connections leaving the network are walked. False when the network can't be
+    // taken as a whole, like when it has pumps
+    bool expandPipeNetwork(FFrame& frame, AActor* owner);
+
+    // Goes through the chain of the owner up to its far end, marking each member as seen, and limited by its slowest
+    // belt. The connector is left on what follows the chain, or cleared when a member was already seen. False when the
+    // owner is not part of a chain
+    bool followChain(FFrame& frame, AActor* owner);
+    void addChild(FFrame& frame, UFGConnectionComponent* connection, bool discount, const FEfficiencyCheckerItemSet& items, bool restrictToItems = false);
+
+    void resumeFrame(int32 frameIndex);
+    void launchChild(int32 frameIndex);
+    void collectChild(FFrame& frame);
+    void finishExpansion(FFrame& frame);
+
+    int32 allocateAmount(float value);
+    int32 allocateItemSet(FEfficiencyCheckerItemSet value);
+    int32 allocateInputSeen();
+    int32 allocateOutputSeen();
+
+    // Other cargo platforms that trains stopping at the cargo station load from or unload to, on the matching offsets
+    TArray<AFGBuildableTrainPlatformCargo*> getLinkedCargoPlatforms(AFGBuildableTrainPlatformCargo* cargoPlatform, const FString& indent) const;
+
+    // Other storage teleporters sharing the same StorageID
+    TArray<AFGBuildable*> getLinkedTeleporters(AFGBuildableFactory* storageTeleporter) const;
+
+    // Lowers the limited throughput of the finished walk to its maximum flow, and takes the bottlenecks from the minimum cut
+    void applyMaxFlow(float& out_limitedThroughput);
+
+    // Limited throughput of the finished walk as the maximum flow of the network of its buildables: from everything that
+    // feeds it into the starting buildable when walking input, and from the starting buildable into everything it feeds
+    // when walking output. Built until done or until the slice is spent, when the traversal is suspended
+    void buildMaxFlow();
+    void startMaxFlow();
+    void addMaxFlowVertices();
+    void addMaxFlowEdges();
+    void solveMaxFlow();
+
+    // Indentation is only used for the connection dump, so it is built only when dumping
+    static FString getIndent(int32 level);
+
+    EResourceForm resourceForm;
+    TSet<AFGBuildable*>& connected;
+    AFGBuildableSubsystem* buildableSubsystem;
+
+    AEfficiencyCheckerLogic* logic;
+
+    TArray<FFrame> frames;
+    int32 frameNum = 0;
+
+    TArray<float> amounts;
+
+    // Segments that set each amount, for the limit slots. Allocated and released along with amounts
+    TArray<TArray<AActor*>> limitSegments;
+    TArray<FEfficiencyCheckerItemSet> itemSets;
+
+    TArray<TSet<AActor*>> inputSeen;
+    int32 inputSeenNum = 0;
+
+    TArray<FEfficiencyCheckerSeenActors> outputSeen;
+    int32 outputSeenNum = 0;
+
+    // Root frame start, for the max flow solver
+    UFGConnectionComponent* rootConnector = nullptr;
+    float rootInitialLimit = 0;
+
+    FMaxFlowBuild maxFlow;
+
+    // Slots of the root frame, read back when finishing
+    int32 rootSeenSlot = INDEX_NONE;
+    int32 rootItemsSlot = INDEX_NONE;
+    int32 rootAmountSlot = INDEX_NONE;
+    int32 rootLimitSlot = INDEX_NONE;
+
+    // Actor each actor of the main walk was entered from, to find the way back to the start
+    TMap<AActor*, AActor*> parents;
+
+    // Capacity of each segment that lowered a limit
+    TMap<AActor*, float> segmentCapacities;
+
+    TArray<FEfficiencyCheckerBottleneck> lastBottlenecks;
+
+    // Open recordings, innermost last, and what was entered and connected since the outermost one started
+    TArray<FRecording> recordings;
+    TArray<FEnteredActor> enteredLog;
+    TArray<AFGBuildable*> connectedLog;
+
+    // First log entry of each actor. Actors entered while nothing was recorded are not there
+    TMap<AActor*, int32> entryOrder;
+
+    int32 visitedNodes = 0;
+    bool overflow = false;
+    bool aborted = false;
+
+    int32 sliceNodes = 0;
+    double sliceDeadline = 0;
+    int32 sliceVisitedNodes = 0;
+    bool suspended = false;
+};
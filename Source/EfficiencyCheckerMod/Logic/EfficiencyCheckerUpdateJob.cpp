@@ -0,0 +1,154 @@
+﻿// ReSharper disable CppUE4CodingStandardNamingViolationWarning
+// ReSharper disable CommentTypo
+// ReSharper disable IdentifierTypo
+
+#include "EfficiencyCheckerUpdateJob.h"
+
+#include "Util/Optimize.h"
+
+#ifndef OPTIMIZE
+#pragma optimize( "", off )
+#endif
+
+FEfficiencyCheckerUpdateJob::FEfficiencyCheckerUpdateJob
+(
+	AEfficiencyCheckerBuilding* in_checker,
+	EResourceForm in_resourceForm,
+	AFGBuildableSubsystem* in_buildableSubsystem
+)
+	: checker(in_checker),
+	  traversal(in_resourceForm, connected, in_buildableSubsystem)
+{
+}
+
+bool FEfficiencyCheckerUpdateJob::resume(int32 sliceNodes, double sliceDeadline)
+{
+	if (step == EStep::Input)
+	{
+		if (inputConnector)
+		{
+			if (!walking)
+			{
+				traversal.beginInput(
+					customInjectedInput,
+					inputConnector,
+					injectedInput,
+					limitedThroughputIn,
+					inputSeenActors,
+					injectedItems,
+					restrictedItems
+					);
+
+				walking = true;
+			}
+
+			if (!traversal.resume(sliceNodes, sliceDeadline))
+			{
+				return false;
+			}
+
+			traversal.finishInput(injectedInput, limitedThroughputIn, inputSeenActors, injectedItems);
+
+			bottlenecksIn = traversal.getBottlenecks();
+
+			walking = false;
+		}
+
+		step = EStep::Output;
+	}
+
+	if (step == EStep::Output)
+	{
+		if (outputConnector && !customRequiredOutput)
+		{
+			if (!walking)
+			{
+				traversal.beginOutput(outputConnector, requiredOutput, limitedThroughputOut, outputSeenActors, injectedItems);
+
+				walking = true;
+			}
+
+			if (!traversal.resume(sliceNodes, sliceDeadline))
+			{
+				return false;
+			}
+
+			traversal.finishOutput(requiredOutput, limitedThroughputOut, outputSeenActors);
+
+			bottlenecksOut = traversal.getBottlenecks();
+
+			walking = false;
+		}
+		else
+		{
+			limitedThroughputOut = requiredOutput;
+		}
+
+		overflow |= traversal.hasOverflow();
+
+		step = EStep::Done;
+	}
+
+	return true;
+}
+
+bool FEfficiencyCheckerUpdateJob::dependsOnAny(const TSet<AFGBuildable*>& buildables) const
+{
+	for (auto buildable : buildables)
+	{
+		if (connected.Contains(buildable) || inputSeenActors.Contains(buildable))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+TArray<FEfficiencyCheckerBottleneck> FEfficiencyCheckerUpdateJob::getBottlenecks() const
+{
+	if (limitedThroughputIn < limitedThroughputOut)
+	{
+		return bottlenecksIn;
+	}
+
+	if (limitedThroughputOut < limitedThroughputIn)
+	{
+		return bottlenecksOut;
+	}
+
+	auto result = bottlenecksIn;
+	result.Append(bottlenecksOut);
+
+	return result;
+}
+
+void FEfficiencyCheckerUpdateJob::complete(const FEfficiencyCheckerFlowValues& values, const TSet<AFGBuildable*>& in_connected)
+{
+	if (inputConnector)
+	{
+		if (!customInjectedInput)
+		{
+			injectedInput = values.injectedInput;
+		}
+
+		limitedThroughputIn = FMath::Min(limitedThroughputIn, values.limitedThroughput);
+
+		injectedItems.Append(values.injectedItems.Intersect(restrictedItems));
+	}
+
+	if (outputConnector && !customRequiredOutput)
+	{
+		requiredOutput = values.requiredOutput;
+
+		limitedThroughputOut = FMath::Min(limitedThroughputOut, values.limitedThroughput);
+	}
+	else
+	{
+		limitedThroughputOut = requiredOutput;
+	}
+
+	connected.Append(in_connected);
+
+	step = EStep::Done;
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "FGItemDescriptor.h"
+#include "Logic/EfficiencyCheckerFlowField.h"
+#include "Logic/EfficiencyCheckerItemSet.h"
+#include "Logic/EfficiencyCheckerSeenActors.h"
+#include "Logic/EfficiencyCheckerTraversal.h"
+
+class AActor;
+class AEfficiencyCheckerBuilding;
+class AFGBuildable;
+class AFGBuildableSubsystem;
+class UFGConnectionComponent;
+
+/**
+ * One refresh of a checker, holding what GetConnectedProduction used to keep on the stack.
+ *
+ * The input and output walks run one after the other on the same traversal, and can be suspended and resumed across
+ * ticks. The results are only read back by the checker once resume reports the job as complete.
+ */
+class FEfficiencyCheckerUpdateJob
+{
+public:
+    FEfficiencyCheckerUpdateJob(AEfficiencyCheckerBuilding* in_checker, EResourceForm in_resourceForm, AFGBuildableSubsystem* in_buildableSubsystem);
+
+    // Runs the walks until both are done or the slice is spent (see FEfficiencyCheckerTraversal::resume). True when complete
+    bool resume(int32 sliceNodes = 0, double sliceDeadline = 0);
+
+    // Completes the job with the values read from the flow field, instead of walking the graph
+    void complete(const FEfficiencyCheckerFlowValues& values, const TSet<AFGBuildable*>& in_connected);
+
+    AEfficiencyCheckerBuilding* checker;
+
+    // AEfficiencyCheckerLogic::graphVersion when the job started, or when it was last found unaffected by the changes
+    int32 graphVersion = 0;
+
+    // True if the walks went through any of the buildables so far
+    bool dependsOnAny(const TSet<AFGBuildable*>& buildables) const;
+
+    // FEfficiencyCheckerComponents::getLastVersion when the job started, kept by the checker once it is applied
+    int32 componentsVersion = INDEX_NONE;
+
+    UFGConnectionComponent* inputConnector = nullptr;
+    UFGConnectionComponent* outputConnector = nullptr;
+
+    bool customInjectedInput = false;
+    bool customRequiredOutput = false;
+
+    FEfficiencyCheckerItemSet injectedItems;
+    FEfficiencyCheckerItemSet restrictedItems;
+
+    float injectedInput = 0;
+    float requiredOutput = 0;
+
+    float limitedThroughputIn = 0;
+    float limitedThroughputOut = 0;
+
+    bool overflow = false;
+
+    TSet<AFGBuildable*> connected;
+
+    // Segments that set limitedThroughputIn and limitedThroughputOut
+    TArray<FEfficiencyCheckerBottleneck> bottlenecksIn;
+    TArray<FEfficiencyCheckerBottleneck> bottlenecksOut;
+
+    // Segments that set the lower of both limits
+    TArray<FEfficiencyCheckerBottleneck> getBottlenecks() const;
+
+protected:
+    enum class EStep : uint8
+    {
+        Input,
+        Output,
+        Done
+    };
+
+    EStep step = EStep::Input;
+    bool walking = false;
+
+    FEfficiencyCheckerTraversal traversal;
+
+    TSet<AActor*> inputSeenActors;
+    FEfficiencyCheckerSeenActors outputSeenActors;
+};